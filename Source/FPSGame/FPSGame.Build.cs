@@ -1,19 +1,26 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-using UnrealBuildTool;
-
-public class FPSGame : ModuleRules
-{
-	public FPSGame(ReadOnlyTargetRules Target) : base(Target)
-	{
-		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
-
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput","AIModule","OnlineSubsystem","OnlineSubsystemUtils",
-            "NavigationSystem"  });
-
-        PrivateDependencyModuleNames.AddRange(new string[] {
-            "GameplayTasks",
-            "Kismet"
-        });
-    }
-}
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class FPSGame : ModuleRules
+{
+	public FPSGame(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput","AIModule","OnlineSubsystem","OnlineSubsystemUtils",
+            "NavigationSystem"  });
+
+        PrivateDependencyModuleNames.AddRange(new string[] {
+            "GameplayTasks",
+            "Kismet",
+            "AssetRegistry",
+            "MassEntity",
+            "MassCommon",
+            "AnimationBudgetAllocator"
+        });
+
+        // Iris复制系统（IrisCore依赖和UE_WITH_IRIS宏）
+        SetupIrisSupport(Target);
+    }
+}
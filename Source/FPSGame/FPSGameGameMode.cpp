@@ -1,14 +1,14 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "FPSGameGameMode.h"
-#include "FPSGameCharacter.h"
-#include "UObject/ConstructorHelpers.h"
-
-AFPSGameGameMode::AFPSGameGameMode()
-	: Super()
-{
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter"));
-	DefaultPawnClass = PlayerPawnClassFinder.Class;
-
-}
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "FPSGameGameMode.h"
+#include "FPSGameCharacter.h"
+#include "UObject/ConstructorHelpers.h"
+
+AFPSGameGameMode::AFPSGameGameMode()
+	: Super()
+{
+	// set default pawn class to our Blueprinted character
+	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter"));
+	DefaultPawnClass = PlayerPawnClassFinder.Class;
+
+}
@@ -1,34 +1,34 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Components/SphereComponent.h"
-#include "FPSGameCharacter.h"
-#include "FPSGamePickUpComponent.generated.h"
-
-// Declaration of the delegate that will be called when someone picks this up
-// The character picking this up is the parameter sent with the notification
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPickUp, AFPSGameCharacter*, PickUpCharacter);
-
-UCLASS(Blueprintable, BlueprintType, ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
-class FPSGAME_API UFPSGamePickUpComponent : public USphereComponent
-{
-	GENERATED_BODY()
-
-public:
-	
-	/** Delegate to whom anyone can subscribe to receive this event */
-	UPROPERTY(BlueprintAssignable, Category = "Interaction")
-	FOnPickUp OnPickUp;
-
-	UFPSGamePickUpComponent();
-protected:
-
-	/** Called when the game starts */
-	virtual void BeginPlay() override;
-
-	/** Code for when something overlaps this component */
-	UFUNCTION()
-	void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SphereComponent.h"
+#include "FPSGameCharacter.h"
+#include "FPSGamePickUpComponent.generated.h"
+
+// Declaration of the delegate that will be called when someone picks this up
+// The character picking this up is the parameter sent with the notification
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPickUp, AFPSGameCharacter*, PickUpCharacter);
+
+UCLASS(Blueprintable, BlueprintType, ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class FPSGAME_API UFPSGamePickUpComponent : public USphereComponent
+{
+	GENERATED_BODY()
+
+public:
+	
+	/** Delegate to whom anyone can subscribe to receive this event */
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FOnPickUp OnPickUp;
+
+	UFPSGamePickUpComponent();
+protected:
+
+	/** Called when the game starts */
+	virtual void BeginPlay() override;
+
+	/** Code for when something overlaps this component */
+	UFUNCTION()
+	void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 };
\ No newline at end of file
@@ -1,47 +1,81 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/Actor.h"
-#include "FPSGameProjectile.generated.h"
-
-class USphereComponent;
-class UProjectileMovementComponent;
-
-UCLASS(config=Game)
-class AFPSGameProjectile : public AActor
-{
-	GENERATED_BODY()
-
-	/** Sphere collision component */
-	UPROPERTY(VisibleDefaultsOnly, Category=Projectile)
-	USphereComponent* CollisionComp;
-
-	/** Projectile movement component */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	UProjectileMovementComponent* ProjectileMovement;
-
-public:
-	AFPSGameProjectile();
-
-
-	// 投射物伤害值（可在蓝图中调整）
-	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite, Category = "Damage")
-	float DamageAmount;
-	/** called when projectile hits something */
-	UFUNCTION()
-	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
-
-	/** Returns CollisionComp subobject **/
-	USphereComponent* GetCollisionComp() const { return CollisionComp; }
-	/** Returns ProjectileMovement subobject **/
-	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
-
-protected:
-	virtual void BeginPlay() override;
-
-	// 网络复制
-	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
-};
-
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "FPSGameProjectile.generated.h"
+
+class USphereComponent;
+class UProjectileMovementComponent;
+class APlayerController;
+
+UCLASS(config=Game)
+class AFPSGameProjectile : public AActor
+{
+	GENERATED_BODY()
+
+	/** Sphere collision component */
+	UPROPERTY(VisibleDefaultsOnly, Category=Projectile)
+	USphereComponent* CollisionComp;
+
+	/** Projectile movement component */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	UProjectileMovementComponent* ProjectileMovement;
+
+public:
+	AFPSGameProjectile();
+
+
+	// 投射物伤害值（可在蓝图中调整）
+	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	float DamageAmount;
+	/** called when projectile hits something */
+	UFUNCTION()
+	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	// 服务器生成后调用：按距离和飞行方向的锥形选出需要复制这颗子弹的连接，
+	// 其余能看到射击者的远处玩家只收到一次射击事件，在本地模拟一颗表现用的子弹
+	void InitNetRelevancy();
+
+	// 只用于表现的本地子弹：不复制、不造成伤害，碰到东西就销毁
+	void SetCosmeticOnly();
+
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+	/** Returns CollisionComp subobject **/
+	USphereComponent* GetCollisionComp() const { return CollisionComp; }
+	/** Returns ProjectileMovement subobject **/
+	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+protected:
+	virtual void BeginPlay() override;
+
+	// 网络复制
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	// 在这个距离内的玩家总是收到复制的子弹
+	UPROPERTY(Config)
+	float AlwaysRelevantDistance = 1500.0f;
+
+	// 在飞行方向锥形内的玩家在这个距离内收到复制的子弹
+	UPROPERTY(Config)
+	float ConeRelevantDistance = 6000.0f;
+
+	// 飞行方向锥形的半角（度）
+	UPROPERTY(Config)
+	float ConeHalfAngle = 20.0f;
+
+	// 收到复制子弹的连接（PlayerController的UniqueID），生成时确定一次，避免飞行中途才变成相关和本地模拟的子弹重复
+	TArray<uint32, TInlineAllocator<8>> RelevantViewers;
+
+	bool bNetRelevancyInitialized = false;
+
+	bool bCosmeticOnly = false;
+
+	// Iris不调用IsNetRelevantFor，把选出的连接写成连接过滤
+	void ApplyIrisConnectionFilter(const TArray<const APlayerController*, TInlineAllocator<8>>& Viewers) const;
+};
+
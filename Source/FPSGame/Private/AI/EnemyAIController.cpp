@@ -0,0 +1,209 @@
+#include "AI/EnemyAIController.h"
+#include "AI/EnemyTargetSubsystem.h"
+#include "AI/EnemyFlowFieldSubsystem.h"
+#include "Character/EnemyCharacter.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "Navigation/PathFollowingComponent.h"
+
+AEnemyAIController::AEnemyAIController()
+{
+    // 状态机由定时器和寻路回调驱动，只有沿流场移动时才Tick
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+    BrainState = EEnemyBrainState::Patrol;
+}
+
+void AEnemyAIController::OnPossess(APawn* InPawn)
+{
+    Super::OnPossess(InPawn);
+
+    // 加入批量目标选择
+    if (UEnemyTargetSubsystem* TargetSubsystem = GetWorld()->GetSubsystem<UEnemyTargetSubsystem>())
+    {
+        TargetSubsystem->RegisterEnemy(this);
+    }
+
+    ResetBrain();
+}
+
+void AEnemyAIController::OnUnPossess()
+{
+    if (UEnemyTargetSubsystem* TargetSubsystem = GetWorld()->GetSubsystem<UEnemyTargetSubsystem>())
+    {
+        TargetSubsystem->UnregisterEnemy(this);
+    }
+    SetFollowingFlowField(false);
+
+    Super::OnUnPossess();
+}
+
+void AEnemyAIController::ResetBrain()
+{
+    StopMovement();
+    SetBrainState(EEnemyBrainState::Patrol);
+}
+
+void AEnemyAIController::SetBrainState(EEnemyBrainState NewState)
+{
+    BrainState = NewState;
+
+    if (NewState != EEnemyBrainState::Chase)
+    {
+        SetFollowingFlowField(false);
+    }
+
+    if (AEnemyCharacter* Enemy = Cast<AEnemyCharacter>(GetPawn()))
+    {
+        Enemy->SetPatrolling(NewState == EEnemyBrainState::Patrol);
+        if (NewState == EEnemyBrainState::Patrol || NewState == EEnemyBrainState::Return)
+        {
+            Enemy->SetCurrentTarget(nullptr);
+        }
+    }
+}
+
+void AEnemyAIController::ApplyThinkResult(AFPSGameCharacter* Target, float Distance, bool bCanAttack)
+{
+    AEnemyCharacter* Enemy = Cast<AEnemyCharacter>(GetPawn());
+    if (!Enemy || Enemy->IsDead())
+    {
+        return;
+    }
+
+    const FVector EnemyLocation = Enemy->GetActorLocation();
+
+    // 超出拴绳范围时放弃目标，回到拴绳范围内再说
+    if (FVector::DistSquared(EnemyLocation, Enemy->GetHomeLocation()) > FMath::Square(LeashDistance))
+    {
+        Target = nullptr;
+    }
+
+    if (Target)
+    {
+        Enemy->SetCurrentTarget(Target);
+
+        if (Distance <= Enemy->GetAttackRange())
+        {
+            // 攻击：停下并按攻击间隔出手
+            if (BrainState != EEnemyBrainState::Attack)
+            {
+                StopMovement();
+                SetBrainState(EEnemyBrainState::Attack);
+            }
+
+            if (bCanAttack)
+            {
+                Enemy->AttackTarget();
+            }
+        }
+        else
+        {
+            // 远距离追击：流场可用时沿流场移动，不单独寻路
+            const UEnemyFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UEnemyFlowFieldSubsystem>();
+            FVector FlowDirection;
+            if (bUseFlowField && Distance > DirectApproachDistance && FlowField
+                && FlowField->GetFlowDirection(EnemyLocation, FlowDirection))
+            {
+                SetBrainState(EEnemyBrainState::Chase);
+                if (!bFollowingFlowField)
+                {
+                    StopMovement();
+                    SetFollowingFlowField(true);
+                }
+            }
+            else if (BrainState != EEnemyBrainState::Chase || bFollowingFlowField || GetMoveStatus() == EPathFollowingStatus::Idle)
+            {
+                // 近距离追击：寻路组件会自动跟随移动中的目标，只在进入追击或寻路中断时重新请求
+                SetBrainState(EEnemyBrainState::Chase);
+                SetFollowingFlowField(false);
+                MoveToActor(Target, Enemy->GetAttackRange() * 0.8f);
+            }
+        }
+        return;
+    }
+
+    switch (BrainState)
+    {
+    case EEnemyBrainState::Chase:
+    case EEnemyBrainState::Attack:
+        // 丢失目标，返回出生点
+        SetBrainState(EEnemyBrainState::Return);
+        MoveToLocation(Enemy->GetHomeLocation(), AcceptanceRadius);
+        break;
+
+    case EEnemyBrainState::Return:
+        if (GetMoveStatus() == EPathFollowingStatus::Idle)
+        {
+            MoveToLocation(Enemy->GetHomeLocation(), AcceptanceRadius);
+        }
+        break;
+
+    case EEnemyBrainState::Patrol:
+        if (GetMoveStatus() == EPathFollowingStatus::Idle)
+        {
+            MoveToNextPatrolPoint();
+        }
+        break;
+    }
+}
+
+void AEnemyAIController::SetFollowingFlowField(bool bFollow)
+{
+    bFollowingFlowField = bFollow;
+    SetActorTickEnabled(bFollow);
+}
+
+void AEnemyAIController::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    APawn* ControlledPawn = GetPawn();
+    if (!bFollowingFlowField || !ControlledPawn)
+    {
+        return;
+    }
+
+    // 每帧只做一次格子采样，朝距离更小的相邻格子移动
+    const UEnemyFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UEnemyFlowFieldSubsystem>();
+    FVector FlowDirection;
+    if (FlowField && FlowField->GetFlowDirection(ControlledPawn->GetActorLocation(), FlowDirection))
+    {
+        ControlledPawn->AddMovementInput(FlowDirection);
+    }
+    else
+    {
+        // 流场采样失败，下一次批量更新改用导航网格寻路
+        SetFollowingFlowField(false);
+    }
+}
+
+void AEnemyAIController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result)
+{
+    Super::OnMoveCompleted(RequestID, Result);
+
+    // 被新的移动请求打断或失败时交给下一次批量更新处理
+    if (!Result.IsSuccess())
+    {
+        return;
+    }
+
+    if (BrainState == EEnemyBrainState::Return)
+    {
+        SetBrainState(EEnemyBrainState::Patrol);
+    }
+
+    if (BrainState == EEnemyBrainState::Patrol)
+    {
+        MoveToNextPatrolPoint();
+    }
+}
+
+void AEnemyAIController::MoveToNextPatrolPoint()
+{
+    AEnemyCharacter* Enemy = Cast<AEnemyCharacter>(GetPawn());
+    FVector PatrolPoint;
+    if (Enemy && !Enemy->IsDead() && Enemy->GetNextPatrolPoint(PatrolPoint))
+    {
+        MoveToLocation(PatrolPoint, AcceptanceRadius);
+    }
+}
@@ -0,0 +1,333 @@
+#include "AI/EnemyFlowFieldSubsystem.h"
+#include "AI/EnemyTargetSubsystem.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "NavigationSystem.h"
+#include "Engine/World.h"
+
+namespace
+{
+    // 8邻域偏移
+    const int32 NeighborOffsetX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    const int32 NeighborOffsetY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+}
+
+bool UEnemyFlowFieldSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UEnemyFlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // 敌人只在服务器上寻路
+    if (InWorld.GetNetMode() != NM_Client)
+    {
+        InitGrid();
+    }
+}
+
+void UEnemyFlowFieldSubsystem::Deinitialize()
+{
+    CellHeights.Empty();
+    Distances.Empty();
+    BuildDistances.Empty();
+    BuildQueue.Empty();
+
+    Super::Deinitialize();
+}
+
+TStatId UEnemyFlowFieldSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyFlowFieldSubsystem::InitGrid()
+{
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!NavSys)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("[流场] 没有导航系统，流场不可用"));
+        return;
+    }
+
+    const FBox Bounds = NavSys->GetNavigableWorldBounds();
+    if (!Bounds.IsValid)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("[流场] 没有可导航区域，流场不可用"));
+        return;
+    }
+
+    // 地图太大时放大格子，保证格子数不超过上限
+    const FVector Size = Bounds.GetSize();
+    float EffectiveCellSize = FMath::Max(CellSize, 10.0f);
+    const float MinCellSize = FMath::Sqrt(static_cast<float>(Size.X * Size.Y) / FMath::Max(MaxCells, 1));
+    EffectiveCellSize = FMath::Max(EffectiveCellSize, MinCellSize);
+    CellSize = EffectiveCellSize;
+
+    SizeX = FMath::Max(1, FMath::CeilToInt(Size.X / CellSize));
+    SizeY = FMath::Max(1, FMath::CeilToInt(Size.Y / CellSize));
+    GridOrigin = Bounds.Min;
+    ProjectionHalfHeight = static_cast<float>(Size.Z) * 0.5f + 100.0f;
+
+    const int32 NumCells = SizeX * SizeY;
+    CellHeights.Init(MAX_flt, NumCells);
+    Distances.Init(UnreachedDistance, NumCells);
+    BuildDistances.Init(UnreachedDistance, NumCells);
+    BuildQueue.Reset(NumCells);
+
+    WalkabilityCursor = 0;
+    bGridReady = false;
+
+    UE_LOG(LogTemp, Warning, TEXT("[流场] 网格 %d x %d，格子大小 %.0f"), SizeX, SizeY, CellSize);
+}
+
+void UEnemyFlowFieldSubsystem::ContinueWalkabilityBuild()
+{
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!NavSys || WalkabilityCursor == INDEX_NONE)
+    {
+        return;
+    }
+
+    const int32 NumCells = CellHeights.Num();
+    const int32 EndCell = FMath::Min(NumCells, WalkabilityCursor + FMath::Max(1, MaxCellsPerTick));
+    const FVector QueryExtent(CellSize * 0.5f, CellSize * 0.5f, ProjectionHalfHeight);
+
+    for (; WalkabilityCursor < EndCell; ++WalkabilityCursor)
+    {
+        const int32 X = WalkabilityCursor % SizeX;
+        const int32 Y = WalkabilityCursor / SizeX;
+        const FVector CellCenter = GridOrigin + FVector((X + 0.5f) * CellSize, (Y + 0.5f) * CellSize, ProjectionHalfHeight - 100.0f);
+
+        FNavLocation NavLocation;
+        if (NavSys->ProjectPointToNavigation(CellCenter, NavLocation, QueryExtent))
+        {
+            CellHeights[WalkabilityCursor] = static_cast<float>(NavLocation.Location.Z);
+        }
+    }
+
+    if (WalkabilityCursor >= NumCells)
+    {
+        bGridReady = true;
+        UE_LOG(LogTemp, Log, TEXT("[流场] 网格生成完成"));
+    }
+}
+
+bool UEnemyFlowFieldSubsystem::WorldToCell(const FVector& Location, int32& OutX, int32& OutY) const
+{
+    if (SizeX <= 0 || SizeY <= 0)
+    {
+        return false;
+    }
+
+    OutX = FMath::FloorToInt((Location.X - GridOrigin.X) / CellSize);
+    OutY = FMath::FloorToInt((Location.Y - GridOrigin.Y) / CellSize);
+    return OutX >= 0 && OutX < SizeX && OutY >= 0 && OutY < SizeY;
+}
+
+FVector UEnemyFlowFieldSubsystem::GetCellCenter(int32 CellIndex) const
+{
+    const int32 X = CellIndex % SizeX;
+    const int32 Y = CellIndex / SizeX;
+    return FVector(GridOrigin.X + (X + 0.5f) * CellSize, GridOrigin.Y + (Y + 0.5f) * CellSize, CellHeights[CellIndex]);
+}
+
+bool UEnemyFlowFieldSubsystem::CanStep(int32 FromCell, int32 ToCell) const
+{
+    return IsWalkable(ToCell) && FMath::Abs(CellHeights[ToCell] - CellHeights[FromCell]) <= MaxStepHeight;
+}
+
+bool UEnemyFlowFieldSubsystem::CanMove(int32 X, int32 Y, int32 Dir, int32& OutNeighborIndex) const
+{
+    const int32 NX = X + NeighborOffsetX[Dir];
+    const int32 NY = Y + NeighborOffsetY[Dir];
+    if (NX < 0 || NX >= SizeX || NY < 0 || NY >= SizeY)
+    {
+        return false;
+    }
+
+    OutNeighborIndex = GetCellIndex(NX, NY);
+    if (!CanStep(GetCellIndex(X, Y), OutNeighborIndex))
+    {
+        return false;
+    }
+
+    // 斜向移动要求两侧格子都可走，避免贴墙切角
+    return Dir < 4 || (IsWalkable(GetCellIndex(NX, Y)) && IsWalkable(GetCellIndex(X, NY)));
+}
+
+void UEnemyFlowFieldSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!bGridReady)
+    {
+        ContinueWalkabilityBuild();
+        return;
+    }
+
+    TimeSinceUpdate += DeltaTime;
+    if (!bBuildInProgress && TimeSinceUpdate >= UpdateInterval)
+    {
+        TimeSinceUpdate = 0.0f;
+        UpdateSources();
+    }
+
+    if (bBuildInProgress)
+    {
+        ContinueFieldBuild();
+    }
+}
+
+void UEnemyFlowFieldSubsystem::UpdateSources()
+{
+    const UEnemyTargetSubsystem* TargetSubsystem = GetWorld()->GetSubsystem<UEnemyTargetSubsystem>();
+    if (!TargetSubsystem)
+    {
+        return;
+    }
+
+    // 玩家所在格子作为距离场的起点
+    TArray<int32> NewSources;
+    for (const AFPSGameCharacter* Target : TargetSubsystem->GetTargets())
+    {
+        int32 X, Y;
+        if (IsValid(Target) && Target->GetCurrentHealth() > 0.0f && WorldToCell(Target->GetActorLocation(), X, Y))
+        {
+            const int32 CellIndex = GetCellIndex(X, Y);
+            if (IsWalkable(CellIndex))
+            {
+                NewSources.AddUnique(CellIndex);
+            }
+        }
+    }
+    NewSources.Sort();
+
+    // 没有玩家换格子就沿用当前距离场
+    if (bFieldReady && NewSources == SourceCells)
+    {
+        return;
+    }
+
+    BuildSourceCells = MoveTemp(NewSources);
+    FMemory::Memset(BuildDistances.GetData(), 0xFF, BuildDistances.Num() * sizeof(uint16));
+    BuildQueue.Reset();
+    BuildQueueHead = 0;
+
+    for (const int32 SourceCell : BuildSourceCells)
+    {
+        BuildDistances[SourceCell] = 0;
+        BuildQueue.Add(SourceCell);
+    }
+
+    bBuildInProgress = true;
+    BuildStartTime = FPlatformTime::Seconds();
+}
+
+void UEnemyFlowFieldSubsystem::ContinueFieldBuild()
+{
+    int32 Budget = FMath::Max(1, MaxCellsPerTick);
+
+    while (BuildQueueHead < BuildQueue.Num() && Budget-- > 0)
+    {
+        const int32 CellIndex = BuildQueue[BuildQueueHead++];
+        const int32 X = CellIndex % SizeX;
+        const int32 Y = CellIndex / SizeX;
+        const uint16 NextDistance = BuildDistances[CellIndex] + 1;
+
+        for (int32 Dir = 0; Dir < 8; ++Dir)
+        {
+            int32 NeighborIndex;
+            if (!CanMove(X, Y, Dir, NeighborIndex) || BuildDistances[NeighborIndex] != UnreachedDistance)
+            {
+                continue;
+            }
+
+            BuildDistances[NeighborIndex] = NextDistance;
+            BuildQueue.Add(NeighborIndex);
+        }
+    }
+
+    if (BuildQueueHead >= BuildQueue.Num())
+    {
+        // 重建完成，替换当前距离场
+        Swap(Distances, BuildDistances);
+        SourceCells = MoveTemp(BuildSourceCells);
+        bBuildInProgress = false;
+        bFieldReady = true;
+        LastBuildSeconds = FPlatformTime::Seconds() - BuildStartTime;
+        NumBuilds++;
+    }
+}
+
+bool UEnemyFlowFieldSubsystem::GetGroundHeight(const FVector& Location, float& OutHeight) const
+{
+    int32 X, Y;
+    if (!bGridReady || !WorldToCell(Location, X, Y))
+    {
+        return false;
+    }
+
+    const int32 CellIndex = GetCellIndex(X, Y);
+    if (!IsWalkable(CellIndex))
+    {
+        return false;
+    }
+
+    OutHeight = CellHeights[CellIndex];
+    return true;
+}
+
+bool UEnemyFlowFieldSubsystem::GetFlowDirection(const FVector& Location, FVector& OutDirection) const
+{
+    int32 X, Y;
+    if (!bFieldReady || !WorldToCell(Location, X, Y))
+    {
+        return false;
+    }
+
+    const int32 CellIndex = GetCellIndex(X, Y);
+    const uint16 CurrentDistance = Distances[CellIndex];
+    if (CurrentDistance == 0 || CurrentDistance == UnreachedDistance)
+    {
+        return false;
+    }
+
+    // 选距离最小的相邻格子，和建场时一样检查高度差和斜向切角
+    int32 BestNeighbor = INDEX_NONE;
+    uint16 BestDistance = CurrentDistance;
+    for (int32 Dir = 0; Dir < 8; ++Dir)
+    {
+        int32 NeighborIndex;
+        if (CanMove(X, Y, Dir, NeighborIndex) && Distances[NeighborIndex] < BestDistance)
+        {
+            BestDistance = Distances[NeighborIndex];
+            BestNeighbor = NeighborIndex;
+        }
+    }
+
+    if (BestNeighbor == INDEX_NONE)
+    {
+        return false;
+    }
+
+    OutDirection = (GetCellCenter(BestNeighbor) - Location).GetSafeNormal2D();
+    return !OutDirection.IsNearlyZero();
+}
+
+void UEnemyFlowFieldSubsystem::DumpStats() const
+{
+    int32 NumWalkable = 0;
+    for (const float Height : CellHeights)
+    {
+        NumWalkable += Height != MAX_flt ? 1 : 0;
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("======= 流场 ======="));
+    UE_LOG(LogTemp, Warning, TEXT("网格: %d x %d (格子 %.0f 厘米)，可行走格子: %d，网格就绪: %s"),
+        SizeX, SizeY, CellSize, NumWalkable, bGridReady ? TEXT("是") : TEXT("否"));
+    UE_LOG(LogTemp, Warning, TEXT("起点格子: %d，重建次数: %d，上次重建耗时: %.2f 毫秒（含分帧等待）"),
+        SourceCells.Num(), NumBuilds, LastBuildSeconds * 1000.0);
+}
@@ -0,0 +1,154 @@
+#include "AI/EnemyPerceptionSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+
+bool UEnemyPerceptionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // 只在游戏世界中创建，编辑器预览世界不需要
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UEnemyPerceptionSubsystem::Deinitialize()
+{
+    PendingRequests.Reset();
+    InFlightTraces.Reset();
+    SightCache.Reset();
+
+    Super::Deinitialize();
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+uint64 UEnemyPerceptionSubsystem::MakePairKey(const AActor* Viewer, const AActor* Target)
+{
+    return (static_cast<uint64>(Viewer->GetUniqueID()) << 32) | static_cast<uint64>(Target->GetUniqueID());
+}
+
+ELineOfSightResult UEnemyPerceptionSubsystem::QueryLineOfSight(const AActor* Viewer, const AActor* Target)
+{
+    if (!IsValid(Viewer) || !IsValid(Target))
+    {
+        return ELineOfSightResult::Unknown;
+    }
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    const uint64 PairKey = MakePairKey(Viewer, Target);
+    FSightCacheEntry& Entry = SightCache.FindOrAdd(PairKey);
+
+    const bool bHasResult = Entry.Time > 0.0;
+    const bool bExpired = !bHasResult || Now - Entry.Time > SightCacheLifetime;
+
+    // 同一对Actor只排队一次，结果回来前沿用旧值
+    if (bExpired && !Entry.bPending)
+    {
+        Entry.bPending = true;
+        PendingRequests.Add({ Viewer, Target, PairKey });
+    }
+
+    if (!bHasResult)
+    {
+        return ELineOfSightResult::Unknown;
+    }
+    return Entry.bVisible ? ELineOfSightResult::Visible : ELineOfSightResult::Blocked;
+}
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UWorld* World = GetWorld();
+    if (!World)
+    {
+        return;
+    }
+
+    const double Now = World->GetTimeSeconds();
+
+    // 先读上一帧的结果，再提交本帧的请求
+    CollectTraceResults(World, Now);
+    SubmitPendingRequests(World);
+
+    if (Now - LastPruneTime > 5.0)
+    {
+        PruneCache(Now);
+        LastPruneTime = Now;
+    }
+}
+
+void UEnemyPerceptionSubsystem::CollectTraceResults(UWorld* World, double Now)
+{
+    for (const FSightInFlight& InFlight : InFlightTraces)
+    {
+        FSightCacheEntry* Entry = SightCache.Find(InFlight.PairKey);
+        if (!Entry)
+        {
+            continue;
+        }
+        Entry->bPending = false;
+
+        // 结果没取到（例如跨关卡或帧被跳过）时不更新，下次查询会重新排队
+        FTraceDatum TraceData;
+        if (!World->QueryTraceData(InFlight.Handle, TraceData))
+        {
+            continue;
+        }
+
+        // 起点和终点的Actor都被忽略，命中任何东西都说明视线被挡住
+        Entry->bVisible = !TraceData.OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+        Entry->Time = Now;
+    }
+
+    InFlightTraces.Reset();
+}
+
+void UEnemyPerceptionSubsystem::SubmitPendingRequests(UWorld* World)
+{
+    const int32 NumToSubmit = FMath::Min(PendingRequests.Num(), FMath::Max(1, MaxTracesPerFrame));
+
+    for (int32 Index = 0; Index < NumToSubmit; ++Index)
+    {
+        const FSightRequest& Request = PendingRequests[Index];
+        const AActor* Viewer = Request.Viewer.Get();
+        const AActor* Target = Request.Target.Get();
+        if (!Viewer || !Target)
+        {
+            SightCache.Remove(Request.PairKey);
+            continue;
+        }
+
+        // 从眼睛位置看向目标的眼睛位置
+        FVector ViewerEyes;
+        FRotator ViewerRotation;
+        Viewer->GetActorEyesViewPoint(ViewerEyes, ViewerRotation);
+
+        FVector TargetEyes;
+        FRotator TargetRotation;
+        Target->GetActorEyesViewPoint(TargetEyes, TargetRotation);
+
+        FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EnemySight), false, Viewer);
+        QueryParams.AddIgnoredActor(Target);
+
+        const FTraceHandle Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+            ViewerEyes, TargetEyes, SightTraceChannel, QueryParams);
+        InFlightTraces.Add({ Handle, Request.PairKey });
+    }
+
+    PendingRequests.RemoveAt(0, NumToSubmit, EAllowShrinking::No);
+}
+
+void UEnemyPerceptionSubsystem::PruneCache(double Now)
+{
+    const double MaxAge = FMath::Max(1.0, SightCacheLifetime * 10.0);
+    for (auto It = SightCache.CreateIterator(); It; ++It)
+    {
+        const FSightCacheEntry& Entry = It.Value();
+        if (!Entry.bPending && Now - Entry.Time > MaxAge)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
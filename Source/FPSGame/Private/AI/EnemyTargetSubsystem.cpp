@@ -0,0 +1,274 @@
+#include "AI/EnemyTargetSubsystem.h"
+#include "AI/EnemyPerceptionSubsystem.h"
+#include "AI/EnemyAIController.h"
+#include "Character/EnemyCharacter.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+void UEnemyTargetSubsystem::FTargetSelectionSnapshot::Reset()
+{
+    Controllers.Reset();
+    EnemyLocations.Reset();
+    ChaseRangeSquared.Reset();
+    AttackRangeSquared.Reset();
+    AttackCooldowns.Reset();
+    Players.Reset();
+    PlayerPositions.Reset();
+    Results.Reset();
+}
+
+TStatId UEnemyTargetSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyTargetSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyTargetSubsystem::RegisterTarget(AFPSGameCharacter* Target)
+{
+    if (IsValid(Target))
+    {
+        Targets.AddUnique(Target);
+    }
+}
+
+void UEnemyTargetSubsystem::UnregisterTarget(AFPSGameCharacter* Target)
+{
+    Targets.RemoveSingleSwap(Target, EAllowShrinking::No);
+}
+
+void UEnemyTargetSubsystem::RegisterEnemy(AEnemyAIController* EnemyController)
+{
+    if (IsValid(EnemyController))
+    {
+        EnemyControllers.AddUnique(EnemyController);
+    }
+}
+
+void UEnemyTargetSubsystem::UnregisterEnemy(AEnemyAIController* EnemyController)
+{
+    EnemyControllers.RemoveSingleSwap(EnemyController, EAllowShrinking::No);
+}
+
+void UEnemyTargetSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    TimeSinceThink += DeltaTime;
+    if (TimeSinceThink < ThinkInterval || EnemyControllers.Num() == 0)
+    {
+        return;
+    }
+    TimeSinceThink = 0.0f;
+
+    RunTargetSelection();
+}
+
+void UEnemyTargetSubsystem::RunTargetSelection()
+{
+    const float Now = GetWorld()->GetTimeSeconds();
+
+    const double StartTime = FPlatformTime::Seconds();
+    BuildSnapshot(Now);
+    const double SnapshotTime = FPlatformTime::Seconds();
+
+    // 快照只读，每个敌人只写自己的结果，工作线程之间不需要加锁
+    const int32 NumEnemies = Snapshot.Controllers.Num();
+    const EParallelForFlags Flags = NumEnemies >= MinEnemiesForParallel
+        ? EParallelForFlags::None
+        : EParallelForFlags::ForceSingleThread;
+    ParallelFor(TEXT("EnemyTargetSelection"), NumEnemies, FMath::Max(1, ParallelBatchSize),
+        [this](int32 EnemyIndex) { SelectCandidates(EnemyIndex); }, Flags);
+    const double SelectTime = FPlatformTime::Seconds();
+
+    ApplyResults();
+    const double EndTime = FPlatformTime::Seconds();
+
+    LastBatchEnemies = NumEnemies;
+    LastSnapshotSeconds = SnapshotTime - StartTime;
+    LastSelectSeconds = SelectTime - SnapshotTime;
+    LastApplySeconds = EndTime - SelectTime;
+}
+
+void UEnemyTargetSubsystem::BuildSnapshot(float Now)
+{
+    Snapshot.Reset();
+
+    // 存活的玩家
+    for (AFPSGameCharacter* Target : Targets)
+    {
+        if (IsValid(Target) && Target->GetCurrentHealth() > 0.0f)
+        {
+            Snapshot.Players.Add(Target);
+            Snapshot.PlayerPositions.Add(Target->GetActorLocation());
+        }
+    }
+
+    // 激活中的敌人
+    for (AEnemyAIController* EnemyController : EnemyControllers)
+    {
+        const AEnemyCharacter* Enemy = IsValid(EnemyController) ? Cast<AEnemyCharacter>(EnemyController->GetPawn()) : nullptr;
+        if (!Enemy || Enemy->IsDead())
+        {
+            continue;
+        }
+
+        Snapshot.Controllers.Add(EnemyController);
+        Snapshot.EnemyLocations.Add(Enemy->GetActorLocation());
+        Snapshot.ChaseRangeSquared.Add(FMath::Square(Enemy->GetChaseRange()));
+        Snapshot.AttackRangeSquared.Add(FMath::Square(Enemy->GetAttackRange()));
+        Snapshot.AttackCooldowns.Add(Enemy->GetAttackCooldownRemaining(Now));
+    }
+
+    Snapshot.Results.SetNum(Snapshot.Controllers.Num());
+}
+
+void UEnemyTargetSubsystem::SelectCandidates(int32 EnemyIndex)
+{
+    const FVector& EnemyLocation = Snapshot.EnemyLocations[EnemyIndex];
+    const float ChaseRangeSquared = Snapshot.ChaseRangeSquared[EnemyIndex];
+    const float AttackRangeSquared = Snapshot.AttackRangeSquared[EnemyIndex];
+    const bool bCooldownReady = Snapshot.AttackCooldowns[EnemyIndex] <= 0.0f;
+
+    FTargetCandidates& Result = Snapshot.Results[EnemyIndex];
+    Result.Num = 0;
+
+    // 一次算出到所有玩家的平方距离（向量化，不开方）
+    const int32 NumPlayers = Snapshot.PlayerPositions.Num();
+    TArray<float, TInlineAllocator<16>> PlayerDistSquared;
+    PlayerDistSquared.SetNumUninitialized(NumPlayers);
+    FProximityKernels::DistSquaredBatch(EnemyLocation, Snapshot.PlayerPositions, PlayerDistSquared.GetData());
+
+    for (int32 PlayerIndex = 0; PlayerIndex < NumPlayers; ++PlayerIndex)
+    {
+        const float DistSquared = PlayerDistSquared[PlayerIndex];
+        if (DistSquared > ChaseRangeSquared)
+        {
+            continue;
+        }
+
+        // 按距离插入排序，只保留最近的MaxCandidates个
+        int32 InsertAt = Result.Num;
+        while (InsertAt > 0 && Result.DistSquared[InsertAt - 1] > DistSquared)
+        {
+            --InsertAt;
+        }
+        if (InsertAt >= MaxCandidates)
+        {
+            continue;
+        }
+
+        const int32 LastIndex = FMath::Min(Result.Num, MaxCandidates - 1);
+        for (int32 Index = LastIndex; Index > InsertAt; --Index)
+        {
+            Result.TargetIndex[Index] = Result.TargetIndex[Index - 1];
+            Result.DistSquared[Index] = Result.DistSquared[Index - 1];
+            Result.bCanAttack[Index] = Result.bCanAttack[Index - 1];
+        }
+
+        Result.TargetIndex[InsertAt] = PlayerIndex;
+        Result.DistSquared[InsertAt] = DistSquared;
+        Result.bCanAttack[InsertAt] = bCooldownReady && DistSquared <= AttackRangeSquared;
+        Result.Num = FMath::Min(Result.Num + 1, MaxCandidates);
+    }
+}
+
+void UEnemyTargetSubsystem::ApplyResults()
+{
+    // 视线缓存不是线程安全的，在游戏线程上按距离依次筛选
+    UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>();
+
+    for (int32 EnemyIndex = 0; EnemyIndex < Snapshot.Controllers.Num(); ++EnemyIndex)
+    {
+        AEnemyAIController* EnemyController = Snapshot.Controllers[EnemyIndex];
+        if (!IsValid(EnemyController))
+        {
+            continue;
+        }
+
+        const FTargetCandidates& Result = Snapshot.Results[EnemyIndex];
+        AFPSGameCharacter* ChosenTarget = nullptr;
+        float ChosenDistance = 0.0f;
+        bool bChosenCanAttack = false;
+
+        for (int32 CandidateIndex = 0; CandidateIndex < Result.Num; ++CandidateIndex)
+        {
+            AFPSGameCharacter* Candidate = Snapshot.Players[Result.TargetIndex[CandidateIndex]];
+            if (!IsValid(Candidate))
+            {
+                continue;
+            }
+
+            if (Perception && Perception->QueryLineOfSight(EnemyController->GetPawn(), Candidate) != ELineOfSightResult::Visible)
+            {
+                continue;
+            }
+
+            ChosenTarget = Candidate;
+            ChosenDistance = FMath::Sqrt(Result.DistSquared[CandidateIndex]);
+            bChosenCanAttack = Result.bCanAttack[CandidateIndex];
+            break;
+        }
+
+        EnemyController->ApplyThinkResult(ChosenTarget, ChosenDistance, bChosenCanAttack);
+
+        // 附近有玩家（不论能否看到）的敌人提高移动快照的发送频率
+        if (AEnemyCharacter* Enemy = Cast<AEnemyCharacter>(EnemyController->GetPawn()))
+        {
+            float NearestDistSquared = TNumericLimits<float>::Max();
+            for (int32 CandidateIndex = 0; CandidateIndex < Result.Num; ++CandidateIndex)
+            {
+                NearestDistSquared = FMath::Min(NearestDistSquared, Result.DistSquared[CandidateIndex]);
+            }
+            Enemy->UpdateNetUpdateRate(FMath::Sqrt(NearestDistSquared));
+        }
+    }
+}
+
+AFPSGameCharacter* UEnemyTargetSubsystem::FindNearestVisibleTarget(const AActor* Seeker, float MaxRange) const
+{
+    if (!Seeker)
+    {
+        return nullptr;
+    }
+
+    UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>();
+    const FVector SeekerLocation = Seeker->GetActorLocation();
+
+    AFPSGameCharacter* NearestTarget = nullptr;
+    float NearestDistSquared = FMath::Square(MaxRange);
+
+    for (AFPSGameCharacter* Target : Targets)
+    {
+        if (!IsValid(Target) || Target->GetCurrentHealth() <= 0.0f)
+        {
+            continue;
+        }
+
+        const float DistSquared = FVector::DistSquared(SeekerLocation, Target->GetActorLocation());
+        if (DistSquared > NearestDistSquared)
+        {
+            continue;
+        }
+
+        // 被墙挡住或还没有视线结果的玩家不作为目标
+        if (Perception && Perception->QueryLineOfSight(Seeker, Target) != ELineOfSightResult::Visible)
+        {
+            continue;
+        }
+
+        NearestDistSquared = DistSquared;
+        NearestTarget = Target;
+    }
+
+    return NearestTarget;
+}
+
+void UEnemyTargetSubsystem::DumpStats() const
+{
+    UE_LOG(LogTemp, Warning, TEXT("======= 敌人批量目标选择 ======="));
+    UE_LOG(LogTemp, Warning, TEXT("敌人: %d，玩家: %d，工作线程: %d"),
+        LastBatchEnemies, Targets.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads());
+    UE_LOG(LogTemp, Warning, TEXT("快照: %.3f 毫秒，并行选择: %.3f 毫秒，回写: %.3f 毫秒"),
+        LastSnapshotSeconds * 1000.0, LastSelectSeconds * 1000.0, LastApplySeconds * 1000.0);
+}
@@ -0,0 +1,227 @@
+#include "Audio/WeaponAudioSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+
+bool UWeaponAudioSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // 专用服务器不播放声音
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UWeaponAudioSubsystem::Deinitialize()
+{
+    for (UAudioComponent* Component : PooledComponents)
+    {
+        if (IsValid(Component))
+        {
+            Component->Stop();
+            Component->DestroyComponent();
+        }
+    }
+    PooledComponents.Reset();
+    Voices.Reset();
+
+    Super::Deinitialize();
+}
+
+void UWeaponAudioSubsystem::PlayWeaponSound(const UObject* WorldContextObject, USoundBase* Sound, const FVector& Location)
+{
+    if (!Sound || !WorldContextObject)
+    {
+        return;
+    }
+
+    const UWorld* World = WorldContextObject->GetWorld();
+    if (UWeaponAudioSubsystem* AudioSubsystem = World ? World->GetSubsystem<UWeaponAudioSubsystem>() : nullptr)
+    {
+        AudioSubsystem->PlaySoundAtLocation(Sound, Location);
+        return;
+    }
+
+    UGameplayStatics::PlaySoundAtLocation(WorldContextObject, Sound, Location);
+}
+
+bool UWeaponAudioSubsystem::PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, float VolumeMultiplier)
+{
+    if (!Sound)
+    {
+        return false;
+    }
+
+    // 先按距离剔除，听不到的声音不占用组件和语音
+    const float DistanceSquared = GetListenerDistanceSquared(Location);
+    const float AudibleDistance = FMath::Min(MaxAudibleDistance, Sound->GetMaxDistance());
+    if (DistanceSquared > FMath::Square(AudibleDistance))
+    {
+        ++NumCulled;
+        return false;
+    }
+
+    const int32 VoiceIndex = AcquireVoice(Sound, DistanceSquared);
+    if (VoiceIndex == INDEX_NONE)
+    {
+        ++NumDropped;
+        return false;
+    }
+
+    FPooledVoice& Voice = Voices[VoiceIndex];
+    Voice.Sound = Sound;
+    Voice.StartTime = GetWorld()->GetTimeSeconds();
+    Voice.ListenerDistanceSquared = DistanceSquared;
+
+    UAudioComponent* Component = Voice.Component;
+    Component->Stop();
+    Component->SetWorldLocation(Location);
+    Component->SetSound(Sound);
+    Component->SetVolumeMultiplier(VolumeMultiplier);
+    Component->Play();
+
+    ++NumPlayed;
+    return true;
+}
+
+float UWeaponAudioSubsystem::GetListenerDistanceSquared(const FVector& Location) const
+{
+    float BestDistanceSquared = TNumericLimits<float>::Max();
+    bool bHasListener = false;
+
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController && PlayerController->IsLocalController())
+        {
+            FVector ListenerLocation;
+            FVector FrontDir;
+            FVector RightDir;
+            PlayerController->GetAudioListenerPosition(ListenerLocation, FrontDir, RightDir);
+
+            BestDistanceSquared = FMath::Min(BestDistanceSquared, static_cast<float>(FVector::DistSquared(ListenerLocation, Location)));
+            bHasListener = true;
+        }
+    }
+
+    return bHasListener ? BestDistanceSquared : 0.0f;
+}
+
+int32 UWeaponAudioSubsystem::AcquireVoice(USoundBase* Sound, float DistanceSquared)
+{
+    int32 FreeIndex = INDEX_NONE;
+    int32 SameSoundCount = 0;
+    int32 SameSoundVictim = INDEX_NONE;
+    int32 AnyVictim = INDEX_NONE;
+
+    // 抢占顺序：离听者更远的优先，同距离时更早开始的优先
+    auto IsBetterVictim = [this](int32 Candidate, int32 Current)
+    {
+        if (Current == INDEX_NONE)
+        {
+            return true;
+        }
+        const FPooledVoice& A = Voices[Candidate];
+        const FPooledVoice& B = Voices[Current];
+        return A.ListenerDistanceSquared != B.ListenerDistanceSquared
+            ? A.ListenerDistanceSquared > B.ListenerDistanceSquared
+            : A.StartTime < B.StartTime;
+    };
+
+    for (int32 Index = 0; Index < Voices.Num(); ++Index)
+    {
+        const FPooledVoice& Voice = Voices[Index];
+        if (!IsValid(Voice.Component) || !Voice.Component->IsPlaying())
+        {
+            if (FreeIndex == INDEX_NONE && IsValid(Voice.Component))
+            {
+                FreeIndex = Index;
+            }
+            continue;
+        }
+
+        if (Voice.Sound.Get() == Sound)
+        {
+            ++SameSoundCount;
+            if (IsBetterVictim(Index, SameSoundVictim))
+            {
+                SameSoundVictim = Index;
+            }
+        }
+
+        if (IsBetterVictim(Index, AnyVictim))
+        {
+            AnyVictim = Index;
+        }
+    }
+
+    // 同一个音效达到上限：只抢占比新声音更远的语音，否则丢弃新声音
+    if (SameSoundCount >= FMath::Max(1, MaxVoicesPerSound))
+    {
+        if (Voices[SameSoundVictim].ListenerDistanceSquared < DistanceSquared)
+        {
+            return INDEX_NONE;
+        }
+        ++NumStolen;
+        return SameSoundVictim;
+    }
+
+    if (FreeIndex != INDEX_NONE)
+    {
+        return FreeIndex;
+    }
+
+    if (Voices.Num() < MaxPooledComponents)
+    {
+        if (UAudioComponent* Component = CreatePooledComponent())
+        {
+            FPooledVoice& Voice = Voices.AddDefaulted_GetRef();
+            Voice.Component = Component;
+            return Voices.Num() - 1;
+        }
+    }
+
+    // 池满了：抢占全局最远的语音，新声音更远时丢弃
+    if (AnyVictim == INDEX_NONE || Voices[AnyVictim].ListenerDistanceSquared < DistanceSquared)
+    {
+        return INDEX_NONE;
+    }
+    ++NumStolen;
+    return AnyVictim;
+}
+
+UAudioComponent* UWeaponAudioSubsystem::CreatePooledComponent()
+{
+    UWorld* World = GetWorld();
+    AWorldSettings* WorldSettings = World ? World->GetWorldSettings() : nullptr;
+    if (!WorldSettings)
+    {
+        return nullptr;
+    }
+
+    // 和UGameplayStatics一样挂在WorldSettings上，但播放完不销毁
+    UAudioComponent* Component = NewObject<UAudioComponent>(WorldSettings);
+    Component->bAutoActivate = false;
+    Component->bAutoDestroy = false;
+    Component->bAllowSpatialization = true;
+    Component->RegisterComponentWithWorld(World);
+
+    PooledComponents.Add(Component);
+    return Component;
+}
+
+void UWeaponAudioSubsystem::DumpStats() const
+{
+    int32 NumPlaying = 0;
+    for (const FPooledVoice& Voice : Voices)
+    {
+        if (IsValid(Voice.Component) && Voice.Component->IsPlaying())
+        {
+            ++NumPlaying;
+        }
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("武器音效: 池 %d/%d, 正在播放 %d, 已播放 %d, 距离剔除 %d, 抢占 %d, 丢弃 %d"),
+        Voices.Num(), MaxPooledComponents, NumPlaying, NumPlayed, NumCulled, NumStolen, NumDropped);
+}
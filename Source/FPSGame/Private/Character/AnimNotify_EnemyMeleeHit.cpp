@@ -0,0 +1,19 @@
+#include "Character/AnimNotify_EnemyMeleeHit.h"
+#include "Character/EnemyCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+
+void UAnimNotify_EnemyMeleeHit::Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
+{
+    Super::Notify(MeshComp, Animation, EventReference);
+
+    // 伤害只在服务器结算，ResolveMeleeHit内部会检查权限
+    if (AEnemyCharacter* Enemy = MeshComp ? Cast<AEnemyCharacter>(MeshComp->GetOwner()) : nullptr)
+    {
+        Enemy->ResolveMeleeHit();
+    }
+}
+
+FString UAnimNotify_EnemyMeleeHit::GetNotifyName_Implementation() const
+{
+    return TEXT("EnemyMeleeHit");
+}
@@ -0,0 +1,334 @@
+#include "Character/CharacterSignificanceSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "IAnimationBudgetAllocator.h"
+#include "AnimationBudgetAllocatorParameters.h"
+
+bool UCharacterSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // 专用服务器没有摄像机，不需要重要度
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UCharacterSignificanceSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // 本机所有预算网格共享的动画时间预算
+    if (IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(&InWorld))
+    {
+        FAnimationBudgetAllocatorParameters Parameters;
+        Parameters.BudgetInMs = AnimationBudgetMs;
+        Parameters.MaxTickRate = MaxAnimationTickRate;
+        Allocator->SetParameters(Parameters);
+        Allocator->SetEnabled(true);
+    }
+}
+
+void UCharacterSignificanceSubsystem::Deinitialize()
+{
+    Entries.Reset();
+    Viewpoints.Reset();
+
+    Super::Deinitialize();
+}
+
+TStatId UCharacterSignificanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCharacterSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UCharacterSignificanceSubsystem::RegisterCharacter(ACharacter* Character)
+{
+    if (!IsValid(Character) || FindEntry(Character))
+    {
+        return;
+    }
+
+    FSignificanceEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Character = Character;
+    Entry.ActorTickInterval = Character->GetActorTickInterval();
+
+    if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+    {
+        Entry.MeshTickInterval = Mesh->GetComponentTickInterval();
+        Entry.AnimTickOption = Mesh->VisibilityBasedAnimTickOption;
+    }
+
+    if (USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(Character->GetMesh()))
+    {
+        BudgetedMesh->SetAutoCalculateSignificance(false);
+        ApplyBudgetedSignificance(Character, Entry.Significance);
+    }
+
+    if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+    {
+        Entry.MovementTickInterval = Movement->GetComponentTickInterval();
+        Entry.SmoothingMode = Movement->NetworkSmoothingMode;
+    }
+}
+
+void UCharacterSignificanceSubsystem::UnregisterCharacter(ACharacter* Character)
+{
+    const int32 Index = Entries.IndexOfByPredicate([Character](const FSignificanceEntry& Entry) { return Entry.Character.Get() == Character; });
+    if (Index == INDEX_NONE)
+    {
+        return;
+    }
+
+    // 恢复原始设置，角色之后可能被其他逻辑继续使用
+    ApplySignificance(Entries[Index], ECharacterSignificance::High);
+    Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+const UCharacterSignificanceSubsystem::FSignificanceEntry* UCharacterSignificanceSubsystem::FindEntry(const AActor* Actor) const
+{
+    return Entries.FindByPredicate([Actor](const FSignificanceEntry& Entry) { return Entry.Character.Get() == Actor; });
+}
+
+ECharacterSignificance UCharacterSignificanceSubsystem::GetSignificance(const AActor* Actor) const
+{
+    const FSignificanceEntry* Entry = FindEntry(Actor);
+    return Entry ? Entry->Significance : ECharacterSignificance::High;
+}
+
+bool UCharacterSignificanceSubsystem::ShouldPlayCosmetics(const AActor* Actor, ECharacterSignificance MinSignificance)
+{
+    const UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+    const UCharacterSignificanceSubsystem* Subsystem = World ? World->GetSubsystem<UCharacterSignificanceSubsystem>() : nullptr;
+    if (!Subsystem)
+    {
+        return true;
+    }
+    return Subsystem->GetSignificance(Actor) >= MinSignificance;
+}
+
+void UCharacterSignificanceSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UWorld* World = GetWorld();
+    if (!World)
+    {
+        return;
+    }
+
+    const double Now = World->GetTimeSeconds();
+    if (Now - LastUpdateTime < UpdateInterval)
+    {
+        return;
+    }
+    LastUpdateTime = Now;
+
+    GatherViewpoints(World);
+
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        FSignificanceEntry& Entry = Entries[Index];
+        ACharacter* Character = Entry.Character.Get();
+        if (!Character)
+        {
+            Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            continue;
+        }
+
+        // 本机控制或有权威的角色不节流：前者是玩家自己，后者的动画通知和移动驱动着游戏逻辑
+        const bool bSimulatedProxy = Character->GetLocalRole() == ROLE_SimulatedProxy;
+        const ECharacterSignificance NewSignificance = bSimulatedProxy
+            ? ComputeSignificance(Character, Entry.Significance)
+            : ECharacterSignificance::High;
+
+        if (NewSignificance != Entry.Significance)
+        {
+            ApplySignificance(Entry, NewSignificance);
+        }
+    }
+}
+
+void UCharacterSignificanceSubsystem::GatherViewpoints(UWorld* World)
+{
+    Viewpoints.Reset();
+
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController && PlayerController->IsLocalController())
+        {
+            FVector ViewLocation;
+            FRotator ViewRotation;
+            PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+            Viewpoints.Emplace(ViewRotation, ViewLocation);
+        }
+    }
+}
+
+ECharacterSignificance UCharacterSignificanceSubsystem::ComputeSignificance(const ACharacter* Character, ECharacterSignificance Current) const
+{
+    // 对象池中隐藏的敌人没有任何需要更新的表现
+    if (Character->IsHidden())
+    {
+        return ECharacterSignificance::Culled;
+    }
+
+    // 还没有本地视点（例如加载中）时不降级
+    if (Viewpoints.IsEmpty())
+    {
+        return ECharacterSignificance::High;
+    }
+
+    const FVector Location = Character->GetActorLocation();
+
+    // 取所有本地视点中最近的等效距离
+    float BestDistance = TNumericLimits<float>::Max();
+    for (const FTransform& Viewpoint : Viewpoints)
+    {
+        const FVector ToCharacter = Location - Viewpoint.GetLocation();
+        const float Distance = ToCharacter.Size();
+        const bool bInView = Distance < KINDA_SMALL_NUMBER
+            || FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToCharacter / Distance) >= ViewConeCos;
+
+        BestDistance = FMath::Min(BestDistance, bInView ? Distance : Distance * OutOfViewDistanceScale);
+    }
+
+    const float Thresholds[] = { LowDistance, MediumDistance, HighDistance };
+    int32 Level = static_cast<int32>(ECharacterSignificance::Culled);
+    for (int32 Index = 0; Index < UE_ARRAY_COUNT(Thresholds); ++Index)
+    {
+        const int32 CandidateLevel = Index + 1;
+
+        // 升到比当前更高的等级时要求再靠近一点
+        const float Threshold = CandidateLevel > static_cast<int32>(Current)
+            ? Thresholds[Index] * (1.0f - Hysteresis)
+            : Thresholds[Index];
+
+        if (BestDistance <= Threshold)
+        {
+            Level = CandidateLevel;
+        }
+    }
+
+    return static_cast<ECharacterSignificance>(Level);
+}
+
+float UCharacterSignificanceSubsystem::GetTickInterval(ECharacterSignificance Significance) const
+{
+    switch (Significance)
+    {
+    case ECharacterSignificance::Culled:
+        return CulledTickInterval;
+    case ECharacterSignificance::Low:
+        return LowTickInterval;
+    case ECharacterSignificance::Medium:
+        return MediumTickInterval;
+    default:
+        return 0.0f;
+    }
+}
+
+float UCharacterSignificanceSubsystem::GetAnimationSignificance(ECharacterSignificance Significance)
+{
+    switch (Significance)
+    {
+    case ECharacterSignificance::Culled:
+        return 0.0f;
+    case ECharacterSignificance::Low:
+        return 0.25f;
+    case ECharacterSignificance::Medium:
+        return 0.6f;
+    default:
+        return 1.0f;
+    }
+}
+
+void UCharacterSignificanceSubsystem::ApplyBudgetedSignificance(ACharacter* Character, ECharacterSignificance Significance)
+{
+    USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(Character->GetMesh());
+    if (!BudgetedMesh)
+    {
+        return;
+    }
+
+    const bool bAuthority = Character->HasAuthority();
+    BudgetedMesh->SetComponentSignificance(GetAnimationSignificance(Significance),
+        /*bNeverSkip=*/ bAuthority, /*bTickEvenIfNotRendered=*/ bAuthority);
+}
+
+void UCharacterSignificanceSubsystem::ApplySignificance(FSignificanceEntry& Entry, ECharacterSignificance NewSignificance) const
+{
+    Entry.Significance = NewSignificance;
+
+    ACharacter* Character = Entry.Character.Get();
+    if (!Character)
+    {
+        return;
+    }
+
+    const bool bFull = NewSignificance == ECharacterSignificance::High;
+    const float TickInterval = GetTickInterval(NewSignificance);
+
+    Character->SetActorTickInterval(bFull ? Entry.ActorTickInterval : TickInterval);
+
+    if (Cast<USkeletalMeshComponentBudgeted>(Character->GetMesh()))
+    {
+        // 预算网格的Tick频率由分配器决定，不在这里改
+        ApplyBudgetedSignificance(Character, NewSignificance);
+    }
+    else if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+    {
+        Mesh->SetComponentTickInterval(bFull ? Entry.MeshTickInterval : TickInterval);
+
+        // 看不见时只更新蒙太奇（保证通知和根运动正确），Culled时连蒙太奇也不更新
+        if (bFull)
+        {
+            Mesh->VisibilityBasedAnimTickOption = Entry.AnimTickOption;
+        }
+        else if (NewSignificance == ECharacterSignificance::Culled)
+        {
+            Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+        }
+        else
+        {
+            Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+        }
+    }
+
+    if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+    {
+        // 模拟代理的移动组件主要做网络平滑，远处用更便宜的平滑或直接跳到服务器位置
+        switch (NewSignificance)
+        {
+        case ECharacterSignificance::High:
+            Movement->NetworkSmoothingMode = Entry.SmoothingMode;
+            Movement->SetComponentTickInterval(Entry.MovementTickInterval);
+            break;
+        case ECharacterSignificance::Medium:
+            Movement->NetworkSmoothingMode = ENetworkSmoothingMode::Linear;
+            Movement->SetComponentTickInterval(Entry.MovementTickInterval);
+            break;
+        default:
+            Movement->NetworkSmoothingMode = ENetworkSmoothingMode::Disabled;
+            Movement->SetComponentTickInterval(TickInterval);
+            break;
+        }
+    }
+}
+
+void UCharacterSignificanceSubsystem::DumpStats() const
+{
+    int32 Counts[4] = { 0, 0, 0, 0 };
+    for (const FSignificanceEntry& Entry : Entries)
+    {
+        if (Entry.Character.IsValid())
+        {
+            ++Counts[static_cast<int32>(Entry.Significance)];
+        }
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("角色重要度: 已注册 %d, High %d, Medium %d, Low %d, Culled %d, 本地视点 %d"),
+        Entries.Num(), Counts[3], Counts[2], Counts[1], Counts[0], Viewpoints.Num());
+}
@@ -1,321 +1,562 @@
-#include "Character/EnemyCharacter.h"
-#include "GameMode/MyGameMode.h"
-#include "AIController.h"
-#include "NavigationSystem.h"
-#include "Perception/AIPerceptionComponent.h"
-#include "Perception/AISenseConfig_Sight.h"
-#include "Components/SphereComponent.h"
-#include "BehaviorTree/BehaviorTreeComponent.h"
-#include "BehaviorTree/BlackboardComponent.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "GameFramework/Controller.h"
-#include "FPSGame/FPSGameCharacter.h"
-#include "PlayerState/MyPlayerState.h"
-#include "Kismet/GameplayStatics.h"
-#include "Components/CapsuleComponent.h"
-#include "Net/UnrealNetwork.h" 
-#include "Kismet/KismetMathLibrary.h"
-
-AEnemyCharacter::AEnemyCharacter()
-{
-    // 初始化碰撞（确保能被投射物命中）
-    GetCapsuleComponent()->SetCollisionProfileName(TEXT("Pawn"));
-
-    // 启用网络复制
-    bReplicates = true;
-
-    // 强制AI控制器类（确保生成时自动绑定AI）
-    AIControllerClass = AAIController::StaticClass();
-    GetCharacterMovement()->bOrientRotationToMovement = true; // 移动时自动转向
-
-    // 初始化攻击碰撞体（绑定到角色骨骼的"攻击点"）
-    AttackCollision = CreateDefaultSubobject<USphereComponent>(TEXT("AttackCollision"));
-    AttackCollision->InitSphereRadius(50.0f);
-    AttackCollision->SetCollisionProfileName("EnemyAttack"); // 自定义碰撞配置
-    AttackCollision->SetupAttachment(GetMesh(), FName("AttackSocket")); // 需在骨骼设置"AttackSocket"
-    AttackCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemyCharacter::OnAttackCollisionOverlap);
-    AttackCollision->SetActive(false); // 默认关闭
-
-    // 确保碰撞通道设置正确（在项目设置中配置"EnemyAttack"通道与玩家碰撞）
-    AttackCollision->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
-
-    // 初始化健康值
-    MaxHealth = 100.0f;
-    CurrentHealth = MaxHealth;
-
-    // 战斗参数
-    AttackRange = 150.0f;
-    AttackDamage = 20.0f;
-    AttackInterval = 1.0f;
-    LastAttackTime = 0.0f;
-
-    // AI参数
-    ChaseRange = 1500.0f;
-    bIsPatrolling = true;
-    PatrolRadius = 500.0f;
-    CurrentPatrolPointIndex = 0;
-
-    // 死亡状态
-    bIsDead = false;
-
-    // 初始化击杀者控制器
-    KillerInstigator = nullptr;
-}
-
-void AEnemyCharacter::BeginPlay()
-{
-    Super::BeginPlay();
-
-    // 如果还没有控制器，自动生成一个AI控制器
-    if (!GetController() && GetLocalRole() == ROLE_Authority)
-    {
-        UE_LOG(LogTemp, Warning, TEXT("EnemyCharacter没有控制器，正在生成AI控制器..."));
-
-        // 创建AI控制器
-        AAIController* AIController = GetWorld()->SpawnActor<AAIController>(
-            AAIController::StaticClass(),
-            GetActorLocation(),
-            GetActorRotation()
-        );
-
-        if (AIController)
-        {
-            AIController->Possess(this);
-            UE_LOG(LogTemp, Log, TEXT("AI控制器已附加: %s"), *AIController->GetName());
-        }
-        else
-        {
-            UE_LOG(LogTemp, Error, TEXT("无法生成AI控制器！"));
-        }
-    }
-    else if (GetController())
-    {
-        UE_LOG(LogTemp, Log, TEXT("敌人已有控制器: %s"), *GetController()->GetName());
-    }
-}
-
-void AEnemyCharacter::Tick(float DeltaTime)
-{
-    Super::Tick(DeltaTime);
-
-    if (bIsDead) return;
-
-    // 仅服务器处理攻击逻辑
-    if (GetLocalRole() != ROLE_Authority) return;
-
-    // 寻找范围内的玩家目标
-    FindValidPlayerTarget();
-
-    // 如果有目标且满足攻击条件，则执行攻击
-    if (CurrentTargetPlayer && CanAttack())
-    {
-        AttackTarget();
-    }
-}
-
-void AEnemyCharacter::SetEnemyKiller(AController* NewKiller)
-{
-    KillerControllerRef = NewKiller;
-}
-
-void AEnemyCharacter::OnAttackCollisionOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
-{
-    AFPSGameCharacter* Player = Cast<AFPSGameCharacter>(OtherActor);
-    if (Player && !bIsDead)
-    {
-        // 对玩家造成伤害
-        UGameplayStatics::ApplyDamage(
-            Player,
-            AttackDamage,
-            GetController(),
-            this,
-            UDamageType::StaticClass()
-        );
-    }
-}
-
-// 执行攻击逻辑
-void AEnemyCharacter::AttackTarget()
-{
-    if (bIsDead || !CurrentTargetPlayer) return;
-
-    LastAttackTime = GetWorld()->GetTimeSeconds();
-    UE_LOG(LogTemp, Log, TEXT("敌人发起攻击，目标：%s"), *CurrentTargetPlayer->GetName());
-
-    // 激活攻击碰撞体（持续短时间检测碰撞）
-    AttackCollision->SetActive(true);
-    // 0.5秒后关闭碰撞体（根据攻击动画时长调整）
-    GetWorld()->GetTimerManager().SetTimer(
-        AttackCollisionTimerHandle,  // 传递已有的TimerHandle
-        [this]() { AttackCollision->SetActive(false); },
-        0.5f,
-        false
-    );
-
-    // 3. 转向目标（让敌人面对玩家）
-    FRotator LookAtRotation = UKismetMathLibrary::FindLookAtRotation(
-        GetActorLocation(),
-        CurrentTargetPlayer->GetActorLocation()
-    );
-    LookAtRotation.Pitch = 0; // 只在水平方向转向
-    SetActorRotation(LookAtRotation);
-}
-
-
-// 重写TakeDamage，接收子弹的ApplyDamage调用
-float AEnemyCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
-{
-    // 调用父类的TakeDamage（UE默认逻辑）
-    float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
-
-    // 记录造成伤害的控制器
-    if (EventInstigator && ActualDamage > 0)
-    {
-        KillerControllerRef = EventInstigator;
-    }
-
-    // 仅服务器端执行扣血逻辑
-    if (GetLocalRole() == ROLE_Authority)
-    {
-        Server_TakeDamage(ActualDamage, EventInstigator);
-    }
-
-    return ActualDamage;
-}
-
-void AEnemyCharacter::Server_TakeDamage_Implementation(float DamageAmount, AController* InstigatorController)
-{
-    if (bIsDead) return;
-
-    // 验证伤害值合法性
-    if (DamageAmount <= 0)
-    {
-        UE_LOG(LogTemp, Warning, TEXT("无效伤害值：%.1f，忽略扣血"), DamageAmount);
-        return;
-    }
-
-    CurrentHealth -= DamageAmount;
-    UE_LOG(LogTemp, Log, TEXT("敌人受到伤害: %f, 剩余生命值: %f"), DamageAmount, CurrentHealth);
-
-    // 记录击杀者控制器
-    if (CurrentHealth <= 0.0f)
-    {
-        KillerInstigator = InstigatorController;
-        Multicast_Die(KillerInstigator);
-    }
-}
-
-bool AEnemyCharacter::Server_TakeDamage_Validate(float DamageAmount, AController* InstigatorController)
-{
-    return true;// 简单验证
-}
-
-void AEnemyCharacter::Multicast_Die_Implementation(AController* KillerController)
-{
-    // 确保只在服务器上执行
-    if (GetLocalRole() != ROLE_Authority)
-    {
-        return;
-    }
-
-    // 输出击杀者信息
-    if (KillerControllerRef)
-    {
-        UE_LOG(LogTemp, Warning, TEXT("敌人 %s 被玩家 %s 击杀"),
-            *GetName(), *KillerControllerRef->GetName());
-    }
-    else
-    {
-        UE_LOG(LogTemp, Warning, TEXT("敌人 %s 死亡，但没有记录击杀者"), *GetName());
-    }
-
-    bIsDead = true;
-
-    // 停止所有移动
-    AAIController* AIController = Cast<AAIController>(GetController());
-    if (AIController)
-    {
-        AIController->StopMovement();
-    }
-
-    // 禁用碰撞
-    GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-    AttackCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-    // 播放死亡动画
-    //PlayAnimMontage(DeathMontage);
-
-    // 通知GameMode
-    UWorld* World = GetWorld();
-    if (World)
-    {
-        AMyGameMode* GameMode = Cast<AMyGameMode>(UGameplayStatics::GetGameMode(World));
-        if (GameMode)
-        {
-            GameMode->OnEnemyDeath(this);
-        }
-    }
-
-    //销毁尸体
-    Destroy();
-}
-
-bool AEnemyCharacter::Multicast_Die_Validate(AController* KillerController)
-{
-    return true;
-}
-
-// 寻找攻击范围内的玩家目标
-void AEnemyCharacter::FindValidPlayerTarget()
-{
-    TArray<AActor*> AllPlayers;
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFPSGameCharacter::StaticClass(), AllPlayers);
-
-    CurrentTargetPlayer = nullptr;
-    float ClosestDistance = AttackRange; // 只检测攻击范围内的玩家
-
-    for (AActor* Actor : AllPlayers)
-    {
-        AFPSGameCharacter* Player = Cast<AFPSGameCharacter>(Actor);
-        if (Player && IsValid(Player))
-        {
-            // 计算与玩家的距离
-            float Distance = FVector::Distance(GetActorLocation(), Player->GetActorLocation());
-            // 找到最近的、在攻击范围内的玩家
-            if (Distance <= ClosestDistance)
-            {
-                ClosestDistance = Distance;
-                CurrentTargetPlayer = Player;
-            }
-        }
-    }
-}
-
-// 检查是否满足攻击条件
-bool AEnemyCharacter::CanAttack()
-{
-    if (!CurrentTargetPlayer || CurrentTargetPlayer->GetCurrentHealth() <= 0)
-    {
-        return false;
-    }
-
-    // 检查攻击间隔
-    float CurrentTime = GetWorld()->GetTimeSeconds();
-    if (CurrentTime - LastAttackTime < AttackInterval)
-    {
-        return false;
-    }
-
-    // 再次确认距离（防止目标移动出范围）
-    float Distance = FVector::Distance(GetActorLocation(), CurrentTargetPlayer->GetActorLocation());
-    return Distance <= AttackRange;
-}
-
-void AEnemyCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
-{
-    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-
-    // 声明需要同步的属性（根据实际需求添加，例如生命值）
-    DOREPLIFETIME(AEnemyCharacter, CurrentHealth);
-    DOREPLIFETIME(AEnemyCharacter, bIsDead);
+#include "Character/EnemyCharacter.h"
+#include "GameMode/MyGameMode.h"
+#include "AI/EnemyAIController.h"
+#include "AI/EnemyTargetSubsystem.h"
+#include "Character/CharacterSignificanceSubsystem.h"
+#include "Net/NetOcclusionSubsystem.h"
+#include "Net/FPSIpNetDriver.h"
+#include "Engine/ActorChannel.h"
+#include "NavigationSystem.h"
+#include "Animation/AnimMontage.h"
+#include "Engine/OverlapResult.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "PlayerState/MyPlayerState.h"
+#include "Kismet/GameplayStatics.h"
+#include "Components/CapsuleComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Net/UnrealNetwork.h" 
+#include "Kismet/KismetMathLibrary.h"
+
+AEnemyCharacter::AEnemyCharacter(const FObjectInitializer& ObjectInitializer)
+    // 网格交给动画预算分配器管理，按每帧预算决定更新频率和插值
+    : Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
+{
+    // 初始化碰撞（确保能被投射物命中）
+    GetCapsuleComponent()->SetCollisionProfileName(TEXT("Pawn"));
+
+    // 启用网络复制；子对象走注册列表（Iris要求）
+    bReplicates = true;
+    bReplicateUsingRegisteredSubObjectList = true;
+
+    // 不用ACharacter默认的移动复制，改为低频的压缩快照，客户端插值显示
+    SetReplicateMovement(false);
+    SetNetUpdateFrequency(MaxSnapshotRate);
+    SetMinNetUpdateFrequency(2.0f);
+
+    // AI由控制器的定时状态机驱动，服务器上不需要Tick；客户端在BeginPlay里打开Tick做快照插值
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+
+    // 强制AI控制器类（确保生成时自动绑定AI）
+    AIControllerClass = AEnemyAIController::StaticClass();
+    GetCharacterMovement()->bOrientRotationToMovement = true; // 移动时自动转向
+
+    // 近战命中只在命中帧做一次查询，不常驻碰撞体
+    AttackMontage = nullptr;
+    AttackHitDelay = 0.3f;
+    AttackHitRadius = 50.0f;
+    AttackSocketName = FName("AttackSocket"); // 骨骼上的"攻击点"
+
+    // 初始化健康值
+    MaxHealth = 100.0f;
+    CurrentHealth = MaxHealth;
+
+    // 战斗参数
+    AttackRange = 150.0f;
+    AttackDamage = 20.0f;
+    AttackInterval = 1.0f;
+    LastAttackTime = 0.0f;
+
+    // AI参数
+    ChaseRange = 1500.0f;
+    bIsPatrolling = true;
+    PatrolRadius = 500.0f;
+    CurrentPatrolPointIndex = 0;
+    HomeLocation = FVector::ZeroVector;
+
+    // 死亡状态
+    bIsDead = false;
+
+    // 初始化击杀者控制器
+    KillerInstigator = nullptr;
+}
+
+void AEnemyCharacter::BeginPlay()
+{
+    // 专用服务器不渲染，只推进蒙太奇（保证动画通知），不计算姿势；命中查询需要骨骼时再单独刷新
+    // 需要在组件BeginPlay之前设置，避免注册到预算分配器
+    if (GetNetMode() == NM_DedicatedServer)
+    {
+        if (USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh()))
+        {
+            BudgetedMesh->SetAutoRegisterWithBudgetAllocator(false);
+        }
+        GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+        GetMesh()->bEnableUpdateRateOptimizations = false;
+    }
+
+    Super::BeginPlay();
+
+    HomeLocation = GetActorLocation();
+
+    // 客户端位置完全由快照驱动，移动组件不再自己模拟
+    if (!HasAuthority())
+    {
+        SetActorTickEnabled(true);
+        GetCharacterMovement()->SetComponentTickEnabled(false);
+    }
+
+    // 有本地摄像机的一端按重要度节流敌人的表现更新
+    if (UCharacterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UCharacterSignificanceSubsystem>())
+    {
+        SignificanceSubsystem->RegisterCharacter(this);
+    }
+
+    // 服务器按各连接的视线遮挡决定是否复制
+    if (HasAuthority())
+    {
+        if (UNetOcclusionSubsystem* OcclusionSubsystem = GetWorld()->GetSubsystem<UNetOcclusionSubsystem>())
+        {
+            OcclusionSubsystem->RegisterActor(this);
+        }
+    }
+
+    // 如果还没有控制器，自动生成一个AI控制器
+    if (!GetController() && GetLocalRole() == ROLE_Authority)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("EnemyCharacter没有控制器，正在生成AI控制器..."));
+
+        // 创建AI控制器
+        AAIController* AIController = GetWorld()->SpawnActor<AAIController>(
+            AIControllerClass ? *AIControllerClass : AEnemyAIController::StaticClass(),
+            GetActorLocation(),
+            GetActorRotation()
+        );
+
+        if (AIController)
+        {
+            AIController->Possess(this);
+            UE_LOG(LogTemp, Log, TEXT("AI控制器已附加: %s"), *AIController->GetName());
+        }
+        else
+        {
+            UE_LOG(LogTemp, Error, TEXT("无法生成AI控制器！"));
+        }
+    }
+    else if (GetController())
+    {
+        UE_LOG(LogTemp, Log, TEXT("敌人已有控制器: %s"), *GetController()->GetName());
+    }
+}
+
+void AEnemyCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // 和BeginPlay中的注册对应，避免子系统保留已销毁敌人的条目
+    if (UWorld* World = GetWorld())
+    {
+        if (UCharacterSignificanceSubsystem* SignificanceSubsystem = World->GetSubsystem<UCharacterSignificanceSubsystem>())
+        {
+            SignificanceSubsystem->UnregisterCharacter(this);
+        }
+
+        if (UNetOcclusionSubsystem* OcclusionSubsystem = World->GetSubsystem<UNetOcclusionSubsystem>())
+        {
+            OcclusionSubsystem->UnregisterActor(this);
+        }
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AEnemyCharacter::SetEnemyKiller(AController* NewKiller)
+{
+    KillerControllerRef = NewKiller;
+}
+
+void AEnemyCharacter::ResolveMeleeHit()
+{
+    if (bIsDead || GetLocalRole() != ROLE_Authority) return;
+
+    // 命中点：攻击插槽，没有插槽时取角色前方攻击范围的一半
+    USkeletalMeshComponent* MeshComp = GetMesh();
+    if (MeshComp && GetNetMode() == NM_DedicatedServer && MeshComp->DoesSocketExist(AttackSocketName))
+    {
+        // 服务器平时不计算姿势，这里按当前蒙太奇进度同步算一次骨骼
+        MeshComp->RefreshBoneTransforms();
+    }
+    const FVector HitCenter = (MeshComp && MeshComp->DoesSocketExist(AttackSocketName))
+        ? MeshComp->GetSocketLocation(AttackSocketName)
+        : GetActorLocation() + GetActorForwardVector() * (AttackRange * 0.5f);
+
+    FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EnemyMeleeHit), false, this);
+    TArray<FOverlapResult> Overlaps;
+    GetWorld()->OverlapMultiByObjectType(Overlaps, HitCenter, FQuat::Identity,
+        FCollisionObjectQueryParams(ECC_Pawn), FCollisionShape::MakeSphere(AttackHitRadius), QueryParams);
+
+    // 每次攻击对每个玩家只结算一次伤害
+    TArray<AFPSGameCharacter*, TInlineAllocator<4>> HitPlayers;
+    for (const FOverlapResult& Overlap : Overlaps)
+    {
+        AFPSGameCharacter* Player = Cast<AFPSGameCharacter>(Overlap.GetActor());
+        if (!Player || HitPlayers.Contains(Player))
+        {
+            continue;
+        }
+        HitPlayers.Add(Player);
+
+        // 对玩家造成伤害
+        UGameplayStatics::ApplyDamage(
+            Player,
+            AttackDamage,
+            GetController(),
+            this,
+            UDamageType::StaticClass()
+        );
+    }
+}
+
+// 执行攻击逻辑
+void AEnemyCharacter::AttackTarget()
+{
+    if (bIsDead || !CurrentTargetPlayer) return;
+
+    LastAttackTime = GetWorld()->GetTimeSeconds();
+    UE_LOG(LogTemp, Log, TEXT("敌人发起攻击，目标：%s"), *CurrentTargetPlayer->GetName());
+
+    // 有攻击动画时由动画里的EnemyMeleeHit通知在命中帧结算，否则按时序表在命中帧结算
+    if (!AttackMontage || PlayAnimMontage(AttackMontage) <= 0.0f)
+    {
+        GetWorld()->GetTimerManager().SetTimer(
+            AttackHitTimerHandle,
+            this,
+            &AEnemyCharacter::ResolveMeleeHit,
+            AttackHitDelay,
+            false
+        );
+    }
+
+    // 3. 转向目标（让敌人面对玩家）
+    FRotator LookAtRotation = UKismetMathLibrary::FindLookAtRotation(
+        GetActorLocation(),
+        CurrentTargetPlayer->GetActorLocation()
+    );
+    LookAtRotation.Pitch = 0; // 只在水平方向转向
+    SetActorRotation(LookAtRotation);
+}
+
+
+// 重写TakeDamage，接收子弹的ApplyDamage调用
+float AEnemyCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+    // 调用父类的TakeDamage（UE默认逻辑）
+    float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+
+    // 记录造成伤害的控制器
+    if (EventInstigator && ActualDamage > 0)
+    {
+        KillerControllerRef = EventInstigator;
+    }
+
+    // 仅服务器端执行扣血逻辑
+    if (GetLocalRole() == ROLE_Authority)
+    {
+        Server_TakeDamage(ActualDamage, EventInstigator);
+    }
+
+    return ActualDamage;
+}
+
+void AEnemyCharacter::Server_TakeDamage_Implementation(float DamageAmount, AController* InstigatorController)
+{
+    if (bIsDead) return;
+
+    // 验证伤害值合法性
+    if (DamageAmount <= 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("无效伤害值：%.1f，忽略扣血"), DamageAmount);
+        return;
+    }
+
+    CurrentHealth -= DamageAmount;
+    UE_LOG(LogTemp, Log, TEXT("敌人受到伤害: %f, 剩余生命值: %f"), DamageAmount, CurrentHealth);
+
+    // 记录击杀者控制器
+    if (CurrentHealth <= 0.0f)
+    {
+        KillerInstigator = InstigatorController;
+        Multicast_Die(KillerInstigator);
+    }
+}
+
+bool AEnemyCharacter::Server_TakeDamage_Validate(float DamageAmount, AController* InstigatorController)
+{
+    return true;// 简单验证
+}
+
+void AEnemyCharacter::Multicast_Die_Implementation(AController* KillerController)
+{
+    // 确保只在服务器上执行
+    if (GetLocalRole() != ROLE_Authority)
+    {
+        return;
+    }
+
+    // 输出击杀者信息
+    if (KillerControllerRef)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("敌人 %s 被玩家 %s 击杀"),
+            *GetName(), *KillerControllerRef->GetName());
+    }
+    else
+    {
+        UE_LOG(LogTemp, Warning, TEXT("敌人 %s 死亡，但没有记录击杀者"), *GetName());
+    }
+
+    bIsDead = true;
+
+    // 停止所有移动
+    AAIController* AIController = Cast<AAIController>(GetController());
+    if (AIController)
+    {
+        AIController->StopMovement();
+    }
+
+    // 禁用碰撞
+    GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    GetWorldTimerManager().ClearTimer(AttackHitTimerHandle);
+
+    // 播放死亡动画
+    //PlayAnimMontage(DeathMontage);
+
+    // 通知GameMode，并把尸体回收到对象池
+    UWorld* World = GetWorld();
+    AMyGameMode* GameMode = World ? Cast<AMyGameMode>(UGameplayStatics::GetGameMode(World)) : nullptr;
+    if (GameMode)
+    {
+        GameMode->OnEnemyDeath(this);
+        GameMode->ReleaseEnemy(this);
+    }
+    else
+    {
+        //销毁尸体
+        Destroy();
+    }
+}
+
+void AEnemyCharacter::ActivateFromPool(const FVector& Location, const FRotator& Rotation)
+{
+    if (GetLocalRole() != ROLE_Authority)
+    {
+        return;
+    }
+
+    // 退出网络休眠，让客户端收到新的状态
+    SetNetDormancy(DORM_Awake);
+    FlushNetDormancy();
+
+    // 重置状态
+    CurrentHealth = MaxHealth;
+    bIsDead = false;
+    LastAttackTime = 0.0f;
+    CurrentTargetPlayer = nullptr;
+    KillerControllerRef = nullptr;
+    KillerInstigator = nullptr;
+
+    TeleportTo(Location, Rotation, false, true);
+
+    // 客户端看到传送计数变化时直接跳到新位置，不从旧位置插值过来
+    MovementSnapshot.TeleportCounter = (MovementSnapshot.TeleportCounter + 1) & 0x3;
+
+    // 新的出生点附近重新生成巡逻路线
+    HomeLocation = Location;
+    PatrolPoints.Reset();
+    CurrentPatrolPointIndex = 0;
+
+    SetActorHiddenInGame(false);
+    GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+    GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+    if (AEnemyAIController* EnemyController = Cast<AEnemyAIController>(GetController()))
+    {
+        EnemyController->ResetBrain();
+    }
+}
+
+void AEnemyCharacter::DeactivateToPool()
+{
+    if (GetLocalRole() != ROLE_Authority)
+    {
+        return;
+    }
+
+    bIsDead = true;
+    CurrentTargetPlayer = nullptr;
+    GetWorldTimerManager().ClearTimer(AttackHitTimerHandle);
+    StopAnimMontage();
+
+    if (AAIController* AIController = Cast<AAIController>(GetController()))
+    {
+        AIController->StopMovement();
+    }
+
+    SetActorHiddenInGame(true);
+    GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    GetCharacterMovement()->StopMovementImmediately();
+    GetCharacterMovement()->DisableMovement();
+
+    // 发送完最后一次状态后进入休眠，池中的敌人不再占用网络更新
+    ForceNetUpdate();
+    SetNetDormancy(DORM_DormantAll);
+}
+
+bool AEnemyCharacter::Multicast_Die_Validate(AController* KillerController)
+{
+    return true;
+}
+
+// 寻找攻击范围内的玩家目标
+void AEnemyCharacter::FindValidPlayerTarget()
+{
+    // 从共享的目标数据中找攻击范围内最近、且没有被墙挡住的玩家
+    UEnemyTargetSubsystem* TargetSubsystem = GetWorld()->GetSubsystem<UEnemyTargetSubsystem>();
+    CurrentTargetPlayer = TargetSubsystem ? TargetSubsystem->FindNearestVisibleTarget(this, AttackRange) : nullptr;
+}
+
+bool AEnemyCharacter::GetNextPatrolPoint(FVector& OutPoint)
+{
+    if (PatrolPoints.Num() == 0)
+    {
+        UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+        if (!NavSys)
+        {
+            return false;
+        }
+
+        for (int32 Index = 0; Index < MaxPatrolPoints; ++Index)
+        {
+            FNavLocation NavLocation;
+            if (NavSys->GetRandomReachablePointInRadius(HomeLocation, PatrolRadius, NavLocation))
+            {
+                PatrolPoints.Add(NavLocation.Location);
+            }
+        }
+
+        if (PatrolPoints.Num() == 0)
+        {
+            return false;
+        }
+    }
+
+    OutPoint = PatrolPoints[CurrentPatrolPointIndex % PatrolPoints.Num()];
+    CurrentPatrolPointIndex = (CurrentPatrolPointIndex + 1) % PatrolPoints.Num();
+    return true;
+}
+
+// 检查是否满足攻击条件
+bool AEnemyCharacter::CanAttack()
+{
+    if (!CurrentTargetPlayer || CurrentTargetPlayer->GetCurrentHealth() <= 0)
+    {
+        return false;
+    }
+
+    // 检查攻击间隔
+    float CurrentTime = GetWorld()->GetTimeSeconds();
+    if (CurrentTime - LastAttackTime < AttackInterval)
+    {
+        return false;
+    }
+
+    // 再次确认距离（防止目标移动出范围），比较平方距离不开方
+    return FVector::DistSquared(GetActorLocation(), CurrentTargetPlayer->GetActorLocation()) <= FMath::Square(AttackRange);
+}
+
+void AEnemyCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    // 声明需要同步的属性（根据实际需求添加，例如生命值）
+    DOREPLIFETIME(AEnemyCharacter, CurrentHealth);
+    DOREPLIFETIME(AEnemyCharacter, bIsDead);
+    DOREPLIFETIME(AEnemyCharacter, MovementSnapshot);
+}
+
+void AEnemyCharacter::UpdateNetUpdateRate(float NearestPlayerDistance)
+{
+    const float Alpha = FMath::Clamp((NearestPlayerDistance - SnapshotRateNearDistance)
+        / FMath::Max(SnapshotRateFarDistance - SnapshotRateNearDistance, 1.0f), 0.0f, 1.0f);
+    const float NewRate = FMath::Lerp(MaxSnapshotRate, MinSnapshotRate, Alpha);
+
+    if (!FMath::IsNearlyEqual(GetNetUpdateFrequency(), NewRate, 0.5f))
+    {
+        SetNetUpdateFrequency(NewRate);
+    }
+}
+
+bool AEnemyCharacter::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+    if (!Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation))
+    {
+        return false;
+    }
+
+    const UNetOcclusionSubsystem* OcclusionSubsystem = GetWorld()->GetSubsystem<UNetOcclusionSubsystem>();
+    return !OcclusionSubsystem || !OcclusionSubsystem->IsOccludedFor(RealViewer, this);
+}
+
+float AEnemyCharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+    float Priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+    if (const UNetOcclusionSubsystem* OcclusionSubsystem = GetWorld()->GetSubsystem<UNetOcclusionSubsystem>())
+    {
+        Priority *= OcclusionSubsystem->GetNetPriorityScale(Viewer, this);
+    }
+
+    // 连接拥塞时远处的敌人让出带宽，近处的威胁保持原优先级
+    if (const UFPSIpNetDriver* NetDriver = Cast<UFPSIpNetDriver>(GetNetDriver()))
+    {
+        Priority *= NetDriver->GetPriorityScale(InChannel ? InChannel->Connection : nullptr, FVector::DistSquared(ViewPos, GetActorLocation()));
+    }
+
+    return Priority;
+}
+
+void AEnemyCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    Super::PreReplication(ChangedPropertyTracker);
+
+    // 只在量化后的位置或朝向变化时更新快照，静止的敌人不产生移动流量
+    const FVector Location = GetActorLocation().RoundToVector();
+    const float Yaw = GetActorRotation().Yaw;
+    if (Location.Equals(MovementSnapshot.Location) && FRotator::CompressAxisToByte(Yaw) == FRotator::CompressAxisToByte(MovementSnapshot.Yaw))
+    {
+        return;
+    }
+
+    MovementSnapshot.Location = Location;
+    MovementSnapshot.Yaw = Yaw;
+    MovementSnapshot.ServerTimeMs = static_cast<uint16>(FMath::FloorToInt64(GetWorld()->GetTimeSeconds() * 1000.0) & 0xFFFF);
+}
+
+void AEnemyCharacter::OnRep_MovementSnapshot()
+{
+    if (!SnapshotBuffer.AddSnapshot(MovementSnapshot, GetWorld()->GetTimeSeconds()))
+    {
+        SetActorLocationAndRotation(MovementSnapshot.Location, FRotator(0.0f, MovementSnapshot.Yaw, 0.0f));
+    }
+}
+
+void AEnemyCharacter::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    FVector Location;
+    float Yaw;
+    FVector Velocity;
+    if (HasAuthority() || !SnapshotBuffer.Sample(GetWorld()->GetTimeSeconds(), Location, Yaw, Velocity))
+    {
+        return;
+    }
+
+    // 动画蓝图按移动组件的速度选择动作
+    GetCharacterMovement()->Velocity = Velocity;
+
+    const FRotator Rotation(0.0f, Yaw, 0.0f);
+    if (!Location.Equals(GetActorLocation(), 0.1) || !Rotation.Equals(GetActorRotation(), 0.1f))
+    {
+        SetActorLocationAndRotation(Location, Rotation);
+    }
 }
\ No newline at end of file
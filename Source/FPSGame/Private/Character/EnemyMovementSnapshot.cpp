@@ -0,0 +1,313 @@
+#include "Character/EnemyMovementSnapshot.h"
+#include "Engine/NetSerialization.h"
+#if UE_WITH_IRIS
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializationContext.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#endif
+
+bool FEnemyMovementSnapshot::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    // 厘米精度，每轴最多20位
+    bOutSuccess = SerializePackedVector<1, 20>(Location, Ar);
+
+    uint8 CompressedYaw = Ar.IsSaving() ? FRotator::CompressAxisToByte(Yaw) : 0;
+    Ar << CompressedYaw;
+    Ar << ServerTimeMs;
+
+    // 传送计数只需要分辨“变了没有”，2位足够
+    Ar.SerializeBits(&TeleportCounter, 2);
+
+    if (Ar.IsLoading())
+    {
+        Yaw = FRotator::DecompressAxisFromByte(CompressedYaw);
+        TeleportCounter &= 0x3;
+    }
+
+    return true;
+}
+
+bool FEnemySnapshotBuffer::AddSnapshot(const FEnemyMovementSnapshot& Snapshot, double LocalTime)
+{
+    const bool bTeleported = bHasClock && Snapshot.TeleportCounter != LastTeleportCounter;
+    LastTeleportCounter = Snapshot.TeleportCounter;
+
+    // 展开16位毫秒时间戳：和本地估计的服务器时间取有符号差值，乱序到达的旧快照得到更早的时间。
+    // 不和上一个快照比较，静止的敌人不更新时间戳，间隔超过半圈时差值会回绕成负数
+    double ServerTime;
+    if (!bHasClock)
+    {
+        ServerTime = Snapshot.ServerTimeMs / 1000.0;
+    }
+    else
+    {
+        const int64 EstimatedMs = FMath::RoundToInt64((LocalTime + ClockOffset) * 1000.0);
+        const int16 DeltaMs = static_cast<int16>(static_cast<uint16>(Snapshot.ServerTimeMs - static_cast<uint16>(EstimatedMs)));
+        ServerTime = (EstimatedMs + DeltaMs) / 1000.0;
+    }
+
+    if (bTeleported)
+    {
+        Entries.Reset();
+    }
+
+    // 乱序或重复的快照直接丢弃
+    if (!Entries.IsEmpty() && ServerTime <= Entries.Last().ServerTime)
+    {
+        return !bTeleported;
+    }
+
+    if (!Entries.IsEmpty())
+    {
+        const double Gap = ServerTime - Entries.Last().ServerTime;
+        if (Gap > AverageInterval * 3.0)
+        {
+            // 服务器在敌人静止时不发快照，补一个“刚开始移动前还在原地”的快照，避免从很久以前的位置慢慢滑过来
+            FEntry Resting = Entries.Last();
+            Resting.ServerTime = ServerTime - AverageInterval;
+            Entries.Add(Resting);
+            if (Entries.Num() > MaxEntries)
+            {
+                Entries.RemoveAt(0, 1, EAllowShrinking::No);
+            }
+        }
+        else
+        {
+            AverageInterval = FMath::Lerp(AverageInterval, Gap, 0.1);
+        }
+    }
+
+    // 时钟偏移只往“更早到达”的方向快速收敛，网络抖动造成的晚到只缓慢影响
+    const double OffsetSample = ServerTime - LocalTime;
+    if (!bHasClock)
+    {
+        ClockOffset = OffsetSample;
+        bHasClock = true;
+    }
+    else
+    {
+        ClockOffset = OffsetSample > ClockOffset
+            ? FMath::Lerp(ClockOffset, OffsetSample, 0.5)
+            : FMath::Lerp(ClockOffset, OffsetSample, 0.02);
+    }
+
+    if (Entries.Num() == MaxEntries)
+    {
+        Entries.RemoveAt(0, 1, EAllowShrinking::No);
+    }
+    Entries.Add({ ServerTime, Snapshot.Location, Snapshot.Yaw });
+
+    return !bTeleported;
+}
+
+bool FEnemySnapshotBuffer::Sample(double LocalTime, FVector& OutLocation, float& OutYaw, FVector& OutVelocity) const
+{
+    if (Entries.IsEmpty())
+    {
+        return false;
+    }
+
+    OutVelocity = FVector::ZeroVector;
+
+    const double Delay = FMath::Clamp(AverageInterval * 2.0, static_cast<double>(MinInterpolationDelay), static_cast<double>(MaxInterpolationDelay));
+    const double RenderTime = LocalTime + ClockOffset - Delay;
+
+    if (Entries.Num() == 1 || RenderTime <= Entries[0].ServerTime)
+    {
+        const FEntry& Entry = RenderTime <= Entries[0].ServerTime ? Entries[0] : Entries.Last();
+        OutLocation = Entry.Location;
+        OutYaw = Entry.Yaw;
+        return true;
+    }
+
+    // 找到包住渲染时间的两个快照；超出最新快照时沿最后一段速度外推一小段
+    int32 ToIndex = 1;
+    while (ToIndex < Entries.Num() - 1 && Entries[ToIndex].ServerTime < RenderTime)
+    {
+        ++ToIndex;
+    }
+
+    const FEntry& From = Entries[ToIndex - 1];
+    const FEntry& To = Entries[ToIndex];
+    const double Span = FMath::Max(To.ServerTime - From.ServerTime, UE_KINDA_SMALL_NUMBER);
+    const double MaxAlpha = 1.0 + MaxExtrapolation / Span;
+    const double Alpha = FMath::Clamp((RenderTime - From.ServerTime) / Span, 0.0, MaxAlpha);
+
+    OutLocation = FMath::Lerp(From.Location, To.Location, Alpha);
+    OutYaw = Alpha >= 1.0 ? To.Yaw : FMath::Lerp(From.Yaw, From.Yaw + FRotator::NormalizeAxis(To.Yaw - From.Yaw), static_cast<float>(Alpha));
+    if (Alpha < MaxAlpha)
+    {
+        OutVelocity = (To.Location - From.Location) / Span;
+    }
+    return true;
+}
+
+void FEnemySnapshotBuffer::Reset()
+{
+    Entries.Reset();
+    AverageInterval = 0.1;
+    bHasClock = false;
+}
+
+#if UE_WITH_IRIS
+namespace UE::Net
+{
+    struct FEnemyMovementSnapshotNetSerializer
+    {
+        static constexpr uint32 Version = 0;
+
+        struct FQuantizedType
+        {
+            int32 X = 0;
+            int32 Y = 0;
+            int32 Z = 0;
+            uint16 ServerTimeMs = 0;
+            uint8 Yaw = 0;
+            uint8 TeleportCounter = 0;
+        };
+
+        typedef FEnemyMovementSnapshot SourceType;
+        typedef FEnemyMovementSnapshotNetSerializerConfig ConfigType;
+
+        static const ConfigType DefaultConfig;
+
+        static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+        static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+        static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+        static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+        static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+
+    private:
+        // 和SerializePackedVector<1, 20>一样的范围：每轴最多20位
+        static constexpr int32 MaxComponentValue = (1 << 20) - 1;
+
+        static void QuantizeSource(const SourceType& Source, FQuantizedType& Target);
+        static void WritePackedComponent(FNetBitStreamWriter* Writer, int32 Value);
+        static int32 ReadPackedComponent(FNetBitStreamReader* Reader);
+
+        class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+        {
+        public:
+            virtual ~FNetSerializerRegistryDelegates();
+
+        private:
+            virtual void OnPreFreezeNetSerializerRegistry() override;
+        };
+
+        static FEnemyMovementSnapshotNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+    };
+
+    UE_NET_IMPLEMENT_SERIALIZER(FEnemyMovementSnapshotNetSerializer);
+
+    const FEnemyMovementSnapshotNetSerializer::ConfigType FEnemyMovementSnapshotNetSerializer::DefaultConfig;
+    FEnemyMovementSnapshotNetSerializer::FNetSerializerRegistryDelegates FEnemyMovementSnapshotNetSerializer::NetSerializerRegistryDelegates;
+
+    // 让FEnemyMovementSnapshot属性在Iris下使用这个序列化器，而不是退回到旧的NetSerialize
+    static const FName PropertyNetSerializerRegistry_NAME_EnemyMovementSnapshot("EnemyMovementSnapshot");
+    UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EnemyMovementSnapshot, FEnemyMovementSnapshotNetSerializer);
+
+    FEnemyMovementSnapshotNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+    {
+        UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EnemyMovementSnapshot);
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+    {
+        UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EnemyMovementSnapshot);
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::WritePackedComponent(FNetBitStreamWriter* Writer, int32 Value)
+    {
+        // ZigZag后写位数（5位）再写数值，小坐标只占很少的位
+        const uint32 ZigZag = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+        const uint32 BitCount = ZigZag ? FMath::FloorLog2(ZigZag) + 1 : 0;
+        Writer->WriteBits(BitCount, 5);
+        if (BitCount)
+        {
+            Writer->WriteBits(ZigZag, BitCount);
+        }
+    }
+
+    int32 FEnemyMovementSnapshotNetSerializer::ReadPackedComponent(FNetBitStreamReader* Reader)
+    {
+        const uint32 BitCount = Reader->ReadBits(5);
+        const uint32 ZigZag = BitCount ? Reader->ReadBits(BitCount) : 0;
+        return static_cast<int32>(ZigZag >> 1) ^ -static_cast<int32>(ZigZag & 1);
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+    {
+        const FQuantizedType& Value = *reinterpret_cast<const FQuantizedType*>(Args.Source);
+        FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+
+        WritePackedComponent(Writer, Value.X);
+        WritePackedComponent(Writer, Value.Y);
+        WritePackedComponent(Writer, Value.Z);
+        Writer->WriteBits(Value.Yaw, 8);
+        Writer->WriteBits(Value.ServerTimeMs, 16);
+        Writer->WriteBits(Value.TeleportCounter, 2);
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+    {
+        FQuantizedType& Target = *reinterpret_cast<FQuantizedType*>(Args.Target);
+        FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+
+        Target.X = ReadPackedComponent(Reader);
+        Target.Y = ReadPackedComponent(Reader);
+        Target.Z = ReadPackedComponent(Reader);
+        Target.Yaw = static_cast<uint8>(Reader->ReadBits(8));
+        Target.ServerTimeMs = static_cast<uint16>(Reader->ReadBits(16));
+        Target.TeleportCounter = static_cast<uint8>(Reader->ReadBits(2));
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::QuantizeSource(const SourceType& Source, FQuantizedType& Target)
+    {
+        Target.X = FMath::Clamp(FMath::RoundToInt32(Source.Location.X), -MaxComponentValue, MaxComponentValue);
+        Target.Y = FMath::Clamp(FMath::RoundToInt32(Source.Location.Y), -MaxComponentValue, MaxComponentValue);
+        Target.Z = FMath::Clamp(FMath::RoundToInt32(Source.Location.Z), -MaxComponentValue, MaxComponentValue);
+        Target.Yaw = FRotator::CompressAxisToByte(Source.Yaw);
+        Target.ServerTimeMs = Source.ServerTimeMs;
+        Target.TeleportCounter = Source.TeleportCounter & 0x3;
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+    {
+        QuantizeSource(*reinterpret_cast<const SourceType*>(Args.Source), *reinterpret_cast<FQuantizedType*>(Args.Target));
+    }
+
+    void FEnemyMovementSnapshotNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+    {
+        const FQuantizedType& Source = *reinterpret_cast<const FQuantizedType*>(Args.Source);
+        SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+
+        Target.Location = FVector(Source.X, Source.Y, Source.Z);
+        Target.Yaw = FRotator::DecompressAxisFromByte(Source.Yaw);
+        Target.ServerTimeMs = Source.ServerTimeMs;
+        Target.TeleportCounter = Source.TeleportCounter;
+    }
+
+    bool FEnemyMovementSnapshotNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+    {
+        FQuantizedType Value0;
+        FQuantizedType Value1;
+        if (Args.bStateIsQuantized)
+        {
+            Value0 = *reinterpret_cast<const FQuantizedType*>(Args.Source0);
+            Value1 = *reinterpret_cast<const FQuantizedType*>(Args.Source1);
+        }
+        else
+        {
+            QuantizeSource(*reinterpret_cast<const SourceType*>(Args.Source0), Value0);
+            QuantizeSource(*reinterpret_cast<const SourceType*>(Args.Source1), Value1);
+        }
+
+        return Value0.X == Value1.X && Value0.Y == Value1.Y && Value0.Z == Value1.Z
+            && Value0.Yaw == Value1.Yaw
+            && Value0.ServerTimeMs == Value1.ServerTimeMs
+            && Value0.TeleportCounter == Value1.TeleportCounter;
+    }
+}
+#endif
@@ -0,0 +1,369 @@
+#include "Character/FPSGameMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameNetworkManager.h"
+#include "Net/TimeSyncComponent.h"
+#include "Engine/NetSerialization.h"
+#include "UObject/CoreNet.h"
+#include "HAL/PlatformTime.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FFPSGameNetworkMoveData
+
+void FFPSGameNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+    FCharacterNetworkMoveData::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+    ServerTime = static_cast<const FSavedMove_FPSGame&>(ClientMove).SavedServerTime;
+}
+
+bool FFPSGameNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+    NetworkMoveType = MoveType;
+
+    const bool bIsSaving = Ar.IsSaving();
+    const bool bIsNewMove = MoveType == ENetworkMoveType::NewMove;
+    bool bLocalSuccess = true;
+
+    Ar << TimeStamp;
+
+    // 加速度：每轴8位，地面移动时Z为0只占1位
+    const float MaxAccel = CharacterMovement.GetMaxAcceleration();
+    int8 AccelX = 0;
+    int8 AccelY = 0;
+    int8 AccelZ = 0;
+    if (bIsSaving)
+    {
+        AccelX = UFPSGameMovementComponent::QuantizeAccelerationAxis(Acceleration.X, MaxAccel);
+        AccelY = UFPSGameMovementComponent::QuantizeAccelerationAxis(Acceleration.Y, MaxAccel);
+        AccelZ = UFPSGameMovementComponent::QuantizeAccelerationAxis(Acceleration.Z, MaxAccel);
+    }
+
+    uint8 bHasAccelZ = AccelZ != 0 ? 1 : 0;
+    Ar << AccelX;
+    Ar << AccelY;
+    Ar.SerializeBits(&bHasAccelZ, 1);
+    if (bHasAccelZ)
+    {
+        Ar << AccelZ;
+    }
+
+    if (!bIsSaving)
+    {
+        Acceleration = FVector(
+            UFPSGameMovementComponent::DequantizeAccelerationAxis(AccelX, MaxAccel),
+            UFPSGameMovementComponent::DequantizeAccelerationAxis(AccelY, MaxAccel),
+            bHasAccelZ ? UFPSGameMovementComponent::DequantizeAccelerationAxis(AccelZ, MaxAccel) : 0.0);
+    }
+
+    // 视角：不发Roll；旧移动只在丢包时补发，精度降到每轴8位
+    if (MoveType == ENetworkMoveType::OldMove)
+    {
+        uint8 Yaw = bIsSaving ? FRotator::CompressAxisToByte(ControlRotation.Yaw) : 0;
+        uint8 Pitch = bIsSaving ? FRotator::CompressAxisToByte(ControlRotation.Pitch) : 0;
+        Ar << Yaw;
+        Ar << Pitch;
+        if (!bIsSaving)
+        {
+            ControlRotation = FRotator(FRotator::DecompressAxisFromByte(Pitch), FRotator::DecompressAxisFromByte(Yaw), 0.0f);
+        }
+    }
+    else
+    {
+        uint16 Yaw = bIsSaving ? FRotator::CompressAxisToShort(ControlRotation.Yaw) : 0;
+        uint16 Pitch = bIsSaving ? FRotator::CompressAxisToShort(ControlRotation.Pitch) : 0;
+        Ar << Yaw;
+        Ar << Pitch;
+        if (!bIsSaving)
+        {
+            ControlRotation = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), 0.0f);
+        }
+    }
+
+    // 移动标志：大多数帧为0，只占1位
+    uint8 bHasFlags = CompressedMoveFlags != 0 ? 1 : 0;
+    Ar.SerializeBits(&bHasFlags, 1);
+    if (bHasFlags)
+    {
+        Ar << CompressedMoveFlags;
+    }
+    else if (!bIsSaving)
+    {
+        CompressedMoveFlags = 0;
+    }
+
+    // 位置、移动基础和移动模式只用于服务器在新移动上做误差校验
+    if (bIsNewMove)
+    {
+        FVector_NetQuantize10 QuantizedLocation(Location);
+        QuantizedLocation.NetSerialize(Ar, PackageMap, bLocalSuccess);
+        if (!bIsSaving)
+        {
+            Location = QuantizedLocation;
+        }
+
+        uint8 bHasBase = MovementBase != nullptr ? 1 : 0;
+        Ar.SerializeBits(&bHasBase, 1);
+        if (bHasBase)
+        {
+            Ar << MovementBase;
+        }
+        else if (!bIsSaving)
+        {
+            MovementBase = nullptr;
+        }
+
+        uint8 bHasBoneName = MovementBaseBoneName != NAME_None ? 1 : 0;
+        Ar.SerializeBits(&bHasBoneName, 1);
+        if (bHasBoneName)
+        {
+            Ar << MovementBaseBoneName;
+        }
+        else if (!bIsSaving)
+        {
+            MovementBaseBoneName = NAME_None;
+        }
+
+        uint8 bIsWalking = MovementMode == MOVE_Walking ? 1 : 0;
+        Ar.SerializeBits(&bIsWalking, 1);
+        if (!bIsWalking)
+        {
+            Ar << MovementMode;
+        }
+        else if (!bIsSaving)
+        {
+            MovementMode = MOVE_Walking;
+        }
+
+        Ar << ServerTime;
+    }
+
+    return bLocalSuccess && !Ar.IsError();
+}
+
+FFPSGameNetworkMoveDataContainer::FFPSGameNetworkMoveDataContainer()
+{
+    NewMoveData = &MoveData[0];
+    PendingMoveData = &MoveData[1];
+    OldMoveData = &MoveData[2];
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UFPSGameMovementComponent
+
+UFPSGameMovementComponent::UFPSGameMovementComponent()
+{
+    bWantsToSprint = false;
+
+    SetNetworkMoveDataContainer(MoveDataContainer);
+}
+
+void UFPSGameMovementComponent::ServerMove_PerformMovement(const FCharacterNetworkMoveData& MoveData)
+{
+    // 新移动带有客户端的同步时间戳，还原后校验，超出范围时夹到可回溯的范围内
+    if (MoveData.NetworkMoveType == FCharacterNetworkMoveData::ENetworkMoveType::NewMove)
+    {
+        LastMoveServerTime = GetWorld()->GetTimeSeconds();
+        if (const UTimeSyncComponent* TimeSync = UTimeSyncComponent::Get(CharacterOwner))
+        {
+            const uint16 ServerTime = static_cast<const FFPSGameNetworkMoveData&>(MoveData).ServerTime;
+            TimeSync->ValidateClientTime(TimeSync->DecompressTime(ServerTime), LastMoveServerTime);
+        }
+    }
+
+    Super::ServerMove_PerformMovement(MoveData);
+}
+
+FNetworkPredictionData_Client* UFPSGameMovementComponent::GetPredictionData_Client() const
+{
+    if (ClientPredictionData == nullptr)
+    {
+        UFPSGameMovementComponent* MutableThis = const_cast<UFPSGameMovementComponent*>(this);
+        MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_FPSGame(*this);
+    }
+
+    return ClientPredictionData;
+}
+
+void UFPSGameMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+    Super::UpdateFromCompressedFlags(Flags);
+
+    bWantsToSprint = (Flags & FLAG_WantsToSprint) != 0;
+}
+
+float UFPSGameMovementComponent::GetMaxSpeed() const
+{
+    const float MaxSpeed = Super::GetMaxSpeed();
+    return (bWantsToSprint && IsMovingOnGround()) ? MaxSpeed * SprintSpeedMultiplier : MaxSpeed;
+}
+
+FVector UFPSGameMovementComponent::RoundAcceleration(FVector InAccel) const
+{
+    const float MaxAccel = GetMaxAcceleration();
+    return FVector(
+        DequantizeAccelerationAxis(QuantizeAccelerationAxis(InAccel.X, MaxAccel), MaxAccel),
+        DequantizeAccelerationAxis(QuantizeAccelerationAxis(InAccel.Y, MaxAccel), MaxAccel),
+        DequantizeAccelerationAxis(QuantizeAccelerationAxis(InAccel.Z, MaxAccel), MaxAccel));
+}
+
+int8 UFPSGameMovementComponent::QuantizeAccelerationAxis(double Value, float MaxAccel)
+{
+    if (MaxAccel <= UE_KINDA_SMALL_NUMBER)
+    {
+        return 0;
+    }
+    return static_cast<int8>(FMath::Clamp(FMath::RoundToInt(Value / MaxAccel * 127.0), -127, 127));
+}
+
+double UFPSGameMovementComponent::DequantizeAccelerationAxis(int8 Value, float MaxAccel)
+{
+    return static_cast<double>(Value) / 127.0 * MaxAccel;
+}
+
+void UFPSGameMovementComponent::RunBandwidthBenchmark(int32 NumClients)
+{
+    UFPSGameMovementComponent& Movement = *GetMutableDefault<UFPSGameMovementComponent>();
+    const AGameNetworkManager* NetworkManager = GetDefault<AGameNetworkManager>();
+    const float SendRate = 1.0f / FMath::Max(NetworkManager->ClientNetSendMoveDeltaTime, 0.001f);
+    const float MaxAccel = Movement.GetMaxAcceleration();
+
+    constexpr int32 NumSamples = 2000;
+    FRandomStream Random(NumClients);
+
+    int64 DefaultBits = 0;
+    int64 CompactBits = 0;
+    int32 NumMismatches = 0;
+    double CompactSeconds = 0.0;
+
+    for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+    {
+        // 模拟一个典型的FPS移动帧：大多在地面移动，偶尔跳跃和下落
+        FCharacterNetworkMoveData Source;
+        Source.TimeStamp = Sample / SendRate;
+        const FVector2D Input = FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f)).GetClampedToMaxSize(1.0f);
+        Source.Acceleration = FVector(Input.X, Input.Y, 0.0) * MaxAccel;
+        Source.Location = FVector(Random.FRandRange(-20000.0f, 20000.0f), Random.FRandRange(-20000.0f, 20000.0f), Random.FRandRange(0.0f, 2000.0f));
+        Source.ControlRotation = FRotator(Random.FRandRange(-89.0f, 89.0f), Random.FRandRange(0.0f, 360.0f), 0.0f);
+        Source.CompressedMoveFlags = Random.FRand() < 0.05f ? FSavedMove_Character::FLAG_JumpPressed : 0;
+        Source.MovementMode = Random.FRand() < 0.1f ? MOVE_Falling : MOVE_Walking;
+
+        // 每个包按一个新移动加一个合并发送的待定移动计算
+        for (const FCharacterNetworkMoveData::ENetworkMoveType MoveType : { FCharacterNetworkMoveData::ENetworkMoveType::NewMove, FCharacterNetworkMoveData::ENetworkMoveType::PendingMove })
+        {
+            FNetBitWriter DefaultWriter(nullptr, 512);
+            FCharacterNetworkMoveData DefaultData = Source;
+            DefaultData.Serialize(Movement, DefaultWriter, nullptr, MoveType);
+            DefaultBits += DefaultWriter.GetNumBits();
+
+            const double StartTime = FPlatformTime::Seconds();
+            FNetBitWriter CompactWriter(nullptr, 512);
+            FFPSGameNetworkMoveData CompactData;
+            static_cast<FCharacterNetworkMoveData&>(CompactData) = Source;
+            CompactData.ServerTime = UTimeSyncComponent::CompressTime(Source.TimeStamp);
+            CompactData.Serialize(Movement, CompactWriter, nullptr, MoveType);
+
+            FNetBitReader Reader(nullptr, CompactWriter.GetData(), CompactWriter.GetNumBits());
+            FFPSGameNetworkMoveData Decoded;
+            Decoded.Serialize(Movement, Reader, nullptr, MoveType);
+            CompactSeconds += FPlatformTime::Seconds() - StartTime;
+            CompactBits += CompactWriter.GetNumBits();
+
+            // 解出来的值必须和客户端预测时使用的量化值一致
+            const bool bAccelMatches = Decoded.Acceleration.Equals(Movement.RoundAcceleration(Source.Acceleration), 0.01);
+            const bool bRotationMatches = FMath::Abs(FRotator::NormalizeAxis(Decoded.ControlRotation.Yaw - Source.ControlRotation.Yaw)) < 0.01f
+                && FMath::Abs(FRotator::NormalizeAxis(Decoded.ControlRotation.Pitch - Source.ControlRotation.Pitch)) < 0.01f;
+            const bool bNewMoveMatches = MoveType != FCharacterNetworkMoveData::ENetworkMoveType::NewMove
+                || (Decoded.Location.Equals(Source.Location, 0.1) && Decoded.MovementMode == Source.MovementMode && Decoded.ServerTime == CompactData.ServerTime);
+            if (!bAccelMatches || !bRotationMatches || !bNewMoveMatches || Decoded.CompressedMoveFlags != Source.CompressedMoveFlags)
+            {
+                ++NumMismatches;
+            }
+        }
+    }
+
+    const double DefaultBitsPerPacket = static_cast<double>(DefaultBits) / NumSamples;
+    const double CompactBitsPerPacket = static_cast<double>(CompactBits) / NumSamples;
+    const double DefaultKbps = DefaultBitsPerPacket * SendRate * NumClients / 1000.0;
+    const double CompactKbps = CompactBitsPerPacket * SendRate * NumClients / 1000.0;
+
+    UE_LOG(LogTemp, Warning, TEXT("上行移动带宽 %d个客户端 @ %.0f包/秒: 默认 %.1f位/包 %.1fkbps, 压缩 %.1f位/包 %.1fkbps, 减少 %.1f%%, 编解码 %.2fus/包, 不一致 %d"),
+        NumClients, SendRate,
+        DefaultBitsPerPacket, DefaultKbps,
+        CompactBitsPerPacket, CompactKbps,
+        DefaultBits > 0 ? 100.0 * (1.0 - static_cast<double>(CompactBits) / DefaultBits) : 0.0,
+        CompactSeconds * 1e6 / NumSamples,
+        NumMismatches);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FSavedMove_FPSGame
+
+FSavedMove_FPSGame::FSavedMove_FPSGame()
+{
+    bSavedWantsToSprint = false;
+}
+
+void FSavedMove_FPSGame::Clear()
+{
+    Super::Clear();
+
+    bSavedWantsToSprint = false;
+    SavedServerTime = 0;
+}
+
+uint8 FSavedMove_FPSGame::GetCompressedFlags() const
+{
+    uint8 Result = Super::GetCompressedFlags();
+    if (bSavedWantsToSprint)
+    {
+        Result |= UFPSGameMovementComponent::FLAG_WantsToSprint;
+    }
+    return Result;
+}
+
+bool FSavedMove_FPSGame::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+    // 冲刺状态变化的帧不能合并，否则服务器会晚一帧切换速度
+    if (bSavedWantsToSprint != static_cast<const FSavedMove_FPSGame*>(NewMove.Get())->bSavedWantsToSprint)
+    {
+        return false;
+    }
+
+    return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_FPSGame::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+    Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+    if (const UFPSGameMovementComponent* Movement = Cast<UFPSGameMovementComponent>(C->GetCharacterMovement()))
+    {
+        bSavedWantsToSprint = Movement->WantsToSprint();
+    }
+
+    const UTimeSyncComponent* TimeSync = UTimeSyncComponent::Get(C);
+    SavedServerTime = UTimeSyncComponent::CompressTime(TimeSync ? TimeSync->GetServerTime() : C->GetWorld()->GetTimeSeconds());
+}
+
+void FSavedMove_FPSGame::PrepMoveFor(ACharacter* C)
+{
+    Super::PrepMoveFor(C);
+
+    if (UFPSGameMovementComponent* Movement = Cast<UFPSGameMovementComponent>(C->GetCharacterMovement()))
+    {
+        Movement->SetWantsToSprint(bSavedWantsToSprint);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FNetworkPredictionData_Client_FPSGame
+
+FNetworkPredictionData_Client_FPSGame::FNetworkPredictionData_Client_FPSGame(const UCharacterMovementComponent& ClientMovement)
+    : Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_FPSGame::AllocateNewMove()
+{
+    return FSavedMovePtr(new FSavedMove_FPSGame());
+}
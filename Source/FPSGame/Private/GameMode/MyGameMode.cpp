@@ -1,659 +1,1139 @@
-#include "GameMode/MyGameMode.h"
-#include "Character/EnemyCharacter.h"
-#include "FPSGame/FPSGameCharacter.h"
-#include "Kismet/GameplayStatics.h"
-#include "PlayerState/MyPlayerState.h"
-#include "Engine/World.h"
-#include "GameFramework/PlayerStart.h"
-#include "EngineUtils.h"
-
-AMyGameMode::AMyGameMode()
-{
-    // 设置默认玩家状态类
-    PlayerStateClass = AMyPlayerState::StaticClass();
-
-    // 设置默认Pawn类
-    DefaultPawnClass = AFPSGameCharacter::StaticClass();
-
-    // 初始化游戏参数
-    MaxEnemies = 6;        // 场上最多存在敌人数量
-    CurrentEnemyCount = 0; // 当前敌人数量
-    SpawnInterval = 3.0f;  // 生成敌人时间间隔
-    GameDuration = 180.0f; // 游戏总时长
-    RemainingTime = GameDuration;
-    CurrentAlivePlayers = 0; // 初始存活玩家数
-
-    // 设置为可网络旅行
-    bUseSeamlessTravel = true;
-}
-
-void AMyGameMode::BeginPlay()
-{
-    Super::BeginPlay();
-
-    // 查找玩家重生点
-    FindPlayerStarts();
-
-    // 查找所有标记为"EnemySpawnPoint"的生成点
-    TArray<AActor*> FoundActors;
-    UGameplayStatics::GetAllActorsWithTag(GetWorld(), "EnemySpawnPoint", FoundActors);
-    SpawnPoints = FoundActors;
-
-    // 开始生成敌人
-    GetWorld()->GetTimerManager().SetTimer(SpawnEnemyTimerHandle, this, &AMyGameMode::SpawnEnemy, SpawnInterval, true);
-
-    // 开始游戏计时
-    GetWorld()->GetTimerManager().SetTimer(GameTimerHandle, this, &AMyGameMode::UpdateGameTime, 1.0f, true);
-
-    // 定期检查胜利者
-    GetWorld()->GetTimerManager().SetTimer(CheckWinnerTimerHandle, this, &AMyGameMode::CheckForWinner, 5.0f, true);
-
-    UE_LOG(LogTemp, Warning, TEXT("游戏开始！找到 %d 个玩家重生点"), PlayerStarts.Num());
-}
-
-void AMyGameMode::FindPlayerStarts()
-{
-    PlayerStarts.Empty();
-
-    for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
-    {
-        PlayerStarts.Add(*It);
-        UE_LOG(LogTemp, Log, TEXT("找到玩家重生点: %s 位置: %s"),
-            *It->GetName(), *It->GetActorLocation().ToString());
-    }
-}
-
-void AMyGameMode::PostLogin(APlayerController* NewPlayer)
-{
-    Super::PostLogin(NewPlayer);
-
-    UE_LOG(LogTemp, Warning, TEXT("=== 玩家登录 ==="));
-    UE_LOG(LogTemp, Warning, TEXT("新玩家控制器: %s"), *NewPlayer->GetName());
-    UE_LOG(LogTemp, Warning, TEXT("网络角色: %s"),
-        NewPlayer->GetLocalRole() == ROLE_Authority ? TEXT("Authority") : TEXT("Client"));
-
-    // 设置玩家名称
-    if (NewPlayer->PlayerState)
-    {
-        int32 PlayerId = NewPlayer->PlayerState->GetPlayerId();
-        FString PlayerName = FString::Printf(TEXT("Player%d"), PlayerId);
-        NewPlayer->PlayerState->SetPlayerName(PlayerName);
-        UE_LOG(LogTemp, Warning, TEXT("玩家ID: %d, 名称: %s"),
-            PlayerId, *PlayerName);
-    }
-
-    // 生成玩家角色
-    SpawnPlayerCharacter(NewPlayer);
-
-    // 更新存活玩家数量
-    CurrentAlivePlayers++;
-    UE_LOG(LogTemp, Warning, TEXT("当前存活玩家: %d"), CurrentAlivePlayers);
-}
-
-void AMyGameMode::Logout(AController* Exiting)
-{
-    UE_LOG(LogTemp, Warning, TEXT("玩家离开: %s"), *Exiting->GetName());
-
-    // 更新存活玩家数量
-    CurrentAlivePlayers = FMath::Max(0, CurrentAlivePlayers - 1);
-
-    Super::Logout(Exiting);
-}
-
-void AMyGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
-{
-    // 调用父类实现
-    Super::HandleStartingNewPlayer_Implementation(NewPlayer);
-
-    UE_LOG(LogTemp, Warning, TEXT("处理新玩家: %s"), *NewPlayer->GetName());
-
-    // 确保玩家有角色
-    if (!NewPlayer->GetPawn())
-    {
-        SpawnPlayerCharacter(NewPlayer);
-    }
-}
-
-// 自定义的玩家出生点选择函数
-AActor* AMyGameMode::ChoosePlayerStartForController(AController* Player)
-{
-    if (PlayerStarts.Num() == 0)
-    {
-        UE_LOG(LogTemp, Error, TEXT("没有找到玩家重生点！"));
-        return nullptr;
-    }
-
-    // 简单轮询选择重生点
-    static int32 CurrentStartIndex = 0;
-    APlayerStart* ChosenStart = PlayerStarts[CurrentStartIndex % PlayerStarts.Num()];
-    CurrentStartIndex++;
-
-    UE_LOG(LogTemp, Log, TEXT("为玩家 %s 选择重生点: %s"),
-        Player ? *Player->GetName() : TEXT("未知"),
-        *ChosenStart->GetName());
-
-    return ChosenStart;
-}
-
-void AMyGameMode::SpawnPlayerCharacter(APlayerController* PlayerController)
-{
-    if (!PlayerController || bGameEnded) return;
-
-    UE_LOG(LogTemp, Warning, TEXT("=== 生成玩家角色 ==="));
-    UE_LOG(LogTemp, Warning, TEXT("为控制器 %s 生成角色"), *PlayerController->GetName());
-
-    // 如果已有Pawn，先销毁
-    if (APawn* ExistingPawn = PlayerController->GetPawn())
-    {
-        UE_LOG(LogTemp, Warning, TEXT("销毁现有Pawn: %s"), *ExistingPawn->GetName());
-        ExistingPawn->Destroy();
-    }
-
-    // 选择重生点（使用我们自定义的函数）
-    AActor* StartSpot = ChoosePlayerStartForController(PlayerController);
-    if (!StartSpot)
-    {
-        UE_LOG(LogTemp, Error, TEXT("无法找到重生点！"));
-        StartSpot = GetWorld()->GetFirstPlayerController(); // 备用方案
-    }
-
-    // 确定要生成的Pawn类
-    UClass* PawnClassToSpawn = DefaultPawnClass;
-    if (PlayerClass && PlayerClass->IsChildOf(AFPSGameCharacter::StaticClass()))
-    {
-        PawnClassToSpawn = PlayerClass;
-    }
-
-    // 生成新角色
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.Owner = PlayerController;
-    SpawnParams.Instigator = nullptr;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-
-    FVector SpawnLocation = StartSpot ? StartSpot->GetActorLocation() : FVector::ZeroVector;
-    FRotator SpawnRotation = StartSpot ? StartSpot->GetActorRotation() : FRotator::ZeroRotator;
-
-    UE_LOG(LogTemp, Warning, TEXT("生成位置: %s"), *SpawnLocation.ToString());
-
-    AFPSGameCharacter* NewCharacter = GetWorld()->SpawnActor<AFPSGameCharacter>(
-        PawnClassToSpawn,
-        SpawnLocation,
-        SpawnRotation,
-        SpawnParams
-    );
-
-    if (NewCharacter)
-    {
-        // 赋予控制权
-        PlayerController->Possess(NewCharacter);
-
-        UE_LOG(LogTemp, Warning, TEXT("成功生成角色: %s (地址: %p)"),
-            *NewCharacter->GetName(), NewCharacter);
-        UE_LOG(LogTemp, Warning, TEXT("角色网络角色: %s"),
-            *UEnum::GetValueAsString(NewCharacter->GetLocalRole()));
-        UE_LOG(LogTemp, Warning, TEXT("初始血量: %.0f/%.0f"),
-            NewCharacter->GetCurrentHealth(), NewCharacter->GetMaxHealth());
-    }
-    else
-    {
-        UE_LOG(LogTemp, Error, TEXT("生成角色失败！"));
-    }
-}
-
-
-//生成敌人
-void AMyGameMode::SpawnEnemy()
-{
-    // 游戏已结束则不生成敌人
-    if (bGameEnded) return;
-
-    if (CurrentEnemyCount >= MaxEnemies || !EnemyClass || SpawnPoints.Num() == 0)
-        return;
-
-    // 随机选择一个生成点
-    int32 RandomIndex = FMath::RandRange(0, SpawnPoints.Num() - 1);
-    AActor* SpawnPoint = SpawnPoints[RandomIndex];
-
-    if (SpawnPoint)
-    {
-        // 生成随机旋转（0-360度）
-        FRotator RandomRotation(0, FMath::RandRange(0.0f, 360.0f), 0);
-
-        // 生成敌人
-        AEnemyCharacter* Enemy = GetWorld()->SpawnActor<AEnemyCharacter>(EnemyClass, SpawnPoint->GetActorLocation(), RandomRotation);
-        if (Enemy)
-        {
-            CurrentEnemyCount++;
-            UE_LOG(LogTemp, Log, TEXT("生成敌人，当前数量: %d"), CurrentEnemyCount);
-        }
-    }
-}
-
-void AMyGameMode::OnEnemyDeath(AEnemyCharacter* DeadEnemy)
-{
-    if (!DeadEnemy || bGameEnded)
-        return;
-
-    UE_LOG(LogTemp, Warning, TEXT("=== MyGameMode::OnEnemyDeath 被调用 ==="));
-    UE_LOG(LogTemp, Warning, TEXT("死亡敌人: %s"), *DeadEnemy->GetName());
-
-    // 获取击杀者控制器
-    AController* KillerController = DeadEnemy->GetEnemyKiller();
-
-    if (KillerController)
-    {
-        UE_LOG(LogTemp, Warning, TEXT("击杀者: %s"), *KillerController->GetName());
-
-        // 尝试转换为玩家控制器
-        APlayerController* PlayerController = Cast<APlayerController>(KillerController);
-        if (PlayerController)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("击杀者是玩家控制器"));
-
-            // 获取击杀者的玩家状态
-            AMyPlayerState* KillerPlayerState = KillerController->GetPlayerState<AMyPlayerState>();
-            if (KillerPlayerState)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("找到玩家状态: %s, 当前得分: %f"),
-                    *KillerPlayerState->GetPlayerName(), KillerPlayerState->GetScore());
-
-                // 调用 RPC 给击杀者加5分
-                KillerPlayerState->AddPlayerScore(5);
-
-                UE_LOG(LogTemp, Warning, TEXT("玩家 %s 击杀敌人，获得5分"),
-                    *KillerPlayerState->GetPlayerName());
-            }
-            else
-            {
-                UE_LOG(LogTemp, Error, TEXT("无法获取击杀者的玩家状态！"));
-            }
-        }
-        else
-        {
-            // 可能是AI控制器
-            UE_LOG(LogTemp, Warning, TEXT("击杀者不是玩家控制器，是: %s"),
-                *KillerController->GetClass()->GetName());
-        }
-    }
-    else
-    {
-        UE_LOG(LogTemp, Error, TEXT("没有找到击杀者！"));
-
-        // 尝试获取第一个玩家作为测试
-        APlayerController* TestPC = GetWorld()->GetFirstPlayerController();
-        if (TestPC)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("作为测试，给第一个玩家 %s 加分"),
-                *TestPC->GetName());
-
-            AMyPlayerState* TestPS = TestPC->GetPlayerState<AMyPlayerState>();
-            if (TestPS)
-            {
-                TestPS->AddPlayerScore(5);
-            }
-        }
-    }
-
-    // 减少敌人计数
-    CurrentEnemyCount = FMath::Max(0, CurrentEnemyCount - 1);
-    UE_LOG(LogTemp, Log, TEXT("敌人死亡，当前存活敌人数量: %d/%d"), CurrentEnemyCount, MaxEnemies);
-}
-
-void AMyGameMode::OnPlayerDeath(AFPSGameCharacter* DeadPlayer)
-{
-    if (!DeadPlayer || bGameEnded) return;
-
-    CurrentAlivePlayers--;
-    UE_LOG(LogTemp, Warning, TEXT("玩家 %s 死亡！当前存活玩家: %d"), *DeadPlayer->GetName(), CurrentAlivePlayers);
-
-    // 立即检查游戏是否结束
-    CheckForWinner();
-}
-
-void AMyGameMode::CheckForWinner()
-{
-    // 游戏已结束则不检查
-    if (bGameEnded) return;
-
-    TArray<AFPSGameCharacter*> AlivePlayers = GetAlivePlayers();
-
-    // 条件1：时间耗尽
-    if (RemainingTime <= 0)
-    {
-        EndGame(FString::Printf(TEXT("时间到！")));
-        return;
-    }
-
-    // 条件2：只有1个玩家存活
-    if (AlivePlayers.Num() == 1)
-    {
-        AFPSGameCharacter* WinnerPlayer = AlivePlayers[0];
-        if (WinnerPlayer)
-        {
-            AMyPlayerState* WinnerPS = WinnerPlayer->GetPlayerState<AMyPlayerState>();
-            if (WinnerPS)
-            {
-                EndGame(FString::Printf(TEXT("玩家 %s 胜利！"), *WinnerPS->GetPlayerName()));
-            }
-        }
-        return;
-    }
-
-    // 条件3：没有玩家存活
-    if (AlivePlayers.Num() == 0)
-    {
-        EndGame(FString::Printf(TEXT("所有玩家死亡！")));
-        return;
-    }
-}
-//得分统计
-void AMyGameMode::PrintScoreboard()
-{
-    UE_LOG(LogTemp, Warning, TEXT("========== 得分榜 =========="));
-
-    // 遍历所有玩家控制器
-    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-    {
-        APlayerController* PC = It->Get();
-        if (PC)
-        {
-            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
-            if (PS)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("玩家: %s - 得分: %f"),
-                    *PS->GetPlayerName(),
-                    PS->GetScore());
-            }
-        }
-    }
-
-    UE_LOG(LogTemp, Warning, TEXT("============================"));
-}
-
-//测试给指定玩家加分
-void AMyGameMode::AddScoreToPlayer(int32 PlayerIndex, int32 Score)
-{
-    int32 Count = 0;
-    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-    {
-        APlayerController* PC = It->Get();
-        if (PC && Count == PlayerIndex)
-        {
-            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
-            if (PS)
-            {
-                PS->AddPlayerScore(Score);
-                UE_LOG(LogTemp, Warning, TEXT("给玩家 %s 添加 %d 分，当前得分: %f"),
-                    *PS->GetPlayerName(), Score, PS->GetScore());
-                return;
-            }
-        }
-        Count++;
-    }
-
-    UE_LOG(LogTemp, Warning, TEXT("未找到玩家索引: %d"), PlayerIndex);
-}
-
-// 游戏结束时添加一个调试命令
-void AMyGameMode::DebugScore()
-{
-    PrintScoreboard();
-}
-
-void AMyGameMode::UpdateGameTime()
-{
-    if (bGameEnded) return;
-
-    RemainingTime = FMath::Max(0.0f, RemainingTime - 1.0f);
-
-    // 每秒显示剩余秒数
-    int32 Minutes = FMath::FloorToInt(RemainingTime / 60.0f);
-    int32 Seconds = FMath::FloorToInt(FMath::Fmod(RemainingTime, 60.0f));
-
-    // 如果还有分钟数，显示MM:SS格式
-    if (Minutes > 0)
-    {
-        UE_LOG(LogTemp, Log, TEXT("剩余时间: %02d:%02d"), Minutes, Seconds);
-    }
-    else
-    {
-        // 只剩秒数时，只显示秒
-        UE_LOG(LogTemp, Log, TEXT("剩余时间: %d秒"), Seconds);
-    }
-
-    if (RemainingTime <= 0)
-    {
-        EndGame(FString::Printf(TEXT("时间到！")));
-    }
-}
-
-void AMyGameMode::TestScore()
-{
-    UE_LOG(LogTemp, Warning, TEXT("=== 测试加分功能 ==="));
-
-    // 遍历所有玩家控制器
-    int32 PlayerCount = 0;
-    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-    {
-        APlayerController* PC = It->Get();
-        if (PC)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("玩家控制器 %d: %s"), PlayerCount, *PC->GetName());
-
-            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
-            if (PS)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("  玩家状态: %s, 当前得分: %f"),
-                    *PS->GetPlayerName(), PS->GetScore());
-
-                // 测试加分
-                PS->AddPlayerScore(10);
-                UE_LOG(LogTemp, Warning, TEXT("  测试加分10分，新得分: %f"), PS->GetScore());
-            }
-            else
-            {
-                UE_LOG(LogTemp, Error, TEXT("  没有找到玩家状态！"));
-            }
-            PlayerCount++;
-        }
-    }
-}
-
-void AMyGameMode::AddTestScoreToAll()
-{
-    UE_LOG(LogTemp, Warning, TEXT("=== 给所有玩家加测试分 ==="));
-
-    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-    {
-        APlayerController* PC = It->Get();
-        if (PC)
-        {
-            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
-            if (PS)
-            {
-                PS->AddPlayerScore(5);
-                UE_LOG(LogTemp, Warning, TEXT("玩家 %s 获得5分，当前得分: %f"),
-                    *PS->GetPlayerName(), PS->GetScore());
-            }
-        }
-    }
-}
-
-void AMyGameMode::TestKill()
-{
-    UE_LOG(LogTemp, Warning, TEXT("=== 模拟击杀测试 ==="));
-
-    // 找到第一个玩家控制器
-    APlayerController* FirstPC = nullptr;
-    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-    {
-        FirstPC = It->Get();
-        if (FirstPC) break;
-    }
-
-    if (FirstPC)
-    {
-        // 调用 OnEnemyDeath 函数，传入一个虚拟的击杀者
-        UE_LOG(LogTemp, Warning, TEXT("模拟玩家 %s 击杀敌人"), *FirstPC->GetName());
-
-        // 创建一个临时的敌人指针（实际不创建敌人，只是测试逻辑）
-        AEnemyCharacter* DummyEnemy = nullptr;
-
-        // 直接调用加分逻辑
-        AMyPlayerState* PS = FirstPC->GetPlayerState<AMyPlayerState>();
-        if (PS)
-        {
-            PS->AddPlayerScore(5);
-            UE_LOG(LogTemp, Warning, TEXT("模拟击杀成功，玩家 %s 获得5分"), *PS->GetPlayerName());
-        }
-    }
-}
-
-void AMyGameMode::EndGame(const FString& EndReason)
-{
-    if (bGameEnded) return;
-
-    bGameEnded = true;
-
-    // 停止所有定时器
-    GetWorld()->GetTimerManager().ClearTimer(SpawnEnemyTimerHandle);
-    GetWorld()->GetTimerManager().ClearTimer(GameTimerHandle);
-
-    // 获取存活玩家
-    TArray<AFPSGameCharacter*> AlivePlayers = GetAlivePlayers();
-
-    if (AlivePlayers.Num() == 1)
-    {
-        // 有胜利者
-        AFPSGameCharacter* Winner = AlivePlayers[0];
-        if (Winner)
-        {
-            AMyPlayerState* WinnerPS = Winner->GetPlayerState<AMyPlayerState>();
-            if (WinnerPS)
-            {
-                WinnerPS->SetIsWinner(true);
-                UE_LOG(LogTemp, Warning, TEXT("[游戏结束] %s 胜利者: %s (得分: %f)"),
-                    *EndReason, *WinnerPS->GetPlayerName(), WinnerPS->GetScore());
-            }
-        }
-    }
-    else if (AlivePlayers.Num() > 1)
-    {
-        // 多个玩家存活，比较得分
-        AMyPlayerState* Winner = nullptr;
-        float HighestScore = -1.0f;
-
-        for (AFPSGameCharacter* Player : AlivePlayers)
-        {
-            if (Player)
-            {
-                AMyPlayerState* PS = Player->GetPlayerState<AMyPlayerState>();
-                if (PS && PS->GetScore() > HighestScore)
-                {
-                    HighestScore = PS->GetScore();
-                    Winner = PS;
-                }
-            }
-        }
-
-        if (Winner)
-        {
-            Winner->SetIsWinner(true);
-            UE_LOG(LogTemp, Warning, TEXT("[游戏结束] %s 胜利者: %s (最高得分: %f)"),
-                *EndReason, *Winner->GetPlayerName(), Winner->GetScore());
-        }
-    }
-    else
-    {
-        // 没有存活玩家
-        UE_LOG(LogTemp, Warning, TEXT("[游戏结束] %s 没有胜利者"), *EndReason);
-    }
-
-    // 这里可以添加游戏结束的UI显示、数据统计等逻辑
-    UE_LOG(LogTemp, Warning, TEXT("游戏结束！原因：%s"), *EndReason);
-}
-
-void AMyGameMode::DebugPlayers()
-{
-    UE_LOG(LogTemp, Warning, TEXT("======= 玩家调试信息 ======="));
-
-    // 通过PlayerController遍历
-    int32 PlayerIndex = 0;
-    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-    {
-        APlayerController* PC = It->Get();
-        if (PC)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("玩家%d:"), PlayerIndex++);
-            UE_LOG(LogTemp, Warning, TEXT("  控制器: %s"), *PC->GetName());
-            UE_LOG(LogTemp, Warning, TEXT("  网络角色: %s"),
-                *UEnum::GetValueAsString(PC->GetLocalRole()));
-
-            if (PC->PlayerState)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("  玩家名称: %s"), *PC->PlayerState->GetPlayerName());
-            }
-
-            AFPSGameCharacter* Character = Cast<AFPSGameCharacter>(PC->GetPawn());
-            if (Character)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("  角色: %s (地址: %p)"),
-                    *Character->GetName(), Character);
-                UE_LOG(LogTemp, Warning, TEXT("  角色网络角色: %s"),
-                    *UEnum::GetValueAsString(Character->GetLocalRole()));
-                UE_LOG(LogTemp, Warning, TEXT("  血量: %.0f/%.0f"),
-                    Character->GetCurrentHealth(), Character->GetMaxHealth());
-            }
-            else
-            {
-                UE_LOG(LogTemp, Warning, TEXT("  角色: 无"));
-            }
-        }
-    }
-
-    // 查找所有FPSGameCharacter实例
-    TArray<AActor*> AllCharacters;
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFPSGameCharacter::StaticClass(), AllCharacters);
-
-    UE_LOG(LogTemp, Warning, TEXT("所有FPSGameCharacter实例 (%d 个):"), AllCharacters.Num());
-    for (AActor* Actor : AllCharacters)
-    {
-        AFPSGameCharacter* Character = Cast<AFPSGameCharacter>(Actor);
-        if (Character)
-        {
-            APlayerController* OwnerPC = Cast<APlayerController>(Character->GetController());
-            FString OwnerName = OwnerPC ? OwnerPC->GetName() : TEXT("无控制器");
-
-            UE_LOG(LogTemp, Warning, TEXT("  - %s (地址: %p)"),
-                *Character->GetName(), Character);
-            UE_LOG(LogTemp, Warning, TEXT("    控制器: %s"), *OwnerName);
-            UE_LOG(LogTemp, Warning, TEXT("    网络角色: %s"),
-                *UEnum::GetValueAsString(Character->GetLocalRole()));
-            UE_LOG(LogTemp, Warning, TEXT("    血量: %.0f/%.0f"),
-                Character->GetCurrentHealth(), Character->GetMaxHealth());
-        }
-    }
-
-    UE_LOG(LogTemp, Warning, TEXT("当前存活玩家数: %d"), CurrentAlivePlayers);
-    UE_LOG(LogTemp, Warning, TEXT("游戏是否结束: %s"), bGameEnded ? TEXT("是") : TEXT("否"));
-    UE_LOG(LogTemp, Warning, TEXT("================================="));
-}
-
-TArray<AFPSGameCharacter*> AMyGameMode::GetAlivePlayers()
-{
-    TArray<AFPSGameCharacter*> AlivePlayers;
-    TArray<AActor*> AllPlayers;
-
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFPSGameCharacter::StaticClass(), AllPlayers);
-
-    for (AActor* Actor : AllPlayers)
-    {
-        AFPSGameCharacter* Player = Cast<AFPSGameCharacter>(Actor);
-        if (Player && Player->GetCurrentHealth() > 0.0f)
-        {
-            AlivePlayers.Add(Player);
-        }
-    }
-
-    return AlivePlayers;
+#include "GameMode/MyGameMode.h"
+#include "Character/EnemyCharacter.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "Kismet/GameplayStatics.h"
+#include "PlayerState/MyPlayerState.h"
+#include "GameState/MyGameState.h"
+#include "Match/MatchFlowSubsystem.h"
+#include "GameMode/SpawnPointSubsystem.h"
+#include "AI/EnemyFlowFieldSubsystem.h"
+#include "AI/EnemyTargetSubsystem.h"
+#include "Math/ProximityKernels.h"
+#include "Character/FPSGameMovementComponent.h"
+#include "Net/ReplicationBenchSubsystem.h"
+#include "Net/NetOcclusionSubsystem.h"
+#include "Net/FPSIpNetDriver.h"
+#include "Net/TimeSyncComponent.h"
+#include "Mass/EnemyMassSubsystem.h"
+#include "AI/EnemyAIController.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/PlayerStart.h"
+#include "EngineUtils.h"
+#include "FPSGame/FPSGameProjectile.h"
+
+AMyGameMode::AMyGameMode()
+{
+    // 设置默认玩家状态类
+    PlayerStateClass = AMyPlayerState::StaticClass();
+
+    // 对局时钟放在GameState上复制给客户端
+    GameStateClass = AMyGameState::StaticClass();
+
+    // 设置默认Pawn类
+    DefaultPawnClass = AFPSGameCharacter::StaticClass();
+
+    // 初始化游戏参数
+    MaxEnemies = 6;        // 场上最多存在敌人数量
+    CurrentEnemyCount = 0; // 当前敌人数量
+    SpawnInterval = 3.0f;  // 生成敌人时间间隔
+    SpawnScoreRefreshInterval = 0.5f; // 出生点评分刷新间隔
+    MaxBackgroundEnemies = 0;  // 默认不使用后台敌人
+    GameDuration = 180.0f; // 游戏总时长
+    CurrentAlivePlayers = 0; // 初始存活玩家数
+    NextMapName = TEXT("/Game/FirstPerson/Maps/FirstPersonMap"); // 下一局地图
+    ScoreboardDuration = 10.0f; // 结算阶段时长
+    RoundsPerMap = 0;           // 0表示一直原地重开
+    MaxRoundHistory = 50;       // 历史记录上限
+    CurrentRound = 1;
+    RoundStartTime = 0.0f;
+    EnemiesKilledThisRound = 0;
+
+    // 设置为可网络旅行
+    bUseSeamlessTravel = true;
+}
+
+void AMyGameMode::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // 查找玩家重生点和敌人生成点（主机玩家登录时可能已经注册过）
+    if (PlayerStarts.Num() == 0)
+    {
+        RegisterSpawnPoints();
+    }
+
+    StartRoundTimers();
+
+    UE_LOG(LogTemp, Warning, TEXT("游戏开始！找到 %d 个玩家重生点"), PlayerStarts.Num());
+}
+
+void AMyGameMode::StartRoundTimers()
+{
+    RoundStartTime = GetWorld()->GetTimeSeconds();
+
+    // 开始生成敌人
+    GetWorld()->GetTimerManager().SetTimer(SpawnEnemyTimerHandle, this, &AMyGameMode::SpawnEnemy, SpawnInterval, true);
+
+    // 开始游戏计时：开始/结束时间只复制一次，服务器只在结束时触发一次
+    if (AMyGameState* MatchState = GetGameState<AMyGameState>())
+    {
+        MatchState->StartMatchClock(RoundStartTime, GameDuration);
+    }
+    GetWorld()->GetTimerManager().SetTimer(MatchEndTimerHandle, this, &AMyGameMode::OnMatchTimeUp, GameDuration, false);
+
+    // 定期检查胜利者
+    GetWorld()->GetTimerManager().SetTimer(CheckWinnerTimerHandle, this, &AMyGameMode::CheckForWinner, 5.0f, true);
+
+    // 定期刷新出生点评分
+    RefreshSpawnScores();
+    GetWorld()->GetTimerManager().SetTimer(SpawnScoreTimerHandle, this, &AMyGameMode::RefreshSpawnScores, SpawnScoreRefreshInterval, true);
+
+    // 定期把远处空闲的敌人降级为后台敌人
+    if (MaxBackgroundEnemies > 0)
+    {
+        GetWorld()->GetTimerManager().SetTimer(DemoteEnemiesTimerHandle, this, &AMyGameMode::DemoteDistantEnemies, 1.0f, true);
+    }
+}
+
+void AMyGameMode::RegisterSpawnPoints()
+{
+    FindPlayerStarts();
+
+    // 查找所有标记为"EnemySpawnPoint"的生成点
+    TArray<AActor*> FoundActors;
+    UGameplayStatics::GetAllActorsWithTag(GetWorld(), "EnemySpawnPoint", FoundActors);
+    SpawnPoints = FoundActors;
+
+    // 出生点服务按World缓存，多个对局/切图之间互不影响
+    if (USpawnPointSubsystem* SpawnService = GetWorld()->GetSubsystem<USpawnPointSubsystem>())
+    {
+        SpawnService->RegisterSpawnPoints(ESpawnPointType::Player, TArray<AActor*>(PlayerStarts));
+        SpawnService->RegisterSpawnPoints(ESpawnPointType::Enemy, SpawnPoints);
+    }
+}
+
+void AMyGameMode::RefreshSpawnScores()
+{
+    USpawnPointSubsystem* SpawnService = GetWorld()->GetSubsystem<USpawnPointSubsystem>();
+    if (!SpawnService)
+    {
+        return;
+    }
+
+    TArray<FVector> PlayerLocations;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PC = It->Get();
+        if (PC && PC->GetPawn())
+        {
+            PlayerLocations.Add(PC->GetPawn()->GetActorLocation());
+        }
+    }
+
+    TArray<FVector> EnemyLocations;
+    EnemyLocations.Reserve(ActiveEnemies.Num());
+    for (const AEnemyCharacter* Enemy : ActiveEnemies)
+    {
+        if (IsValid(Enemy))
+        {
+            EnemyLocations.Add(Enemy->GetActorLocation());
+        }
+    }
+
+    SpawnService->RefreshScores(PlayerLocations, EnemyLocations);
+}
+
+void AMyGameMode::RestartRound()
+{
+    UWorld* World = GetWorld();
+    FTimerManager& TimerManager = World->GetTimerManager();
+    TimerManager.ClearTimer(RoundRestartTimerHandle);
+    TimerManager.ClearTimer(MatchTransitionTimerHandle);
+    TimerManager.ClearTimer(SpawnEnemyTimerHandle);
+    TimerManager.ClearTimer(MatchEndTimerHandle);
+    TimerManager.ClearTimer(CheckWinnerTimerHandle);
+    TimerManager.ClearTimer(SpawnScoreTimerHandle);
+    TimerManager.ClearTimer(DemoteEnemiesTimerHandle);
+
+    // 后台敌人直接清空
+    if (UEnemyMassSubsystem* MassSubsystem = World->GetSubsystem<UEnemyMassSubsystem>())
+    {
+        MassSubsystem->DestroyAllBackgroundEnemies();
+    }
+
+    // 场上的敌人全部回收到对象池
+    for (int32 Index = ActiveEnemies.Num() - 1; Index >= 0; --Index)
+    {
+        ReleaseEnemy(ActiveEnemies[Index]);
+    }
+    ActiveEnemies.Reset();
+
+    // 清除飞行中的投射物
+    for (TActorIterator<AFPSGameProjectile> It(World); It; ++It)
+    {
+        It->Destroy();
+    }
+
+    // 敌人已回收，重新评分后再给玩家选重生点
+    RefreshSpawnScores();
+
+    // 重置玩家：复活并传送回重生点，本局分数清零
+    bGameEnded = false;
+    CurrentAlivePlayers = 0;
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PC = It->Get();
+        if (!PC)
+        {
+            continue;
+        }
+
+        if (AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>())
+        {
+            PS->ResetForNewRound();
+        }
+
+        AFPSGameCharacter* Character = Cast<AFPSGameCharacter>(PC->GetPawn());
+        AActor* StartSpot = Character ? ChoosePlayerStartForController(PC) : nullptr;
+        if (StartSpot)
+        {
+            Character->ReviveForNewRound(StartSpot->GetActorLocation(), StartSpot->GetActorRotation());
+            if (USpawnPointSubsystem* SpawnService = World->GetSubsystem<USpawnPointSubsystem>())
+            {
+                SpawnService->OccupySpawnPoint(ESpawnPointType::Player, StartSpot, Character);
+            }
+        }
+        else
+        {
+            // 没有角色时重新生成
+            SpawnPlayerCharacter(PC);
+        }
+
+        CurrentAlivePlayers++;
+    }
+
+    // 重置本局状态
+    CurrentEnemyCount = 0;
+    EnemiesKilledThisRound = 0;
+    CurrentRound++;
+
+    StartRoundTimers();
+
+    UE_LOG(LogTemp, Warning, TEXT("第 %d 局开始！存活玩家: %d，对象池敌人: %d"),
+        CurrentRound, CurrentAlivePlayers, PooledEnemies.Num());
+}
+
+void AMyGameMode::RecordRound(const FString& EndReason, AMyPlayerState* Winner)
+{
+    FRoundRecord Record;
+    Record.RoundNumber = CurrentRound;
+    Record.Duration = GetWorld()->GetTimeSeconds() - RoundStartTime;
+    Record.EndReason = EndReason;
+    Record.EnemiesKilled = EnemiesKilledThisRound;
+    if (Winner)
+    {
+        Record.WinnerName = Winner->GetPlayerName();
+        Record.WinnerScore = Winner->GetPlayerScore();
+    }
+
+    // 只保留最近的记录，长时间运行内存不增长
+    if (MaxRoundHistory > 0 && RoundHistory.Num() >= MaxRoundHistory)
+    {
+        RoundHistory.RemoveAt(0, RoundHistory.Num() - MaxRoundHistory + 1);
+    }
+    RoundHistory.Add(MoveTemp(Record));
+}
+
+void AMyGameMode::DebugRoundHistory()
+{
+    UE_LOG(LogTemp, Warning, TEXT("======= 历史对局 (%d 局) ======="), RoundHistory.Num());
+    for (const FRoundRecord& Record : RoundHistory)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("第%d局 时长: %.0f秒 原因: %s 胜利者: %s (%.0f分) 击杀敌人: %d"),
+            Record.RoundNumber, Record.Duration, *Record.EndReason,
+            Record.WinnerName.IsEmpty() ? TEXT("无") : *Record.WinnerName,
+            Record.WinnerScore, Record.EnemiesKilled);
+    }
+}
+
+void AMyGameMode::DebugFlowField()
+{
+    if (const UEnemyFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UEnemyFlowFieldSubsystem>())
+    {
+        FlowField->DumpStats();
+    }
+}
+
+void AMyGameMode::DebugEnemyBrain()
+{
+    if (const UEnemyTargetSubsystem* TargetSubsystem = GetWorld()->GetSubsystem<UEnemyTargetSubsystem>())
+    {
+        TargetSubsystem->DumpStats();
+    }
+}
+
+void AMyGameMode::BenchProximity(int32 Iterations)
+{
+    FProximityKernels::RunBenchmark(Iterations);
+}
+
+void AMyGameMode::BenchMoveBandwidth()
+{
+    UFPSGameMovementComponent::RunBandwidthBenchmark(32);
+    UFPSGameMovementComponent::RunBandwidthBenchmark(64);
+}
+
+void AMyGameMode::BenchReplication(float Seconds)
+{
+    if (UReplicationBenchSubsystem* Bench = GetWorld()->GetSubsystem<UReplicationBenchSubsystem>())
+    {
+        Bench->StartBench(Seconds);
+    }
+}
+
+void AMyGameMode::DebugNetOcclusion()
+{
+    if (UNetOcclusionSubsystem* OcclusionSubsystem = GetWorld()->GetSubsystem<UNetOcclusionSubsystem>())
+    {
+        OcclusionSubsystem->DumpStats();
+    }
+}
+
+void AMyGameMode::DebugNetAccounting()
+{
+    if (const UFPSIpNetDriver* NetDriver = Cast<UFPSIpNetDriver>(GetWorld()->GetNetDriver()))
+    {
+        NetDriver->DumpAccounting();
+    }
+}
+
+void AMyGameMode::DebugTimeSync()
+{
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (const UTimeSyncComponent* TimeSync = UTimeSyncComponent::Get(It->Get()))
+        {
+            TimeSync->DumpStats();
+        }
+    }
+}
+
+void AMyGameMode::FindPlayerStarts()
+{
+    PlayerStarts.Empty();
+
+    for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+    {
+        PlayerStarts.Add(*It);
+        UE_LOG(LogTemp, Log, TEXT("找到玩家重生点: %s 位置: %s"),
+            *It->GetName(), *It->GetActorLocation().ToString());
+    }
+}
+
+void AMyGameMode::PostLogin(APlayerController* NewPlayer)
+{
+    Super::PostLogin(NewPlayer);
+
+    UE_LOG(LogTemp, Warning, TEXT("=== 玩家登录 ==="));
+    UE_LOG(LogTemp, Warning, TEXT("新玩家控制器: %s"), *NewPlayer->GetName());
+    UE_LOG(LogTemp, Warning, TEXT("网络角色: %s"),
+        NewPlayer->GetLocalRole() == ROLE_Authority ? TEXT("Authority") : TEXT("Client"));
+
+    // 设置玩家名称
+    if (NewPlayer->PlayerState)
+    {
+        int32 PlayerId = NewPlayer->PlayerState->GetPlayerId();
+        FString PlayerName = FString::Printf(TEXT("Player%d"), PlayerId);
+        NewPlayer->PlayerState->SetPlayerName(PlayerName);
+        UE_LOG(LogTemp, Warning, TEXT("玩家ID: %d, 名称: %s"),
+            PlayerId, *PlayerName);
+    }
+
+    // 生成玩家角色
+    SpawnPlayerCharacter(NewPlayer);
+
+    // 更新存活玩家数量
+    CurrentAlivePlayers++;
+    UE_LOG(LogTemp, Warning, TEXT("当前存活玩家: %d"), CurrentAlivePlayers);
+}
+
+void AMyGameMode::Logout(AController* Exiting)
+{
+    UE_LOG(LogTemp, Warning, TEXT("玩家离开: %s"), *Exiting->GetName());
+
+    // 更新存活玩家数量
+    CurrentAlivePlayers = FMath::Max(0, CurrentAlivePlayers - 1);
+
+    Super::Logout(Exiting);
+}
+
+void AMyGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+    // 调用父类实现
+    Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+
+    UE_LOG(LogTemp, Warning, TEXT("处理新玩家: %s"), *NewPlayer->GetName());
+
+    // 确保玩家有角色
+    if (!NewPlayer->GetPawn())
+    {
+        SpawnPlayerCharacter(NewPlayer);
+    }
+}
+
+void AMyGameMode::HandleSeamlessTravelPlayer(AController*& C)
+{
+    // 无缝旅行过来的玩家不会走PostLogin，这里补上存活人数
+    Super::HandleSeamlessTravelPlayer(C);
+
+    if (Cast<APlayerController>(C))
+    {
+        CurrentAlivePlayers++;
+        UE_LOG(LogTemp, Warning, TEXT("无缝旅行玩家: %s，当前存活玩家: %d"), *C->GetName(), CurrentAlivePlayers);
+    }
+}
+
+// 自定义的玩家出生点选择函数
+AActor* AMyGameMode::ChoosePlayerStartForController(AController* Player, bool* bOutCollisionFree)
+{
+    if (bOutCollisionFree)
+    {
+        *bOutCollisionFree = false;
+    }
+
+    // 主机玩家登录早于BeginPlay，此时还没有注册出生点
+    if (PlayerStarts.Num() == 0)
+    {
+        RegisterSpawnPoints();
+    }
+
+    if (PlayerStarts.Num() == 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("没有找到玩家重生点！"));
+        return nullptr;
+    }
+
+    USpawnPointSubsystem* SpawnService = GetWorld()->GetSubsystem<USpawnPointSubsystem>();
+    if (!SpawnService)
+    {
+        return nullptr;
+    }
+
+    // 选择离敌人和其他玩家最远的空闲重生点
+    bool bCollisionFree = false;
+    AActor* ChosenStart = SpawnService->AcquireSpawnPoint(ESpawnPointType::Player, bCollisionFree);
+    if (bOutCollisionFree)
+    {
+        *bOutCollisionFree = bCollisionFree;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("为玩家 %s 选择重生点: %s (空闲: %s)"),
+        Player ? *Player->GetName() : TEXT("未知"),
+        ChosenStart ? *ChosenStart->GetName() : TEXT("无"),
+        bCollisionFree ? TEXT("是") : TEXT("否"));
+
+    return ChosenStart;
+}
+
+void AMyGameMode::SpawnPlayerCharacter(APlayerController* PlayerController)
+{
+    if (!PlayerController || bGameEnded) return;
+
+    UE_LOG(LogTemp, Warning, TEXT("=== 生成玩家角色 ==="));
+    UE_LOG(LogTemp, Warning, TEXT("为控制器 %s 生成角色"), *PlayerController->GetName());
+
+    // 如果已有Pawn，先销毁
+    if (APawn* ExistingPawn = PlayerController->GetPawn())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("销毁现有Pawn: %s"), *ExistingPawn->GetName());
+        ExistingPawn->Destroy();
+    }
+
+    // 选择重生点（使用我们自定义的函数）
+    bool bCollisionFree = false;
+    AActor* StartSpot = ChoosePlayerStartForController(PlayerController, &bCollisionFree);
+    if (!StartSpot)
+    {
+        UE_LOG(LogTemp, Error, TEXT("无法找到重生点！"));
+        StartSpot = GetWorld()->GetFirstPlayerController(); // 备用方案
+    }
+
+    // 确定要生成的Pawn类
+    UClass* PawnClassToSpawn = DefaultPawnClass;
+    if (PlayerClass && PlayerClass->IsChildOf(AFPSGameCharacter::StaticClass()))
+    {
+        PawnClassToSpawn = PlayerClass;
+    }
+
+    // 生成新角色
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = PlayerController;
+    SpawnParams.Instigator = nullptr;
+    // 空闲出生点不需要碰撞调整；所有出生点都被占用时才退回推挤
+    SpawnParams.SpawnCollisionHandlingOverride = bCollisionFree
+        ? ESpawnActorCollisionHandlingMethod::AlwaysSpawn
+        : ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    FVector SpawnLocation = StartSpot ? StartSpot->GetActorLocation() : FVector::ZeroVector;
+    FRotator SpawnRotation = StartSpot ? StartSpot->GetActorRotation() : FRotator::ZeroRotator;
+
+    UE_LOG(LogTemp, Warning, TEXT("生成位置: %s"), *SpawnLocation.ToString());
+
+    AFPSGameCharacter* NewCharacter = GetWorld()->SpawnActor<AFPSGameCharacter>(
+        PawnClassToSpawn,
+        SpawnLocation,
+        SpawnRotation,
+        SpawnParams
+    );
+
+    if (USpawnPointSubsystem* SpawnService = GetWorld()->GetSubsystem<USpawnPointSubsystem>())
+    {
+        SpawnService->OccupySpawnPoint(ESpawnPointType::Player, StartSpot, NewCharacter);
+    }
+
+    if (NewCharacter)
+    {
+        // 赋予控制权
+        PlayerController->Possess(NewCharacter);
+
+        UE_LOG(LogTemp, Warning, TEXT("成功生成角色: %s (地址: %p)"),
+            *NewCharacter->GetName(), NewCharacter);
+        UE_LOG(LogTemp, Warning, TEXT("角色网络角色: %s"),
+            *UEnum::GetValueAsString(NewCharacter->GetLocalRole()));
+        UE_LOG(LogTemp, Warning, TEXT("初始血量: %.0f/%.0f"),
+            NewCharacter->GetCurrentHealth(), NewCharacter->GetMaxHealth());
+    }
+    else
+    {
+        UE_LOG(LogTemp, Error, TEXT("生成角色失败！"));
+    }
+}
+
+
+//生成敌人
+void AMyGameMode::SpawnEnemy()
+{
+    // 游戏已结束则不生成敌人
+    if (bGameEnded) return;
+
+    if (!EnemyClass || SpawnPoints.Num() == 0)
+        return;
+
+    // 场上Actor敌人满了之后，新敌人以后台Mass实体的形式生成，靠近玩家时再提升为Actor
+    if (CurrentEnemyCount >= MaxEnemies)
+    {
+        UEnemyMassSubsystem* MassSubsystem = GetWorld()->GetSubsystem<UEnemyMassSubsystem>();
+        if (MassSubsystem && MassSubsystem->GetNumBackgroundEnemies() < MaxBackgroundEnemies)
+        {
+            // 和Actor敌人一样只用空闲的出生点，并且不和还停在出生点附近的后台敌人重叠
+            // 后台敌人不是Actor，出生点无法记录占用者，生成后（或放弃时）立即归还预留，重叠交给IsLocationOccupied判断
+            USpawnPointSubsystem* SpawnService = GetWorld()->GetSubsystem<USpawnPointSubsystem>();
+            bool bCollisionFree = false;
+            AActor* SpawnPoint = SpawnService ? SpawnService->AcquireSpawnPoint(ESpawnPointType::Enemy, bCollisionFree) : nullptr;
+            if (SpawnPoint)
+            {
+                if (bCollisionFree && !MassSubsystem->IsLocationOccupied(SpawnPoint->GetActorLocation()))
+                {
+                    MassSubsystem->SpawnBackgroundEnemy(SpawnPoint->GetActorLocation(), FRotator(0, FMath::RandRange(0.0f, 360.0f), 0), EnemyClass);
+                }
+                SpawnService->ReleaseSpawnPoint(ESpawnPointType::Enemy, SpawnPoint);
+            }
+        }
+        return;
+    }
+
+    USpawnPointSubsystem* SpawnService = GetWorld()->GetSubsystem<USpawnPointSubsystem>();
+    if (!SpawnService)
+        return;
+
+    // 选择离玩家最远的空闲生成点；都被占用时本轮不生成，避免敌人叠在一起
+    bool bCollisionFree = false;
+    AActor* SpawnPoint = SpawnService->AcquireSpawnPoint(ESpawnPointType::Enemy, bCollisionFree);
+    if (!SpawnPoint || !bCollisionFree)
+        return;
+
+    // 生成随机旋转（0-360度）
+    FRotator RandomRotation(0, FMath::RandRange(0.0f, 360.0f), 0);
+
+    // 生成敌人（优先复用对象池中的敌人）
+    AEnemyCharacter* Enemy = AcquireEnemy(SpawnPoint->GetActorLocation(), RandomRotation, bCollisionFree);
+    SpawnService->OccupySpawnPoint(ESpawnPointType::Enemy, SpawnPoint, Enemy);
+    if (Enemy)
+    {
+        CurrentEnemyCount++;
+        UE_LOG(LogTemp, Log, TEXT("生成敌人，当前数量: %d"), CurrentEnemyCount);
+    }
+}
+
+AEnemyCharacter* AMyGameMode::AcquireEnemy(const FVector& Location, const FRotator& Rotation, bool bCollisionFree)
+{
+    AEnemyCharacter* Enemy = nullptr;
+
+    while (PooledEnemies.Num() > 0 && !Enemy)
+    {
+        Enemy = PooledEnemies.Pop(EAllowShrinking::No);
+        if (!IsValid(Enemy))
+        {
+            Enemy = nullptr;
+        }
+    }
+
+    if (Enemy)
+    {
+        Enemy->ActivateFromPool(Location, Rotation);
+    }
+    else
+    {
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.SpawnCollisionHandlingOverride = bCollisionFree
+            ? ESpawnActorCollisionHandlingMethod::AlwaysSpawn
+            : ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+        Enemy = GetWorld()->SpawnActor<AEnemyCharacter>(EnemyClass, Location, Rotation, SpawnParams);
+    }
+
+    if (Enemy)
+    {
+        ActiveEnemies.Add(Enemy);
+    }
+    return Enemy;
+}
+
+AEnemyCharacter* AMyGameMode::PromoteBackgroundEnemy(const FVector& Location, const FRotator& Rotation, float Health)
+{
+    if (bGameEnded || CurrentEnemyCount >= MaxEnemies || !EnemyClass)
+    {
+        return nullptr;
+    }
+
+    // 后台敌人按网格移动，位置可能不在导航网格上或和其他角色重叠：先投影到导航网格，再找附近不碰撞的位置
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    FNavLocation NavLocation;
+    if (!NavSys || !NavSys->ProjectPointToNavigation(Location, NavLocation, FVector(200.0f, 200.0f, 500.0f)))
+    {
+        return nullptr;
+    }
+
+    const AEnemyCharacter* EnemyDefaults = EnemyClass->GetDefaultObject<AEnemyCharacter>();
+    FVector SpawnLocation = NavLocation.Location + FVector(0.0f, 0.0f, EnemyDefaults->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+    if (!GetWorld()->FindTeleportSpot(EnemyDefaults, SpawnLocation, Rotation))
+    {
+        return nullptr;
+    }
+
+    AEnemyCharacter* Enemy = AcquireEnemy(SpawnLocation, Rotation, true);
+    if (Enemy)
+    {
+        Enemy->SetCurrentHealth(Health);
+        CurrentEnemyCount++;
+    }
+    return Enemy;
+}
+
+void AMyGameMode::DemoteDistantEnemies()
+{
+    UEnemyMassSubsystem* MassSubsystem = GetWorld()->GetSubsystem<UEnemyMassSubsystem>();
+    if (!MassSubsystem || bGameEnded)
+    {
+        return;
+    }
+
+    FProximityPositions PlayerPositions;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PC = It->Get();
+        if (PC && PC->GetPawn())
+        {
+            PlayerPositions.Add(PC->GetPawn()->GetActorLocation());
+        }
+    }
+
+    const float DemotionDistSquared = FMath::Square(MassSubsystem->GetDemotionDistance());
+    for (int32 Index = ActiveEnemies.Num() - 1; Index >= 0; --Index)
+    {
+        AEnemyCharacter* Enemy = ActiveEnemies[Index];
+        if (MassSubsystem->GetNumBackgroundEnemies() >= MaxBackgroundEnemies)
+        {
+            break;
+        }
+
+        // 只降级在巡逻中的敌人，正在追击/攻击的保持为Actor
+        const AEnemyAIController* EnemyController = IsValid(Enemy) ? Cast<AEnemyAIController>(Enemy->GetController()) : nullptr;
+        if (!EnemyController || EnemyController->GetBrainState() != EEnemyBrainState::Patrol)
+        {
+            continue;
+        }
+
+        float NearestDistSquared = 0.0f;
+        if (FProximityKernels::FindNearest(Enemy->GetActorLocation(), PlayerPositions, DemotionDistSquared, NearestDistSquared) != INDEX_NONE)
+        {
+            continue;
+        }
+
+        if (MassSubsystem->DemoteEnemy(Enemy))
+        {
+            ReleaseEnemy(Enemy);
+            CurrentEnemyCount = FMath::Max(0, CurrentEnemyCount - 1);
+        }
+    }
+}
+
+void AMyGameMode::ReleaseEnemy(AEnemyCharacter* Enemy)
+{
+    if (!IsValid(Enemy))
+    {
+        return;
+    }
+
+    ActiveEnemies.RemoveSingleSwap(Enemy, EAllowShrinking::No);
+
+    // 池的大小不超过最大敌人数量，多余的直接销毁
+    if (PooledEnemies.Num() < MaxEnemies)
+    {
+        Enemy->DeactivateToPool();
+        PooledEnemies.AddUnique(Enemy);
+    }
+    else
+    {
+        Enemy->Destroy();
+    }
+}
+
+void AMyGameMode::OnEnemyDeath(AEnemyCharacter* DeadEnemy)
+{
+    if (!DeadEnemy || bGameEnded)
+        return;
+
+    UE_LOG(LogTemp, Warning, TEXT("=== MyGameMode::OnEnemyDeath 被调用 ==="));
+    UE_LOG(LogTemp, Warning, TEXT("死亡敌人: %s"), *DeadEnemy->GetName());
+
+    // 获取击杀者控制器
+    AController* KillerController = DeadEnemy->GetEnemyKiller();
+
+    if (KillerController)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("击杀者: %s"), *KillerController->GetName());
+
+        // 尝试转换为玩家控制器
+        APlayerController* PlayerController = Cast<APlayerController>(KillerController);
+        if (PlayerController)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("击杀者是玩家控制器"));
+
+            // 获取击杀者的玩家状态
+            AMyPlayerState* KillerPlayerState = KillerController->GetPlayerState<AMyPlayerState>();
+            if (KillerPlayerState)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("找到玩家状态: %s, 当前得分: %f"),
+                    *KillerPlayerState->GetPlayerName(), KillerPlayerState->GetScore());
+
+                // 调用 RPC 给击杀者加5分
+                KillerPlayerState->AddPlayerScore(5);
+
+                UE_LOG(LogTemp, Warning, TEXT("玩家 %s 击杀敌人，获得5分"),
+                    *KillerPlayerState->GetPlayerName());
+            }
+            else
+            {
+                UE_LOG(LogTemp, Error, TEXT("无法获取击杀者的玩家状态！"));
+            }
+        }
+        else
+        {
+            // 可能是AI控制器
+            UE_LOG(LogTemp, Warning, TEXT("击杀者不是玩家控制器，是: %s"),
+                *KillerController->GetClass()->GetName());
+        }
+    }
+    else
+    {
+        UE_LOG(LogTemp, Error, TEXT("没有找到击杀者！"));
+
+        // 尝试获取第一个玩家作为测试
+        APlayerController* TestPC = GetWorld()->GetFirstPlayerController();
+        if (TestPC)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("作为测试，给第一个玩家 %s 加分"),
+                *TestPC->GetName());
+
+            AMyPlayerState* TestPS = TestPC->GetPlayerState<AMyPlayerState>();
+            if (TestPS)
+            {
+                TestPS->AddPlayerScore(5);
+            }
+        }
+    }
+
+    // 减少敌人计数
+    CurrentEnemyCount = FMath::Max(0, CurrentEnemyCount - 1);
+    EnemiesKilledThisRound++;
+    UE_LOG(LogTemp, Log, TEXT("敌人死亡，当前存活敌人数量: %d/%d"), CurrentEnemyCount, MaxEnemies);
+}
+
+void AMyGameMode::OnPlayerDeath(AFPSGameCharacter* DeadPlayer)
+{
+    if (!DeadPlayer || bGameEnded) return;
+
+    CurrentAlivePlayers--;
+    UE_LOG(LogTemp, Warning, TEXT("玩家 %s 死亡！当前存活玩家: %d"), *DeadPlayer->GetName(), CurrentAlivePlayers);
+
+    // 立即检查游戏是否结束
+    CheckForWinner();
+}
+
+void AMyGameMode::CheckForWinner()
+{
+    // 游戏已结束则不检查
+    if (bGameEnded) return;
+
+    TArray<AFPSGameCharacter*> AlivePlayers = GetAlivePlayers();
+
+    // 时间耗尽由MatchEndTimerHandle单独触发
+
+    // 条件1：只有1个玩家存活
+    if (AlivePlayers.Num() == 1)
+    {
+        AFPSGameCharacter* WinnerPlayer = AlivePlayers[0];
+        if (WinnerPlayer)
+        {
+            AMyPlayerState* WinnerPS = WinnerPlayer->GetPlayerState<AMyPlayerState>();
+            if (WinnerPS)
+            {
+                EndGame(FString::Printf(TEXT("玩家 %s 胜利！"), *WinnerPS->GetPlayerName()));
+            }
+        }
+        return;
+    }
+
+    // 条件2：没有玩家存活
+    if (AlivePlayers.Num() == 0)
+    {
+        EndGame(FString::Printf(TEXT("所有玩家死亡！")));
+        return;
+    }
+}
+//得分统计
+void AMyGameMode::PrintScoreboard()
+{
+    UE_LOG(LogTemp, Warning, TEXT("========== 得分榜 =========="));
+
+    // 遍历所有玩家控制器
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PC = It->Get();
+        if (PC)
+        {
+            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
+            if (PS)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("玩家: %s - 得分: %f"),
+                    *PS->GetPlayerName(),
+                    PS->GetScore());
+            }
+        }
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("============================"));
+}
+
+//测试给指定玩家加分
+void AMyGameMode::AddScoreToPlayer(int32 PlayerIndex, int32 Score)
+{
+    int32 Count = 0;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PC = It->Get();
+        if (PC && Count == PlayerIndex)
+        {
+            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
+            if (PS)
+            {
+                PS->AddPlayerScore(Score);
+                UE_LOG(LogTemp, Warning, TEXT("给玩家 %s 添加 %d 分，当前得分: %f"),
+                    *PS->GetPlayerName(), Score, PS->GetScore());
+                return;
+            }
+        }
+        Count++;
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("未找到玩家索引: %d"), PlayerIndex);
+}
+
+// 游戏结束时添加一个调试命令
+void AMyGameMode::DebugScore()
+{
+    PrintScoreboard();
+}
+
+void AMyGameMode::OnMatchTimeUp()
+{
+    EndGame(TEXT("时间到！"));
+}
+
+void AMyGameMode::TestScore()
+{
+    UE_LOG(LogTemp, Warning, TEXT("=== 测试加分功能 ==="));
+
+    // 遍历所有玩家控制器
+    int32 PlayerCount = 0;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PC = It->Get();
+        if (PC)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("玩家控制器 %d: %s"), PlayerCount, *PC->GetName());
+
+            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
+            if (PS)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("  玩家状态: %s, 当前得分: %f"),
+                    *PS->GetPlayerName(), PS->GetScore());
+
+                // 测试加分
+                PS->AddPlayerScore(10);
+                UE_LOG(LogTemp, Warning, TEXT("  测试加分10分，新得分: %f"), PS->GetScore());
+            }
+            else
+            {
+                UE_LOG(LogTemp, Error, TEXT("  没有找到玩家状态！"));
+            }
+            PlayerCount++;
+        }
+    }
+}
+
+void AMyGameMode::AddTestScoreToAll()
+{
+    UE_LOG(LogTemp, Warning, TEXT("=== 给所有玩家加测试分 ==="));
+
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PC = It->Get();
+        if (PC)
+        {
+            AMyPlayerState* PS = PC->GetPlayerState<AMyPlayerState>();
+            if (PS)
+            {
+                PS->AddPlayerScore(5);
+                UE_LOG(LogTemp, Warning, TEXT("玩家 %s 获得5分，当前得分: %f"),
+                    *PS->GetPlayerName(), PS->GetScore());
+            }
+        }
+    }
+}
+
+void AMyGameMode::TestKill()
+{
+    UE_LOG(LogTemp, Warning, TEXT("=== 模拟击杀测试 ==="));
+
+    // 找到第一个玩家控制器
+    APlayerController* FirstPC = nullptr;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        FirstPC = It->Get();
+        if (FirstPC) break;
+    }
+
+    if (FirstPC)
+    {
+        // 调用 OnEnemyDeath 函数，传入一个虚拟的击杀者
+        UE_LOG(LogTemp, Warning, TEXT("模拟玩家 %s 击杀敌人"), *FirstPC->GetName());
+
+        // 创建一个临时的敌人指针（实际不创建敌人，只是测试逻辑）
+        AEnemyCharacter* DummyEnemy = nullptr;
+
+        // 直接调用加分逻辑
+        AMyPlayerState* PS = FirstPC->GetPlayerState<AMyPlayerState>();
+        if (PS)
+        {
+            PS->AddPlayerScore(5);
+            UE_LOG(LogTemp, Warning, TEXT("模拟击杀成功，玩家 %s 获得5分"), *PS->GetPlayerName());
+        }
+    }
+}
+
+void AMyGameMode::EndGame(const FString& EndReason)
+{
+    if (bGameEnded) return;
+
+    bGameEnded = true;
+
+    // 停止所有定时器
+    GetWorld()->GetTimerManager().ClearTimer(SpawnEnemyTimerHandle);
+    GetWorld()->GetTimerManager().ClearTimer(MatchEndTimerHandle);
+
+    // 提前结束时客户端的计时停在结束时刻
+    if (AMyGameState* MatchState = GetGameState<AMyGameState>())
+    {
+        MatchState->StopMatchClock();
+    }
+
+    // 获取存活玩家
+    TArray<AFPSGameCharacter*> AlivePlayers = GetAlivePlayers();
+    AMyPlayerState* RoundWinner = nullptr;
+
+    if (AlivePlayers.Num() == 1)
+    {
+        // 有胜利者
+        AFPSGameCharacter* Winner = AlivePlayers[0];
+        if (Winner)
+        {
+            AMyPlayerState* WinnerPS = Winner->GetPlayerState<AMyPlayerState>();
+            if (WinnerPS)
+            {
+                RoundWinner = WinnerPS;
+                WinnerPS->SetIsWinner(true);
+                UE_LOG(LogTemp, Warning, TEXT("[游戏结束] %s 胜利者: %s (得分: %f)"),
+                    *EndReason, *WinnerPS->GetPlayerName(), WinnerPS->GetScore());
+            }
+        }
+    }
+    else if (AlivePlayers.Num() > 1)
+    {
+        // 多个玩家存活，比较得分
+        AMyPlayerState* Winner = nullptr;
+        float HighestScore = -1.0f;
+
+        for (AFPSGameCharacter* Player : AlivePlayers)
+        {
+            if (Player)
+            {
+                AMyPlayerState* PS = Player->GetPlayerState<AMyPlayerState>();
+                if (PS && PS->GetScore() > HighestScore)
+                {
+                    HighestScore = PS->GetScore();
+                    Winner = PS;
+                }
+            }
+        }
+
+        if (Winner)
+        {
+            RoundWinner = Winner;
+            Winner->SetIsWinner(true);
+            UE_LOG(LogTemp, Warning, TEXT("[游戏结束] %s 胜利者: %s (最高得分: %f)"),
+                *EndReason, *Winner->GetPlayerName(), Winner->GetScore());
+        }
+    }
+    else
+    {
+        // 没有存活玩家
+        UE_LOG(LogTemp, Warning, TEXT("[游戏结束] %s 没有胜利者"), *EndReason);
+    }
+
+    // 这里可以添加游戏结束的UI显示、数据统计等逻辑
+    UE_LOG(LogTemp, Warning, TEXT("游戏结束！原因：%s"), *EndReason);
+
+    RecordRound(EndReason, RoundWinner);
+
+    // 当前地图的局数未满时，结算结束后原地开始下一局
+    const bool bRotateMap = RoundsPerMap > 0 && CurrentRound >= RoundsPerMap && !NextMapName.IsEmpty();
+    if (!bRotateMap)
+    {
+        GetWorld()->GetTimerManager().SetTimer(RoundRestartTimerHandle, this, &AMyGameMode::RestartRound, ScoreboardDuration, false);
+        return;
+    }
+
+    // 结算阶段预加载下一局地图，结算结束后无缝旅行
+    if (UMatchFlowSubsystem* MatchFlow = GetGameInstance()->GetSubsystem<UMatchFlowSubsystem>())
+    {
+        MatchFlow->PreloadMap(NextMapName);
+    }
+
+    GetWorld()->GetTimerManager().SetTimer(MatchTransitionTimerHandle, this, &AMyGameMode::TravelToNextMap, ScoreboardDuration, false);
+}
+
+void AMyGameMode::TravelToNextMap()
+{
+    if (UMatchFlowSubsystem* MatchFlow = GetGameInstance()->GetSubsystem<UMatchFlowSubsystem>())
+    {
+        MatchFlow->TravelToMap(NextMapName);
+    }
+}
+
+void AMyGameMode::DebugPlayers()
+{
+    UE_LOG(LogTemp, Warning, TEXT("======= 玩家调试信息 ======="));
+
+    // 通过PlayerController遍历
+    int32 PlayerIndex = 0;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PC = It->Get();
+        if (PC)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("玩家%d:"), PlayerIndex++);
+            UE_LOG(LogTemp, Warning, TEXT("  控制器: %s"), *PC->GetName());
+            UE_LOG(LogTemp, Warning, TEXT("  网络角色: %s"),
+                *UEnum::GetValueAsString(PC->GetLocalRole()));
+
+            if (PC->PlayerState)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("  玩家名称: %s"), *PC->PlayerState->GetPlayerName());
+            }
+
+            AFPSGameCharacter* Character = Cast<AFPSGameCharacter>(PC->GetPawn());
+            if (Character)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("  角色: %s (地址: %p)"),
+                    *Character->GetName(), Character);
+                UE_LOG(LogTemp, Warning, TEXT("  角色网络角色: %s"),
+                    *UEnum::GetValueAsString(Character->GetLocalRole()));
+                UE_LOG(LogTemp, Warning, TEXT("  血量: %.0f/%.0f"),
+                    Character->GetCurrentHealth(), Character->GetMaxHealth());
+            }
+            else
+            {
+                UE_LOG(LogTemp, Warning, TEXT("  角色: 无"));
+            }
+        }
+    }
+
+    // 查找所有FPSGameCharacter实例
+    TArray<AActor*> AllCharacters;
+    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFPSGameCharacter::StaticClass(), AllCharacters);
+
+    UE_LOG(LogTemp, Warning, TEXT("所有FPSGameCharacter实例 (%d 个):"), AllCharacters.Num());
+    for (AActor* Actor : AllCharacters)
+    {
+        AFPSGameCharacter* Character = Cast<AFPSGameCharacter>(Actor);
+        if (Character)
+        {
+            APlayerController* OwnerPC = Cast<APlayerController>(Character->GetController());
+            FString OwnerName = OwnerPC ? OwnerPC->GetName() : TEXT("无控制器");
+
+            UE_LOG(LogTemp, Warning, TEXT("  - %s (地址: %p)"),
+                *Character->GetName(), Character);
+            UE_LOG(LogTemp, Warning, TEXT("    控制器: %s"), *OwnerName);
+            UE_LOG(LogTemp, Warning, TEXT("    网络角色: %s"),
+                *UEnum::GetValueAsString(Character->GetLocalRole()));
+            UE_LOG(LogTemp, Warning, TEXT("    血量: %.0f/%.0f"),
+                Character->GetCurrentHealth(), Character->GetMaxHealth());
+        }
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("当前存活玩家数: %d"), CurrentAlivePlayers);
+    UE_LOG(LogTemp, Warning, TEXT("游戏是否结束: %s"), bGameEnded ? TEXT("是") : TEXT("否"));
+    UE_LOG(LogTemp, Warning, TEXT("================================="));
+}
+
+TArray<AFPSGameCharacter*> AMyGameMode::GetAlivePlayers()
+{
+    TArray<AFPSGameCharacter*> AlivePlayers;
+    TArray<AActor*> AllPlayers;
+
+    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AFPSGameCharacter::StaticClass(), AllPlayers);
+
+    for (AActor* Actor : AllPlayers)
+    {
+        AFPSGameCharacter* Player = Cast<AFPSGameCharacter>(Actor);
+        if (Player && Player->GetCurrentHealth() > 0.0f)
+        {
+            AlivePlayers.Add(Player);
+        }
+    }
+
+    return AlivePlayers;
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "GameMode/SpawnPointSubsystem.h"
+#include "GameFramework/Actor.h"
+
+namespace
+{
+    // 堆顶为评分最高的出生点
+    struct FSpawnHeapPredicate
+    {
+        template <typename NodeType>
+        bool operator()(const NodeType& A, const NodeType& B) const
+        {
+            return A.Score > B.Score;
+        }
+    };
+
+    // 到一组位置的最近距离的平方（超过CurrentMin时返回CurrentMin）
+    float GetMinDistSquared(const FVector& Location, const FProximityPositions& Others, float CurrentMin)
+    {
+        float NearestDistSquared = CurrentMin;
+        FProximityKernels::FindNearest(Location, Others, CurrentMin, NearestDistSquared);
+        return NearestDistSquared;
+    }
+}
+
+void USpawnPointSubsystem::RegisterSpawnPoints(ESpawnPointType Type, const TArray<AActor*>& Points)
+{
+    FSpawnPointPool& Pool = GetPool(Type);
+    Pool.Points.Reset(Points.Num());
+    Pool.FreeHeap.Reset(Points.Num());
+    Pool.IndexByActor.Reset();
+    Pool.FallbackIndex = 0;
+
+    for (AActor* Point : Points)
+    {
+        if (!IsValid(Point))
+        {
+            continue;
+        }
+
+        const int32 PointIndex = Pool.Points.AddDefaulted();
+        FSpawnPointEntry& Entry = Pool.Points[PointIndex];
+        Entry.Actor = Point;
+        Entry.Location = Point->GetActorLocation();
+        Pool.IndexByActor.Add(Point, PointIndex);
+
+        // 还没有评分时所有点同等可用
+        Pool.FreeHeap.Add({ 0.0f, PointIndex });
+    }
+}
+
+bool USpawnPointSubsystem::IsStillOccupied(const FSpawnPointEntry& Entry) const
+{
+    // 已预留但还没生成出角色
+    if (Entry.bReserved)
+    {
+        return true;
+    }
+
+    // 占用者被销毁或回收到对象池（隐藏）后出生点释放
+    const AActor* Occupant = Entry.Occupant.Get();
+    if (!IsValid(Occupant) || Occupant->IsHidden())
+    {
+        return false;
+    }
+
+    return FVector::DistSquared(Occupant->GetActorLocation(), Entry.Location) < FMath::Square(OccupancyRadius);
+}
+
+void USpawnPointSubsystem::RefreshScores(const TArray<FVector>& PlayerLocations, const TArray<FVector>& EnemyLocations)
+{
+    // 玩家出生点远离敌人和其他玩家；敌人出生点远离玩家，同时不能生成在其他敌人身上
+    FProximityPositions PlayerPositions;
+    PlayerPositions.Append(PlayerLocations);
+    FProximityPositions EnemyPositions;
+    EnemyPositions.Append(EnemyLocations);
+
+    RefreshPool(GetPool(ESpawnPointType::Player), EnemyPositions, &PlayerPositions);
+    RefreshPool(GetPool(ESpawnPointType::Enemy), PlayerPositions, &EnemyPositions);
+}
+
+void USpawnPointSubsystem::RefreshPool(FSpawnPointPool& Pool, const FProximityPositions& ThreatPositions, const FProximityPositions* ExtraThreatPositions)
+{
+    const float MaxScoreDistSquared = FMath::Square(MaxScoreDistance);
+    const float OccupancyRadiusSquared = FMath::Square(OccupancyRadius);
+
+    Pool.FreeHeap.Reset();
+
+    for (int32 PointIndex = 0; PointIndex < Pool.Points.Num(); ++PointIndex)
+    {
+        FSpawnPointEntry& Entry = Pool.Points[PointIndex];
+        if (!Entry.Actor.IsValid())
+        {
+            continue;
+        }
+
+        if (IsStillOccupied(Entry))
+        {
+            continue;
+        }
+        Entry.Occupant.Reset();
+
+        // 有角色站在出生点上时不可用（避免生成时需要推挤）
+        float MinBlockerDistSquared = MaxScoreDistSquared;
+        if (ExtraThreatPositions)
+        {
+            MinBlockerDistSquared = GetMinDistSquared(Entry.Location, *ExtraThreatPositions, MinBlockerDistSquared);
+        }
+
+        const float MinThreatDistSquared = GetMinDistSquared(Entry.Location, ThreatPositions, MaxScoreDistSquared);
+        if (FMath::Min(MinBlockerDistSquared, MinThreatDistSquared) < OccupancyRadiusSquared)
+        {
+            continue;
+        }
+
+        // 离威胁越远评分越高，超过上限后同等对待
+        Pool.FreeHeap.Add({ FMath::Sqrt(MinThreatDistSquared), PointIndex });
+    }
+
+    Pool.FreeHeap.Heapify(FSpawnHeapPredicate());
+}
+
+AActor* USpawnPointSubsystem::AcquireSpawnPoint(ESpawnPointType Type, bool& bOutCollisionFree)
+{
+    FSpawnPointPool& Pool = GetPool(Type);
+    bOutCollisionFree = false;
+
+    while (Pool.FreeHeap.Num() > 0)
+    {
+        FSpawnHeapNode Node;
+        Pool.FreeHeap.HeapPop(Node, FSpawnHeapPredicate(), EAllowShrinking::No);
+
+        FSpawnPointEntry& Entry = Pool.Points[Node.PointIndex];
+        if (AActor* Point = Entry.Actor.Get())
+        {
+            // 预留到生成完成，之后由占用者决定何时释放
+            Entry.bReserved = true;
+            Entry.Occupant.Reset();
+            bOutCollisionFree = true;
+            return Point;
+        }
+    }
+
+    // 所有出生点都被占用时退回轮询，由调用方处理碰撞
+    for (int32 Attempt = 0; Attempt < Pool.Points.Num(); ++Attempt)
+    {
+        const FSpawnPointEntry& Entry = Pool.Points[Pool.FallbackIndex++ % Pool.Points.Num()];
+        if (AActor* Point = Entry.Actor.Get())
+        {
+            return Point;
+        }
+    }
+
+    return nullptr;
+}
+
+void USpawnPointSubsystem::OccupySpawnPoint(ESpawnPointType Type, AActor* SpawnPoint, AActor* Occupant)
+{
+    FSpawnPointPool& Pool = GetPool(Type);
+    const int32* PointIndex = Pool.IndexByActor.Find(SpawnPoint);
+    if (!PointIndex)
+    {
+        return;
+    }
+
+    FSpawnPointEntry& Entry = Pool.Points[*PointIndex];
+    Entry.bReserved = false;
+    Entry.Occupant = Occupant;
+
+    // 生成失败时出生点立即回到空闲堆
+    if (!Occupant && !Pool.FreeHeap.ContainsByPredicate([&](const FSpawnHeapNode& Node) { return Node.PointIndex == *PointIndex; }))
+    {
+        Pool.FreeHeap.HeapPush({ 0.0f, *PointIndex }, FSpawnHeapPredicate());
+    }
+}
+
+void USpawnPointSubsystem::ReleaseSpawnPoint(ESpawnPointType Type, AActor* SpawnPoint)
+{
+    // 轮询退回的出生点没有预留，可能还有占用者，不能清掉
+    const FSpawnPointPool& Pool = GetPool(Type);
+    const int32* PointIndex = Pool.IndexByActor.Find(SpawnPoint);
+    if (PointIndex && Pool.Points[*PointIndex].bReserved)
+    {
+        OccupySpawnPoint(Type, SpawnPoint, nullptr);
+    }
+}
+
+int32 USpawnPointSubsystem::GetNumSpawnPoints(ESpawnPointType Type) const
+{
+    return GetPool(Type).Points.Num();
+}
+
+int32 USpawnPointSubsystem::GetNumFreeSpawnPoints(ESpawnPointType Type) const
+{
+    return GetPool(Type).FreeHeap.Num();
+}
@@ -0,0 +1,56 @@
+#include "GameState/MyGameState.h"
+#include "Net/TimeSyncComponent.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+void AMyGameState::StartMatchClock(double StartTime, float Duration)
+{
+    MatchStartTime = StartTime;
+    MatchEndTime = StartTime + Duration;
+    ForceNetUpdate();
+}
+
+void AMyGameState::StopMatchClock()
+{
+    MatchEndTime = FMath::Min(MatchEndTime, GetWorld()->GetTimeSeconds());
+    ForceNetUpdate();
+}
+
+double AMyGameState::GetSynchronizedServerTime() const
+{
+    if (HasAuthority())
+    {
+        return GetWorld()->GetTimeSeconds();
+    }
+
+    const UTimeSyncComponent* TimeSync = UTimeSyncComponent::Get(GetWorld()->GetFirstPlayerController());
+    return TimeSync ? TimeSync->GetServerTime() : GetServerWorldTimeSeconds();
+}
+
+float AMyGameState::GetRemainingTime() const
+{
+    if (MatchEndTime <= 0.0)
+    {
+        return 0.0f;
+    }
+
+    return static_cast<float>(FMath::Max(MatchEndTime - GetSynchronizedServerTime(), 0.0));
+}
+
+float AMyGameState::GetElapsedTime() const
+{
+    if (MatchEndTime <= 0.0)
+    {
+        return 0.0f;
+    }
+
+    return static_cast<float>(FMath::Clamp(GetSynchronizedServerTime(), MatchStartTime, MatchEndTime) - MatchStartTime);
+}
+
+void AMyGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(AMyGameState, MatchStartTime);
+    DOREPLIFETIME(AMyGameState, MatchEndTime);
+}
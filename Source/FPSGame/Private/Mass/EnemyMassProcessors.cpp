@@ -0,0 +1,229 @@
+#include "Mass/EnemyMassProcessors.h"
+#include "Mass/EnemyMassFragments.h"
+#include "Mass/EnemyMassSubsystem.h"
+#include "AI/EnemyFlowFieldSubsystem.h"
+#include "GameMode/MyGameMode.h"
+#include "Character/EnemyCharacter.h"
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "Engine/World.h"
+
+namespace EnemyMass
+{
+    // 所有后台敌人处理器放在同一组，按 目标选择 -> 移动 -> 提升 的顺序执行
+    // 后台敌人不复制，客户端看不到，所以不攻击：只在攻击范围外等待提升，提升后由Actor敌人的AI攻击
+    const FName ProcessorGroup(TEXT("EnemyMass"));
+
+    // 只在服务器（和单机）上运行
+    void SetupServerProcessor(FMassProcessorExecutionOrder& ExecutionOrder, int32& ExecutionFlags)
+    {
+        ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Server | EProcessorExecutionFlags::Standalone);
+        ExecutionOrder.ExecuteInGroup = ProcessorGroup;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// 目标选择
+
+UEnemyMassTargetingProcessor::UEnemyMassTargetingProcessor()
+    : EntityQuery(*this)
+{
+    EnemyMass::SetupServerProcessor(ExecutionOrder, ExecutionFlags);
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+    bRequiresGameThreadExecution = false;
+}
+
+void UEnemyMassTargetingProcessor::Initialize(UObject& Owner)
+{
+    Super::Initialize(Owner);
+    MassSubsystem = UWorld::GetSubsystem<UEnemyMassSubsystem>(Owner.GetWorld());
+}
+
+void UEnemyMassTargetingProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FEnemyMassCombatFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FEnemyMassTargetFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddTagRequirement<FEnemyMassTag>(EMassFragmentPresence::All);
+}
+
+void UEnemyMassTargetingProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    if (!MassSubsystem)
+    {
+        return;
+    }
+
+    const FProximityPositions& PlayerPositions = MassSubsystem->GetPlayerPositions();
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [&PlayerPositions](FMassExecutionContext& ChunkContext)
+    {
+        const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+        const TConstArrayView<FEnemyMassCombatFragment> Combats = ChunkContext.GetFragmentView<FEnemyMassCombatFragment>();
+        const TArrayView<FEnemyMassTargetFragment> Targets = ChunkContext.GetMutableFragmentView<FEnemyMassTargetFragment>();
+
+        for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); ++EntityIndex)
+        {
+            FEnemyMassTargetFragment& Target = Targets[EntityIndex];
+            Target.TargetIndex = FProximityKernels::FindNearest(Transforms[EntityIndex].GetTransform().GetLocation(),
+                PlayerPositions, FMath::Square(Combats[EntityIndex].ChaseRange), Target.DistSquared);
+        }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////
+// 移动
+
+UEnemyMassMovementProcessor::UEnemyMassMovementProcessor()
+    : EntityQuery(*this)
+{
+    EnemyMass::SetupServerProcessor(ExecutionOrder, ExecutionFlags);
+    ExecutionOrder.ExecuteAfter.Add(UEnemyMassTargetingProcessor::StaticClass()->GetFName());
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+    bRequiresGameThreadExecution = false;
+}
+
+void UEnemyMassMovementProcessor::Initialize(UObject& Owner)
+{
+    Super::Initialize(Owner);
+    MassSubsystem = UWorld::GetSubsystem<UEnemyMassSubsystem>(Owner.GetWorld());
+}
+
+void UEnemyMassMovementProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FEnemyMassCombatFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FEnemyMassTargetFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddTagRequirement<FEnemyMassTag>(EMassFragmentPresence::All);
+}
+
+void UEnemyMassMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    if (!MassSubsystem)
+    {
+        return;
+    }
+
+    // 没有Actor的碰撞和移动组件，只沿流场的可行走格子移动，流场不可用时原地等待
+    const UEnemyFlowFieldSubsystem* FlowField = UWorld::GetSubsystem<UEnemyFlowFieldSubsystem>(MassSubsystem->GetWorld());
+    if (!FlowField || !FlowField->IsFieldReady())
+    {
+        return;
+    }
+
+    const float HoldDistance = MassSubsystem->GetHoldDistance();
+    const float DeltaTime = Context.GetDeltaTimeSeconds();
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [FlowField, HoldDistance, DeltaTime](FMassExecutionContext& ChunkContext)
+    {
+        const TArrayView<FTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FTransformFragment>();
+        const TConstArrayView<FEnemyMassCombatFragment> Combats = ChunkContext.GetFragmentView<FEnemyMassCombatFragment>();
+        const TConstArrayView<FEnemyMassTargetFragment> Targets = ChunkContext.GetFragmentView<FEnemyMassTargetFragment>();
+
+        for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); ++EntityIndex)
+        {
+            const FEnemyMassTargetFragment& Target = Targets[EntityIndex];
+            const FEnemyMassCombatFragment& Combat = Combats[EntityIndex];
+
+            // 没有目标或已经到等待距离时原地不动，等待距离始终在攻击范围外
+            if (Target.TargetIndex == INDEX_NONE || Target.DistSquared <= FMath::Square(FMath::Max(HoldDistance, Combat.AttackRange * 2.0f)))
+            {
+                continue;
+            }
+
+            FTransform& Transform = Transforms[EntityIndex].GetMutableTransform();
+            const FVector Location = Transform.GetLocation();
+
+            // 流场只读，工作线程上采样是安全的；方向已经检查过台阶高度和斜向切角，不会穿墙
+            FVector Direction;
+            float GroundHeight, NextGroundHeight;
+            if (!FlowField->GetFlowDirection(Location, Direction) || !FlowField->GetGroundHeight(Location, GroundHeight))
+            {
+                continue;
+            }
+
+            // 贴着导航网格的高度走，保持和地面的相对高度（胶囊体半高）
+            FVector NewLocation = Location + Direction * Combat.MoveSpeed * DeltaTime;
+            if (!FlowField->GetGroundHeight(NewLocation, NextGroundHeight))
+            {
+                continue;
+            }
+            NewLocation.Z = NextGroundHeight + (Location.Z - GroundHeight);
+
+            Transform.SetLocation(NewLocation);
+            Transform.SetRotation(Direction.ToOrientationQuat());
+        }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////
+// 提升为Actor
+
+UEnemyMassPromotionProcessor::UEnemyMassPromotionProcessor()
+    : EntityQuery(*this)
+{
+    EnemyMass::SetupServerProcessor(ExecutionOrder, ExecutionFlags);
+    ExecutionOrder.ExecuteAfter.Add(UEnemyMassMovementProcessor::StaticClass()->GetFName());
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+
+    // 生成Actor必须在游戏线程
+    bRequiresGameThreadExecution = true;
+}
+
+void UEnemyMassPromotionProcessor::Initialize(UObject& Owner)
+{
+    Super::Initialize(Owner);
+    MassSubsystem = UWorld::GetSubsystem<UEnemyMassSubsystem>(Owner.GetWorld());
+}
+
+void UEnemyMassPromotionProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FEnemyMassHealthFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddTagRequirement<FEnemyMassTag>(EMassFragmentPresence::All);
+}
+
+void UEnemyMassPromotionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    if (!MassSubsystem || MassSubsystem->GetPlayerPositions().Num() == 0)
+    {
+        return;
+    }
+
+    AMyGameMode* GameMode = MassSubsystem->GetWorld()->GetAuthGameMode<AMyGameMode>();
+    if (!GameMode)
+    {
+        return;
+    }
+
+    UEnemyMassSubsystem* Subsystem = MassSubsystem;
+    const float PromotionDistSquared = FMath::Square(Subsystem->GetPromotionDistance());
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [Subsystem, GameMode, PromotionDistSquared](FMassExecutionContext& ChunkContext)
+    {
+        const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+        const TConstArrayView<FEnemyMassHealthFragment> Healths = ChunkContext.GetFragmentView<FEnemyMassHealthFragment>();
+
+        for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); ++EntityIndex)
+        {
+            const FTransform& Transform = Transforms[EntityIndex].GetTransform();
+
+            float NearestDistSquared = 0.0f;
+            if (FProximityKernels::FindNearest(Transform.GetLocation(), Subsystem->GetPlayerPositions(), PromotionDistSquared, NearestDistSquared) == INDEX_NONE)
+            {
+                continue;
+            }
+
+            // 场上Actor敌人已满或附近没有能放下的位置时留在后台，之后再试
+            AEnemyCharacter* Enemy = GameMode->PromoteBackgroundEnemy(Transform.GetLocation(), Transform.Rotator(), Healths[EntityIndex].Health);
+            if (!Enemy)
+            {
+                continue;
+            }
+
+            const FMassEntityHandle Entity = ChunkContext.GetEntity(EntityIndex);
+            ChunkContext.Defer().DestroyEntity(Entity);
+            Subsystem->OnEntityPromoted(Entity);
+        }
+    });
+}
@@ -0,0 +1,143 @@
+#include "Mass/EnemyMassSubsystem.h"
+#include "Mass/EnemyMassFragments.h"
+#include "AI/EnemyTargetSubsystem.h"
+#include "Character/EnemyCharacter.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "MassEntitySubsystem.h"
+#include "MassCommonFragments.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Engine/World.h"
+
+bool UEnemyMassSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UEnemyMassSubsystem::Deinitialize()
+{
+    BackgroundEntities.Reset();
+    PlayerPositions.Reset();
+
+    Super::Deinitialize();
+}
+
+TStatId UEnemyMassSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyMassSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyMassSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // 处理器在下一帧的Mass阶段读取这份快照
+    RefreshPlayerSnapshot();
+}
+
+void UEnemyMassSubsystem::RefreshPlayerSnapshot()
+{
+    PlayerPositions.Reset();
+
+    const UEnemyTargetSubsystem* TargetSubsystem = GetWorld()->GetSubsystem<UEnemyTargetSubsystem>();
+    if (!TargetSubsystem || BackgroundEntities.Num() == 0)
+    {
+        return;
+    }
+
+    for (AFPSGameCharacter* Target : TargetSubsystem->GetTargets())
+    {
+        if (IsValid(Target) && Target->GetCurrentHealth() > 0.0f)
+        {
+            PlayerPositions.Add(Target->GetActorLocation());
+        }
+    }
+}
+
+bool UEnemyMassSubsystem::SpawnBackgroundEnemy(const FVector& Location, const FRotator& Rotation, TSubclassOf<AEnemyCharacter> EnemyClass, float Health)
+{
+    UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+    const AEnemyCharacter* EnemyDefaults = EnemyClass ? EnemyClass->GetDefaultObject<AEnemyCharacter>() : nullptr;
+    if (!EntitySubsystem || !EnemyDefaults)
+    {
+        return false;
+    }
+
+    FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+    if (!EnemyArchetype.IsValid())
+    {
+        EnemyArchetype = EntityManager.CreateArchetype({
+            FTransformFragment::StaticStruct(),
+            FEnemyMassHealthFragment::StaticStruct(),
+            FEnemyMassCombatFragment::StaticStruct(),
+            FEnemyMassTargetFragment::StaticStruct(),
+            FEnemyMassTag::StaticStruct()
+        });
+    }
+
+    const FMassEntityHandle Entity = EntityManager.CreateEntity(EnemyArchetype);
+
+    EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).SetTransform(FTransform(Rotation, Location));
+    EntityManager.GetFragmentDataChecked<FEnemyMassHealthFragment>(Entity).Health = Health > 0.0f ? Health : EnemyDefaults->GetMaxHealth();
+
+    FEnemyMassCombatFragment& Combat = EntityManager.GetFragmentDataChecked<FEnemyMassCombatFragment>(Entity);
+    Combat.ChaseRange = EnemyDefaults->GetChaseRange();
+    Combat.AttackRange = EnemyDefaults->GetAttackRange();
+    Combat.MoveSpeed = EnemyDefaults->GetCharacterMovement() ? EnemyDefaults->GetCharacterMovement()->MaxWalkSpeed : Combat.MoveSpeed;
+
+    BackgroundEntities.Add(Entity);
+    return true;
+}
+
+bool UEnemyMassSubsystem::IsLocationOccupied(const FVector& Location) const
+{
+    const UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+    if (!EntitySubsystem || BackgroundEntities.Num() == 0)
+    {
+        return false;
+    }
+
+    const FMassEntityManager& EntityManager = EntitySubsystem->GetEntityManager();
+    const float SeparationSquared = FMath::Square(SpawnSeparation);
+    for (const FMassEntityHandle& Entity : BackgroundEntities)
+    {
+        const FTransformFragment* Transform = EntityManager.IsEntityValid(Entity) ? EntityManager.GetFragmentDataPtr<FTransformFragment>(Entity) : nullptr;
+        if (Transform && FVector::DistSquared(Transform->GetTransform().GetLocation(), Location) < SeparationSquared)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UEnemyMassSubsystem::DemoteEnemy(AEnemyCharacter* Enemy)
+{
+    if (!IsValid(Enemy) || Enemy->IsDead())
+    {
+        return false;
+    }
+
+    return SpawnBackgroundEnemy(Enemy->GetActorLocation(), Enemy->GetActorRotation(), Enemy->GetClass(), Enemy->GetCurrentHealth());
+}
+
+void UEnemyMassSubsystem::DestroyAllBackgroundEnemies()
+{
+    UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+    if (EntitySubsystem && BackgroundEntities.Num() > 0)
+    {
+        FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+
+        TArray<FMassEntityHandle> EntitiesToDestroy;
+        EntitiesToDestroy.Reserve(BackgroundEntities.Num());
+        for (const FMassEntityHandle& Entity : BackgroundEntities)
+        {
+            if (EntityManager.IsEntityValid(Entity))
+            {
+                EntitiesToDestroy.Add(Entity);
+            }
+        }
+        EntityManager.BatchDestroyEntities(EntitiesToDestroy);
+    }
+
+    BackgroundEntities.Reset();
+}
@@ -0,0 +1,223 @@
+#include "Match/MatchFlowSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/World.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "UObject/UObjectGlobals.h"
+#include "TimerManager.h"
+
+void UMatchFlowSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // 记录切图开始和结束，用于统计切图耗时
+    PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UMatchFlowSubsystem::OnPreLoadMap);
+    SeamlessTravelStartHandle = FWorldDelegates::OnSeamlessTravelStart.AddUObject(this, &UMatchFlowSubsystem::OnSeamlessTravelStart);
+    PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UMatchFlowSubsystem::OnPostLoadMap);
+}
+
+void UMatchFlowSubsystem::Deinitialize()
+{
+    FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+    FWorldDelegates::OnSeamlessTravelStart.Remove(SeamlessTravelStartHandle);
+    FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+    ReleasePreloadedAssets();
+
+    Super::Deinitialize();
+}
+
+void UMatchFlowSubsystem::PreloadMap(const FString& MapPackageName)
+{
+    if (MapPackageName.IsEmpty())
+    {
+        return;
+    }
+
+    // 同一张地图已经在预加载或已完成
+    if (PreloadedMapName == MapPackageName && (PackagePreloadHandle.IsValid() || bMapPackageLoading || PreloadedMapPackage))
+    {
+        return;
+    }
+
+    ReleasePreloadedAssets();
+    PreloadedMapName = MapPackageName;
+    PreloadStartTime = FPlatformTime::Seconds();
+
+    // 只加载地图依赖的资源，地图本身由切图流程加载
+    TArray<FSoftObjectPath> AssetsToLoad;
+    GatherMapAssets(MapPackageName, AssetsToLoad);
+
+    UE_LOG(LogTemp, Warning, TEXT("[对局流程] 开始预加载地图 %s 的 %d 个资源"), *MapPackageName, AssetsToLoad.Num());
+
+    FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+    if (AssetsToLoad.Num() > 0)
+    {
+        PackagePreloadHandle = Streamable.RequestAsyncLoad(AssetsToLoad,
+            FStreamableDelegate::CreateUObject(this, &UMatchFlowSubsystem::OnPreloadComplete),
+            FStreamableManager::DefaultAsyncLoadPriority);
+    }
+    else
+    {
+        // 打包版本的资源注册表默认不带依赖信息，查不到依赖时直接异步加载地图包，它的依赖会一起加载
+        UE_LOG(LogTemp, Warning, TEXT("[对局流程] 资源注册表中没有地图 %s 的依赖信息，改为异步加载地图包"), *MapPackageName);
+        bMapPackageLoading = true;
+        LoadPackageAsync(MapPackageName,
+            FLoadPackageAsyncDelegate::CreateUObject(this, &UMatchFlowSubsystem::OnMapPackageLoaded));
+    }
+
+    if (PreloadPrimaryAssets.Num() > 0 && UAssetManager::IsInitialized())
+    {
+        PrimaryAssetPreloadHandle = UAssetManager::Get().LoadPrimaryAssets(PreloadPrimaryAssets);
+    }
+}
+
+void UMatchFlowSubsystem::GatherMapAssets(const FString& MapPackageName, TArray<FSoftObjectPath>& OutAssets)
+{
+    // 通过资源注册表找到地图的硬依赖
+    IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+    TArray<FName> Dependencies;
+    AssetRegistry.GetDependencies(FName(*MapPackageName), Dependencies,
+        UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+
+    for (const FName& Dependency : Dependencies)
+    {
+        // 跳过C++模块包
+        if (Dependency.ToString().StartsWith(TEXT("/Script/")))
+        {
+            continue;
+        }
+
+        TArray<FAssetData> PackageAssets;
+        AssetRegistry.GetAssetsByPackageName(Dependency, PackageAssets);
+        for (const FAssetData& AssetData : PackageAssets)
+        {
+            OutAssets.Add(AssetData.ToSoftObjectPath());
+        }
+    }
+}
+
+bool UMatchFlowSubsystem::IsMapPreloaded(const FString& MapPackageName) const
+{
+    return PreloadedMapName == MapPackageName
+        && !bMapPackageLoading
+        && (!PackagePreloadHandle.IsValid() || PackagePreloadHandle->HasLoadCompleted())
+        && (!PrimaryAssetPreloadHandle.IsValid() || PrimaryAssetPreloadHandle->HasLoadCompleted());
+}
+
+void UMatchFlowSubsystem::ReleasePreloadedAssets()
+{
+    if (PackagePreloadHandle.IsValid())
+    {
+        PackagePreloadHandle->ReleaseHandle();
+        PackagePreloadHandle.Reset();
+    }
+
+    if (PrimaryAssetPreloadHandle.IsValid())
+    {
+        PrimaryAssetPreloadHandle->ReleaseHandle();
+        PrimaryAssetPreloadHandle.Reset();
+    }
+
+    PreloadedMapPackage = nullptr;
+    bMapPackageLoading = false;
+    PreloadedMapName.Empty();
+}
+
+void UMatchFlowSubsystem::OnPreloadComplete()
+{
+    UE_LOG(LogTemp, Warning, TEXT("[对局流程] 地图 %s 资源预加载完成，耗时 %.2f 秒"),
+        *PreloadedMapName, FPlatformTime::Seconds() - PreloadStartTime);
+}
+
+void UMatchFlowSubsystem::OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+    // 加载期间换了预加载的地图或已经释放
+    if (!bMapPackageLoading || PackageName.ToString() != PreloadedMapName)
+    {
+        return;
+    }
+    bMapPackageLoading = false;
+
+    if (Result != EAsyncLoadingResult::Succeeded || !LoadedPackage)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("[对局流程] 地图包 %s 异步加载失败，切图时再同步加载"), *PreloadedMapName);
+        return;
+    }
+
+    PreloadedMapPackage = LoadedPackage;
+    OnPreloadComplete();
+}
+
+void UMatchFlowSubsystem::TravelToMap(const FString& MapPackageName, bool bListen)
+{
+    UWorld* World = GetGameInstance()->GetWorld();
+    if (!World || MapPackageName.IsEmpty())
+    {
+        return;
+    }
+
+    if (!IsMapPreloaded(MapPackageName))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("[对局流程] 地图 %s 尚未预加载完成，直接切图"), *MapPackageName);
+    }
+
+    // 监听服务器切图后要继续监听；独立模式只有调用方要求时才开始监听；专用服务器不需要
+    const ENetMode NetMode = World->GetNetMode();
+    FString URL = MapPackageName;
+    if (NetMode == NM_ListenServer || (bListen && NetMode == NM_Standalone))
+    {
+        URL += TEXT("?listen");
+    }
+
+    TravelStartTime = FPlatformTime::Seconds();
+    UE_LOG(LogTemp, Warning, TEXT("[对局流程] 切换到地图: %s"), *URL);
+
+    // 是否无缝由GameMode的bUseSeamlessTravel决定
+    World->ServerTravel(URL);
+}
+
+void UMatchFlowSubsystem::OnPreLoadMap(const FString& MapName)
+{
+    // 客户端的硬切图也从这里开始计时
+    if (TravelStartTime <= 0.0)
+    {
+        TravelStartTime = FPlatformTime::Seconds();
+    }
+}
+
+void UMatchFlowSubsystem::OnSeamlessTravelStart(UWorld* World, const FString& MapName)
+{
+    if (TravelStartTime <= 0.0)
+    {
+        TravelStartTime = FPlatformTime::Seconds();
+    }
+}
+
+void UMatchFlowSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+    if (!LoadedWorld || LoadedWorld->GetGameInstance() != GetGameInstance() || TravelStartTime <= 0.0)
+    {
+        return;
+    }
+
+    // 等到新地图真正跑完第一帧再计时
+    LoadedWorld->GetTimerManager().SetTimerForNextTick(
+        FTimerDelegate::CreateUObject(this, &UMatchFlowSubsystem::OnFirstPlayableFrame));
+}
+
+void UMatchFlowSubsystem::OnFirstPlayableFrame()
+{
+    if (TravelStartTime <= 0.0)
+    {
+        return;
+    }
+
+    LastTimeToFirstPlayableFrame = static_cast<float>(FPlatformTime::Seconds() - TravelStartTime);
+    TravelStartTime = 0.0;
+
+    UE_LOG(LogTemp, Warning, TEXT("[对局流程] 切图到首个可玩帧耗时: %.2f 秒"), LastTimeToFirstPlayableFrame);
+
+    // 新地图已经引用了需要的资源，预加载句柄可以释放了
+    ReleasePreloadedAssets();
+}
@@ -0,0 +1,101 @@
+#include "Match/MatchHostSubsystem.h"
+#include "Match/MatchFlowSubsystem.h"
+#include "MyGameInstance.h"
+#include "Engine/AssetManager.h"
+#include "Misc/Fork.h"
+
+bool UMatchHostSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    return IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UMatchHostSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (!FForkProcessHelper::IsForkRequested())
+    {
+        return;
+    }
+
+    // 派生前加载的资源由子进程继承，子进程切图时不用再加载
+    PreloadSharedAssets();
+
+    PostForkHandle = FCoreDelegates::OnPostFork.AddUObject(this, &UMatchHostSubsystem::OnPostFork);
+}
+
+void UMatchHostSubsystem::Deinitialize()
+{
+    FCoreDelegates::OnPostFork.Remove(PostForkHandle);
+    FTSTicker::GetCoreTicker().RemoveTicker(StartMatchTickerHandle);
+
+    if (SharedAssetsHandle.IsValid())
+    {
+        SharedAssetsHandle->ReleaseHandle();
+        SharedAssetsHandle.Reset();
+    }
+
+    Super::Deinitialize();
+}
+
+bool UMatchHostSubsystem::IsHostedMatchProcess() const
+{
+    return FForkProcessHelper::IsForkedChildProcess();
+}
+
+void UMatchHostSubsystem::PreloadSharedAssets()
+{
+    UMyGameInstance* GameInstance = Cast<UMyGameInstance>(GetGameInstance());
+    if (!GameInstance)
+    {
+        return;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    TArray<FSoftObjectPath> SharedAssets;
+    UMatchFlowSubsystem::GatherMapAssets(GameInstance->GetMatchMapName(), SharedAssets);
+
+    // 打包版本的资源注册表默认不带依赖信息，这时父进程没有可预加载的资源，子进程切图时各自加载
+    if (SharedAssets.IsEmpty())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("[多对局托管] 资源注册表中没有地图 %s 的依赖信息，父进程不预加载资源"), *GameInstance->GetMatchMapName());
+        return;
+    }
+
+    // 父进程在等待派生时不会Tick，这里必须同步加载完成
+    SharedAssetsHandle = UAssetManager::GetStreamableManager().RequestSyncLoad(SharedAssets);
+
+    UE_LOG(LogTemp, Warning, TEXT("[多对局托管] 父进程预加载 %d 个地图依赖资源，耗时 %.2f 秒"),
+        SharedAssets.Num(), FPlatformTime::Seconds() - StartTime);
+}
+
+void UMatchHostSubsystem::OnPostFork(EForkProcessRole ProcessRole)
+{
+    if (ProcessRole != EForkProcessRole::Child)
+    {
+        return;
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("[多对局托管] 对局子进程 %u 启动，多线程: %s"),
+        FPlatformProcess::GetCurrentProcessId(),
+        FForkProcessHelper::SupportsMultithreadingPostFork() ? TEXT("是") : TEXT("否"));
+
+    // 派生回调中不做重活，下一帧再创建会话
+    StartMatchTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+        FTickerDelegate::CreateUObject(this, &UMatchHostSubsystem::StartHostedMatch));
+}
+
+bool UMatchHostSubsystem::StartHostedMatch(float DeltaTime)
+{
+    StartMatchTickerHandle.Reset();
+
+    // 每个子进程注册自己的会话，创建成功后切换到对局地图（端口由子进程命令行的-Port指定）
+    if (UMyGameInstance* GameInstance = Cast<UMyGameInstance>(GetGameInstance()))
+    {
+        GameInstance->CreateSession(PlayersPerMatch, false);
+    }
+
+    // 只执行一次
+    return false;
+}
@@ -0,0 +1,338 @@
+#include "Math/ProximityKernels.h"
+#include "Math/VectorRegister.h"
+#include <cmath>
+#include <limits>
+
+void FProximityPositions::Reset(int32 ExpectedNum)
+{
+    X.Reset(ExpectedNum);
+    Y.Reset(ExpectedNum);
+    Z.Reset(ExpectedNum);
+}
+
+void FProximityPositions::Add(const FVector& Position)
+{
+    X.Add(static_cast<float>(Position.X));
+    Y.Add(static_cast<float>(Position.Y));
+    Z.Add(static_cast<float>(Position.Z));
+}
+
+void FProximityPositions::Append(TConstArrayView<FVector> Positions)
+{
+    X.Reserve(X.Num() + Positions.Num());
+    Y.Reserve(Y.Num() + Positions.Num());
+    Z.Reserve(Z.Num() + Positions.Num());
+    for (const FVector& Position : Positions)
+    {
+        Add(Position);
+    }
+}
+
+namespace
+{
+    // 4个候选到原点的平方距离
+    FORCEINLINE VectorRegister4Float DistSquared4(const FProximityPositions& Positions, int32 Index,
+        const VectorRegister4Float& OriginX, const VectorRegister4Float& OriginY, const VectorRegister4Float& OriginZ)
+    {
+        const VectorRegister4Float DX = VectorSubtract(VectorLoad(Positions.X.GetData() + Index), OriginX);
+        const VectorRegister4Float DY = VectorSubtract(VectorLoad(Positions.Y.GetData() + Index), OriginY);
+        const VectorRegister4Float DZ = VectorSubtract(VectorLoad(Positions.Z.GetData() + Index), OriginZ);
+        return VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+    }
+
+    FORCEINLINE float DistSquared1(const FProximityPositions& Positions, int32 Index, const FVector3f& Origin)
+    {
+        const float DX = Positions.X[Index] - Origin.X;
+        const float DY = Positions.Y[Index] - Origin.Y;
+        const float DZ = Positions.Z[Index] - Origin.Z;
+        return DX * DX + DY * DY + DZ * DZ;
+    }
+
+    // 上限放宽一个ulp，之后一律用严格小于比较：距离相同时保留先出现（索引最小）的候选，恰好等于上限的仍然算在范围内
+    FORCEINLINE float NearestSearchLimit(float MaxDistSquared)
+    {
+        return std::nextafter(MaxDistSquared, std::numeric_limits<float>::infinity());
+    }
+}
+
+void FProximityKernels::DistSquaredBatch(const FVector& Origin, const FProximityPositions& Positions, float* OutDistSquared)
+{
+    const FVector3f Origin3f(Origin);
+    const VectorRegister4Float OriginX = VectorSetFloat1(Origin3f.X);
+    const VectorRegister4Float OriginY = VectorSetFloat1(Origin3f.Y);
+    const VectorRegister4Float OriginZ = VectorSetFloat1(Origin3f.Z);
+
+    const int32 Num = Positions.Num();
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        VectorStore(DistSquared4(Positions, Index, OriginX, OriginY, OriginZ), OutDistSquared + Index);
+    }
+    for (; Index < Num; ++Index)
+    {
+        OutDistSquared[Index] = DistSquared1(Positions, Index, Origin3f);
+    }
+}
+
+int32 FProximityKernels::FindNearest(const FVector& Origin, const FProximityPositions& Positions, float MaxDistSquared, float& OutDistSquared)
+{
+    const FVector3f Origin3f(Origin);
+    const VectorRegister4Float OriginX = VectorSetFloat1(Origin3f.X);
+    const VectorRegister4Float OriginY = VectorSetFloat1(Origin3f.Y);
+    const VectorRegister4Float OriginZ = VectorSetFloat1(Origin3f.Z);
+    const VectorRegister4Float Four = VectorSetFloat1(4.0f);
+    const VectorRegister4Float Eight = VectorSetFloat1(8.0f);
+
+    // 两组独立的累加器，每轮处理8个候选；索引用浮点保存（2^24以内精确）
+    // 每个通道的索引递增，严格小于时通道内保留最早的候选
+    const float Limit = NearestSearchLimit(MaxDistSquared);
+    VectorRegister4Float BestDistA = VectorSetFloat1(Limit);
+    VectorRegister4Float BestDistB = BestDistA;
+    VectorRegister4Float BestIndexA = VectorSetFloat1(-1.0f);
+    VectorRegister4Float BestIndexB = BestIndexA;
+    VectorRegister4Float LaneIndexA = MakeVectorRegisterFloat(0.0f, 1.0f, 2.0f, 3.0f);
+    VectorRegister4Float LaneIndexB = VectorAdd(LaneIndexA, Four);
+
+    const int32 Num = Positions.Num();
+    int32 Index = 0;
+    for (; Index + 8 <= Num; Index += 8)
+    {
+        const VectorRegister4Float DistA = DistSquared4(Positions, Index, OriginX, OriginY, OriginZ);
+        const VectorRegister4Float DistB = DistSquared4(Positions, Index + 4, OriginX, OriginY, OriginZ);
+
+        // 掩码选出更近的通道
+        const VectorRegister4Float MaskA = VectorCompareLT(DistA, BestDistA);
+        const VectorRegister4Float MaskB = VectorCompareLT(DistB, BestDistB);
+        BestDistA = VectorSelect(MaskA, DistA, BestDistA);
+        BestDistB = VectorSelect(MaskB, DistB, BestDistB);
+        BestIndexA = VectorSelect(MaskA, LaneIndexA, BestIndexA);
+        BestIndexB = VectorSelect(MaskB, LaneIndexB, BestIndexB);
+
+        LaneIndexA = VectorAdd(LaneIndexA, Eight);
+        LaneIndexB = VectorAdd(LaneIndexB, Eight);
+    }
+    if (Index + 4 <= Num)
+    {
+        const VectorRegister4Float DistA = DistSquared4(Positions, Index, OriginX, OriginY, OriginZ);
+        const VectorRegister4Float MaskA = VectorCompareLT(DistA, BestDistA);
+        BestDistA = VectorSelect(MaskA, DistA, BestDistA);
+        BestIndexA = VectorSelect(MaskA, LaneIndexA, BestIndexA);
+        Index += 4;
+    }
+
+    // 8个通道归约：距离相同时取索引最小的通道，不按通道顺序
+    alignas(16) float LaneDist[8];
+    alignas(16) float LaneIndex[8];
+    VectorStoreAligned(BestDistA, LaneDist);
+    VectorStoreAligned(BestDistB, LaneDist + 4);
+    VectorStoreAligned(BestIndexA, LaneIndex);
+    VectorStoreAligned(BestIndexB, LaneIndex + 4);
+
+    int32 BestIndex = INDEX_NONE;
+    float BestDist = Limit;
+    for (int32 Lane = 0; Lane < 8; ++Lane)
+    {
+        if (LaneIndex[Lane] < 0.0f)
+        {
+            continue;
+        }
+
+        const int32 CandidateIndex = static_cast<int32>(LaneIndex[Lane]);
+        if (LaneDist[Lane] < BestDist || (LaneDist[Lane] == BestDist && CandidateIndex < BestIndex))
+        {
+            BestDist = LaneDist[Lane];
+            BestIndex = CandidateIndex;
+        }
+    }
+
+    // 尾部的索引都比通道里的大，严格小于才替换
+    for (; Index < Num; ++Index)
+    {
+        const float Dist = DistSquared1(Positions, Index, Origin3f);
+        if (Dist < BestDist)
+        {
+            BestDist = Dist;
+            BestIndex = Index;
+        }
+    }
+
+    OutDistSquared = BestIndex != INDEX_NONE ? BestDist : MaxDistSquared;
+    return BestIndex;
+}
+
+int32 FProximityKernels::FilterInRange(const FVector& Origin, const FProximityPositions& Positions, float RangeSquared, TArray<int32>& OutIndices)
+{
+    const FVector3f Origin3f(Origin);
+    const VectorRegister4Float OriginX = VectorSetFloat1(Origin3f.X);
+    const VectorRegister4Float OriginY = VectorSetFloat1(Origin3f.Y);
+    const VectorRegister4Float OriginZ = VectorSetFloat1(Origin3f.Z);
+    const VectorRegister4Float Range = VectorSetFloat1(RangeSquared);
+
+    const int32 StartNum = OutIndices.Num();
+    const int32 Num = Positions.Num();
+    int32 Index = 0;
+    for (; Index + 8 <= Num; Index += 8)
+    {
+        // 8个候选的范围判断合成一个8位掩码
+        const int32 MaskA = VectorMaskBits(VectorCompareLE(DistSquared4(Positions, Index, OriginX, OriginY, OriginZ), Range));
+        const int32 MaskB = VectorMaskBits(VectorCompareLE(DistSquared4(Positions, Index + 4, OriginX, OriginY, OriginZ), Range));
+        uint32 Mask = static_cast<uint32>(MaskA | (MaskB << 4));
+        while (Mask)
+        {
+            OutIndices.Add(Index + static_cast<int32>(FMath::CountTrailingZeros(Mask)));
+            Mask &= Mask - 1;
+        }
+    }
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        uint32 Mask = static_cast<uint32>(VectorMaskBits(VectorCompareLE(DistSquared4(Positions, Index, OriginX, OriginY, OriginZ), Range)));
+        while (Mask)
+        {
+            OutIndices.Add(Index + static_cast<int32>(FMath::CountTrailingZeros(Mask)));
+            Mask &= Mask - 1;
+        }
+    }
+    for (; Index < Num; ++Index)
+    {
+        if (DistSquared1(Positions, Index, Origin3f) <= RangeSquared)
+        {
+            OutIndices.Add(Index);
+        }
+    }
+
+    return OutIndices.Num() - StartNum;
+}
+
+int32 FProximityKernels::FindNearestScalar(const FVector& Origin, const FProximityPositions& Positions, float MaxDistSquared, float& OutDistSquared)
+{
+    const FVector3f Origin3f(Origin);
+    int32 BestIndex = INDEX_NONE;
+    float BestDist = NearestSearchLimit(MaxDistSquared);
+    for (int32 Index = 0; Index < Positions.Num(); ++Index)
+    {
+        const float Dist = DistSquared1(Positions, Index, Origin3f);
+        if (Dist < BestDist)
+        {
+            BestDist = Dist;
+            BestIndex = Index;
+        }
+    }
+
+    OutDistSquared = BestIndex != INDEX_NONE ? BestDist : MaxDistSquared;
+    return BestIndex;
+}
+
+int32 FProximityKernels::FilterInRangeScalar(const FVector& Origin, const FProximityPositions& Positions, float RangeSquared, TArray<int32>& OutIndices)
+{
+    const FVector3f Origin3f(Origin);
+    const int32 StartNum = OutIndices.Num();
+    for (int32 Index = 0; Index < Positions.Num(); ++Index)
+    {
+        if (DistSquared1(Positions, Index, Origin3f) <= RangeSquared)
+        {
+            OutIndices.Add(Index);
+        }
+    }
+    return OutIndices.Num() - StartNum;
+}
+
+void FProximityKernels::RunBenchmark(int32 Iterations)
+{
+    const int32 Counts[] = { 100, 1000, 10000 };
+    const float WorldExtent = 10000.0f;
+    const float RangeSquared = FMath::Square(1500.0f);
+    Iterations = FMath::Max(1, Iterations);
+
+    FRandomStream Random(12345);
+    UE_LOG(LogTemp, Warning, TEXT("======= 距离计算微基准 (%d 次迭代) ======="), Iterations);
+
+    for (const int32 Count : Counts)
+    {
+        FProximityPositions Positions;
+        Positions.Reset(Count);
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            Positions.Add(FVector(Random.FRandRange(-WorldExtent, WorldExtent), Random.FRandRange(-WorldExtent, WorldExtent), Random.FRandRange(0.0f, 500.0f)));
+        }
+
+        // 原来的写法：逐对FVector::Distance（含开方）
+        TArray<FVector> AoSPositions;
+        AoSPositions.Reserve(Count);
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            AoSPositions.Add(Positions.Get(Index));
+        }
+
+        const FVector Origin(Random.FRandRange(-WorldExtent, WorldExtent), Random.FRandRange(-WorldExtent, WorldExtent), 0.0f);
+        TArray<int32> InRange;
+        InRange.Reserve(Count);
+        int32 Checksum = 0;
+        float Dist = 0.0f;
+
+        double StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            float ClosestDistance = FMath::Sqrt(RangeSquared);
+            int32 ClosestIndex = INDEX_NONE;
+            for (int32 Index = 0; Index < Count; ++Index)
+            {
+                const float Distance = FVector::Distance(Origin, AoSPositions[Index]);
+                if (Distance <= ClosestDistance)
+                {
+                    ClosestDistance = Distance;
+                    ClosestIndex = Index;
+                }
+            }
+            Checksum += ClosestIndex;
+        }
+        const double LegacyNearest = FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            Checksum += FindNearestScalar(Origin, Positions, RangeSquared, Dist);
+        }
+        const double ScalarNearest = FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            Checksum += FindNearest(Origin, Positions, RangeSquared, Dist);
+        }
+        const double SimdNearest = FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            InRange.Reset();
+            Checksum += FilterInRangeScalar(Origin, Positions, RangeSquared, InRange);
+        }
+        const double ScalarFilter = FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            InRange.Reset();
+            Checksum += FilterInRange(Origin, Positions, RangeSquared, InRange);
+        }
+        const double SimdFilter = FPlatformTime::Seconds() - StartTime;
+
+        // 校验两种实现结果一致
+        float ScalarDist = 0.0f;
+        float SimdDist = 0.0f;
+        const bool bNearestMatch = FindNearestScalar(Origin, Positions, RangeSquared, ScalarDist) == FindNearest(Origin, Positions, RangeSquared, SimdDist);
+        TArray<int32> ScalarInRange;
+        TArray<int32> SimdInRange;
+        FilterInRangeScalar(Origin, Positions, RangeSquared, ScalarInRange);
+        FilterInRange(Origin, Positions, RangeSquared, SimdInRange);
+        const bool bFilterMatch = ScalarInRange == SimdInRange;
+
+        const double NsPerEntity = 1.0e9 / (static_cast<double>(Iterations) * Count);
+        UE_LOG(LogTemp, Warning, TEXT("[%5d 个] 最近目标 Distance逐对: %.2f ns  标量平方: %.2f ns  向量化: %.2f ns (%.1fx) 结果一致: %s"),
+            Count, LegacyNearest * NsPerEntity, ScalarNearest * NsPerEntity, SimdNearest * NsPerEntity,
+            SimdNearest > 0.0 ? LegacyNearest / SimdNearest : 0.0, bNearestMatch ? TEXT("是") : TEXT("否"));
+        UE_LOG(LogTemp, Warning, TEXT("[%5d 个] 范围筛选 标量: %.2f ns  向量化: %.2f ns (%.1fx) 结果一致: %s (校验和 %d)"),
+            Count, ScalarFilter * NsPerEntity, SimdFilter * NsPerEntity,
+            SimdFilter > 0.0 ? ScalarFilter / SimdFilter : 0.0, bFilterMatch ? TEXT("是") : TEXT("否"), Checksum);
+    }
+}
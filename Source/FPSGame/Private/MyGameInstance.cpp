@@ -1,128 +1,460 @@
-#include "MyGameInstance.h"
-#include "Kismet/GameplayStatics.h"
-#include "OnlineSessionSettings.h"
-#include "OnlineSubsystemTypes.h" 
-#include "Online/OnlineSessionNames.h"
-#include "Interfaces/OnlineSessionInterface.h"
-
-UMyGameInstance::UMyGameInstance()
-{
-    SessionName = FName("FPSGameSession");
-}
-
-void UMyGameInstance::CreateSession(int32 NumPublicConnections, bool bUseLAN)
-{
-    SessionInterface = IOnlineSubsystem::Get()->GetSessionInterface();
-
-    if (SessionInterface.IsValid())
-    {
-        FOnlineSessionSettings SessionSettings;
-
-        // 设置会话为LAN或在线
-        if (IOnlineSubsystem::Get()->GetSubsystemName() == "NULL")
-        {
-            SessionSettings.bIsLANMatch = true;
-        }
-        else
-        {
-            SessionSettings.bIsLANMatch = bUseLAN;
-        }
-
-        SessionSettings.NumPublicConnections = NumPublicConnections;
-        SessionSettings.bShouldAdvertise = true;
-        SessionSettings.bAllowJoinInProgress = true;
-        SessionSettings.bUsesPresence = true;
-        SessionSettings.bUseLobbiesIfAvailable = true;
-
-        // 设置地图名称
-        SessionSettings.Set(FName("MapName"), FString("FirstPersonMap"), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-
-        SessionInterface->CreateSession(0, SessionName, SessionSettings);
-        SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnCreateSessionComplete));
-    }
-}
-
-void UMyGameInstance::FindSessions(bool bUseLAN)
-{
-    SessionInterface = IOnlineSubsystem::Get()->GetSessionInterface();
-
-    if (SessionInterface.IsValid())
-    {
-        SessionSearch = MakeShareable(new FOnlineSessionSearch());
-        SessionSearch->bIsLanQuery = bUseLAN;
-        SessionSearch->MaxSearchResults = 10000;
-        FOnlineSearchSettings& SearchSettings = SessionSearch->QuerySettings;
-        SearchSettings.Set(FName(TEXT("GAMEMODE")), FString("FreeForAll"), EOnlineComparisonOp::Equals);
-        //SessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
-
-        UE_LOG(LogTemp, Warning, TEXT("开始查找会话..."));
-        SessionInterface->FindSessions(0, SessionSearch.ToSharedRef());
-        SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnFindSessionsComplete));
-    }
-}
-
-void UMyGameInstance::JoinSessionByIndex(int32 SessionIndex)
-{
-    if (!SessionInterface.IsValid() || !SessionSearch.IsValid() || SessionIndex >= SessionSearch->SearchResults.Num())
-        return;
-
-    SessionInterface->JoinSession(0, SessionName, SessionSearch->SearchResults[SessionIndex]);
-    SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnJoinSessionComplete));
-}
-
-void UMyGameInstance::DestroySession()
-{
-    if (SessionInterface.IsValid())
-    {
-        SessionInterface->DestroySession(SessionName);
-        SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(FOnDestroySessionCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnDestroySessionComplete));
-    }
-}
-
-void UMyGameInstance::OnCreateSessionComplete(FName InSessionName, bool bWasSuccessful)
-{
-    FString ResultString = bWasSuccessful ? FString(TEXT("成功")) : FString(TEXT("失败"));
-    UE_LOG(LogTemp, Warning, TEXT("会话创建 %s"), *ResultString);
-
-    if (bWasSuccessful)
-    {
-        // 旅行到游戏地图
-        UWorld* World = GetWorld();
-        if (World)
-        {
-            World->ServerTravel("/Game/FirstPerson/Maps/FirstPersonMap?listen");
-        }
-    }
-}
-
-void UMyGameInstance::OnFindSessionsComplete(bool bWasSuccessful)
-{
-    FString ResultString = FString(TEXT("成功"));
-    UE_LOG(LogTemp, Warning, TEXT("查找会话 %s，找到 %d 个会话"),
-        *ResultString, SessionSearch->SearchResults.Num());
-
-    // 可以在这里更新UI显示找到的会话
-}
-
-void UMyGameInstance::OnJoinSessionComplete(FName InSessionName, EOnJoinSessionCompleteResult::Type Result)
-{
-    UE_LOG(LogTemp, Warning, TEXT("加入会话结果: %d"), Result);
-
-    if (Result == EOnJoinSessionCompleteResult::Success)
-    {
-        APlayerController* PlayerController = GetFirstLocalPlayerController();
-        FString ConnectString;
-
-        if (SessionInterface.IsValid() && SessionInterface->GetResolvedConnectString(InSessionName, ConnectString))
-        {
-            UE_LOG(LogTemp, Warning, TEXT("连接字符串: %s"), *ConnectString);
-            PlayerController->ClientTravel(ConnectString, ETravelType::TRAVEL_Absolute);
-        }
-    }
-}
-
-void UMyGameInstance::OnDestroySessionComplete(FName InSessionName, bool bWasSuccessful)
-{
-    FString ResultString = bWasSuccessful ? FString(TEXT("成功")) : FString(TEXT("失败"));
-    UE_LOG(LogTemp, Warning, TEXT("会话销毁 %s"), *ResultString);
-}
\ No newline at end of file
+#include "MyGameInstance.h"
+#include "Kismet/GameplayStatics.h"
+#include "OnlineSessionSettings.h"
+#include "OnlineSubsystemTypes.h"
+#include "Online/OnlineSessionNames.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "Match/MatchFlowSubsystem.h"
+#include "Character/CharacterSignificanceSubsystem.h"
+#include "Audio/WeaponAudioSubsystem.h"
+#include "Net/HitRegistrationBenchSubsystem.h"
+#include "Net/FPSIpNetDriver.h"
+#include "Net/TimeSyncComponent.h"
+
+UMyGameInstance::UMyGameInstance()
+{
+    SessionName = FName("FPSGameSession");
+    MatchMapName = TEXT("/Game/FirstPerson/Maps/FirstPersonMap");
+
+    // 服务器列表参数
+    MaxSessionSearchResults = 50;   // 单次搜索最多返回的会话数
+    SessionCacheLifetime = 10.0f;   // 搜索结果缓存时间
+    DebugSessionPageSize = 10;      // 调试命令每页数量
+}
+
+void UMyGameInstance::Shutdown()
+{
+    // 退出前取消搜索并移除回调，避免回调到已销毁的实例
+    if (bSearchInProgress && SessionInterface.IsValid())
+    {
+        SessionInterface->CancelFindSessions();
+    }
+    ClearSessionDelegates();
+
+    Super::Shutdown();
+}
+
+IOnlineSessionPtr UMyGameInstance::GetSessionInterface()
+{
+    if (!SessionInterface.IsValid())
+    {
+        if (IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get())
+        {
+            SessionInterface = Subsystem->GetSessionInterface();
+        }
+    }
+    return SessionInterface;
+}
+
+bool UMyGameInstance::IsNullSubsystem() const
+{
+    IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
+    return Subsystem && Subsystem->GetSubsystemName() == "NULL";
+}
+
+bool UMyGameInstance::IsSearchCacheValid(bool bUseLAN) const
+{
+    return SessionSearch.IsValid()
+        && CachedSearchTime > 0.0
+        && bCachedSearchIsLAN == bUseLAN
+        && FPlatformTime::Seconds() - CachedSearchTime <= SessionCacheLifetime;
+}
+
+void UMyGameInstance::ClearSessionDelegates()
+{
+    if (!SessionInterface.IsValid())
+    {
+        return;
+    }
+
+    SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteHandle);
+    SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteHandle);
+    SessionInterface->ClearOnCancelFindSessionsCompleteDelegate_Handle(CancelFindSessionsCompleteHandle);
+    SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteHandle);
+    SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteHandle);
+}
+
+void UMyGameInstance::CreateSession(int32 NumPublicConnections, bool bUseLAN)
+{
+    if (!GetSessionInterface().IsValid())
+    {
+        UE_LOG(LogTemp, Error, TEXT("创建会话失败：没有可用的会话接口"));
+        return;
+    }
+
+    FOnlineSessionSettings SessionSettings;
+
+    // 设置会话为LAN或在线
+    if (IsNullSubsystem())
+    {
+        SessionSettings.bIsLANMatch = true;
+    }
+    else
+    {
+        SessionSettings.bIsLANMatch = bUseLAN;
+    }
+
+    SessionSettings.NumPublicConnections = NumPublicConnections;
+    SessionSettings.bShouldAdvertise = true;
+    SessionSettings.bAllowJoinInProgress = true;
+    SessionSettings.bUsesPresence = true;
+    SessionSettings.bUseLobbiesIfAvailable = true;
+
+    // 设置地图名称
+    SessionSettings.Set(FName("MapName"), FString("FirstPersonMap"), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
+    // 等待会话创建期间先预加载对局地图的资源
+    if (UMatchFlowSubsystem* MatchFlow = GetSubsystem<UMatchFlowSubsystem>())
+    {
+        MatchFlow->PreloadMap(MatchMapName);
+    }
+
+    // 先绑定回调再发起请求（Null子系统会同步触发回调）
+    SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteHandle);
+    CreateSessionCompleteHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(
+        FOnCreateSessionCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnCreateSessionComplete));
+
+    if (!SessionInterface->CreateSession(0, SessionName, SessionSettings))
+    {
+        SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteHandle);
+        UE_LOG(LogTemp, Error, TEXT("创建会话请求被拒绝"));
+    }
+}
+
+void UMyGameInstance::FindSessions(bool bUseLAN, bool bForceRefresh)
+{
+    if (!GetSessionInterface().IsValid())
+    {
+        UE_LOG(LogTemp, Error, TEXT("查找会话失败：没有可用的会话接口"));
+        return;
+    }
+
+    // Null子系统只支持LAN搜索
+    if (IsNullSubsystem())
+    {
+        bUseLAN = true;
+    }
+
+    // 同一时间只允许一个搜索，结果到达时统一广播
+    if (bSearchInProgress)
+    {
+        UE_LOG(LogTemp, Log, TEXT("会话搜索进行中，忽略重复请求"));
+        return;
+    }
+
+    // 缓存未过期时直接返回缓存结果
+    if (!bForceRefresh && IsSearchCacheValid(bUseLAN))
+    {
+        UE_LOG(LogTemp, Log, TEXT("使用缓存的会话搜索结果：%d 个"), SessionSearch->SearchResults.Num());
+        OnSessionSearchUpdated.Broadcast(true, SessionSearch->SearchResults.Num());
+        return;
+    }
+
+    SessionSearch = MakeShareable(new FOnlineSessionSearch());
+    SessionSearch->bIsLanQuery = bUseLAN;
+    SessionSearch->MaxSearchResults = MaxSessionSearchResults;
+    FOnlineSearchSettings& SearchSettings = SessionSearch->QuerySettings;
+    SearchSettings.Set(FName(TEXT("GAMEMODE")), FString("FreeForAll"), EOnlineComparisonOp::Equals);
+    //SessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
+
+    bCachedSearchIsLAN = bUseLAN;
+    CachedSearchTime = 0.0;
+    bSearchInProgress = true;
+
+    SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteHandle);
+    FindSessionsCompleteHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(
+        FOnFindSessionsCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnFindSessionsComplete));
+
+    UE_LOG(LogTemp, Warning, TEXT("开始查找会话..."));
+    if (!SessionInterface->FindSessions(0, SessionSearch.ToSharedRef()))
+    {
+        SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteHandle);
+        bSearchInProgress = false;
+        UE_LOG(LogTemp, Error, TEXT("查找会话请求被拒绝"));
+        OnSessionSearchUpdated.Broadcast(false, 0);
+    }
+}
+
+void UMyGameInstance::CancelFindSessions()
+{
+    if (!bSearchInProgress || !SessionInterface.IsValid())
+    {
+        return;
+    }
+
+    // 不再接收本次搜索的结果，部分结果也不进入缓存
+    SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteHandle);
+    bSearchInProgress = false;
+    CachedSearchTime = 0.0;
+
+    SessionInterface->ClearOnCancelFindSessionsCompleteDelegate_Handle(CancelFindSessionsCompleteHandle);
+    CancelFindSessionsCompleteHandle = SessionInterface->AddOnCancelFindSessionsCompleteDelegate_Handle(
+        FOnCancelFindSessionsCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnCancelFindSessionsComplete));
+
+    if (!SessionInterface->CancelFindSessions())
+    {
+        SessionInterface->ClearOnCancelFindSessionsCompleteDelegate_Handle(CancelFindSessionsCompleteHandle);
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("已取消会话搜索"));
+}
+
+void UMyGameInstance::JoinSessionByIndex(int32 SessionIndex)
+{
+    if (!SessionInterface.IsValid() || !SessionSearch.IsValid() || !SessionSearch->SearchResults.IsValidIndex(SessionIndex))
+        return;
+
+    SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteHandle);
+    JoinSessionCompleteHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(
+        FOnJoinSessionCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnJoinSessionComplete));
+
+    if (!SessionInterface->JoinSession(0, SessionName, SessionSearch->SearchResults[SessionIndex]))
+    {
+        SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteHandle);
+        UE_LOG(LogTemp, Error, TEXT("加入会话请求被拒绝"));
+    }
+}
+
+void UMyGameInstance::DestroySession()
+{
+    if (SessionInterface.IsValid())
+    {
+        SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteHandle);
+        DestroySessionCompleteHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
+            FOnDestroySessionCompleteDelegate::CreateUObject(this, &UMyGameInstance::OnDestroySessionComplete));
+
+        if (!SessionInterface->DestroySession(SessionName))
+        {
+            SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteHandle);
+        }
+    }
+}
+
+int32 UMyGameInstance::GetNumSessionResults() const
+{
+    return SessionSearch.IsValid() ? SessionSearch->SearchResults.Num() : 0;
+}
+
+int32 UMyGameInstance::GetSessionPage(int32 PageIndex, int32 PageSize, TArray<FSessionBrowserEntry>& OutEntries) const
+{
+    OutEntries.Reset();
+
+    const int32 NumResults = GetNumSessionResults();
+    if (NumResults == 0 || PageIndex < 0 || PageSize <= 0)
+    {
+        return NumResults;
+    }
+
+    // 只为当前页生成条目，不额外保存整份结果的副本
+    const int32 First = PageIndex * PageSize;
+    const int32 Last = FMath::Min(First + PageSize, NumResults);
+    OutEntries.Reserve(FMath::Max(0, Last - First));
+
+    for (int32 Index = First; Index < Last; ++Index)
+    {
+        const FOnlineSessionSearchResult& Result = SessionSearch->SearchResults[Index];
+        if (!Result.IsValid())
+        {
+            continue;
+        }
+
+        FSessionBrowserEntry& Entry = OutEntries.AddDefaulted_GetRef();
+        Entry.ResultIndex = Index;
+        Entry.OwnerName = Result.Session.OwningUserName;
+        Result.Session.SessionSettings.Get(FName("MapName"), Entry.MapName);
+        Entry.PingInMs = Result.PingInMs;
+        Entry.MaxConnections = Result.Session.SessionSettings.NumPublicConnections;
+        Entry.OpenConnections = Result.Session.NumOpenPublicConnections;
+    }
+
+    return NumResults;
+}
+
+void UMyGameInstance::OnCreateSessionComplete(FName InSessionName, bool bWasSuccessful)
+{
+    if (SessionInterface.IsValid())
+    {
+        SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteHandle);
+    }
+
+    FString ResultString = bWasSuccessful ? FString(TEXT("成功")) : FString(TEXT("失败"));
+    UE_LOG(LogTemp, Warning, TEXT("会话创建 %s"), *ResultString);
+
+    if (bWasSuccessful)
+    {
+        // 旅行到游戏地图（由对局流程统计切图耗时，并使用已预加载的资源）
+        if (UMatchFlowSubsystem* MatchFlow = GetSubsystem<UMatchFlowSubsystem>())
+        {
+            MatchFlow->TravelToMap(MatchMapName, true);
+        }
+    }
+}
+
+void UMyGameInstance::OnFindSessionsComplete(bool bWasSuccessful)
+{
+    if (SessionInterface.IsValid())
+    {
+        SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteHandle);
+    }
+
+    bSearchInProgress = false;
+    const int32 NumResults = GetNumSessionResults();
+
+    // 只有成功的搜索才进入缓存
+    CachedSearchTime = bWasSuccessful ? FPlatformTime::Seconds() : 0.0;
+
+    FString ResultString = bWasSuccessful ? FString(TEXT("成功")) : FString(TEXT("失败"));
+    UE_LOG(LogTemp, Warning, TEXT("查找会话 %s，找到 %d 个会话"),
+        *ResultString, NumResults);
+
+    // 通知界面更新服务器列表
+    OnSessionSearchUpdated.Broadcast(bWasSuccessful, NumResults);
+}
+
+void UMyGameInstance::OnCancelFindSessionsComplete(bool bWasSuccessful)
+{
+    if (SessionInterface.IsValid())
+    {
+        SessionInterface->ClearOnCancelFindSessionsCompleteDelegate_Handle(CancelFindSessionsCompleteHandle);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("取消会话搜索 %s"), bWasSuccessful ? TEXT("成功") : TEXT("失败"));
+    OnSessionSearchUpdated.Broadcast(false, GetNumSessionResults());
+}
+
+void UMyGameInstance::OnJoinSessionComplete(FName InSessionName, EOnJoinSessionCompleteResult::Type Result)
+{
+    if (SessionInterface.IsValid())
+    {
+        SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteHandle);
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("加入会话结果: %d"), Result);
+
+    if (Result == EOnJoinSessionCompleteResult::Success)
+    {
+        APlayerController* PlayerController = GetFirstLocalPlayerController();
+        FString ConnectString;
+
+        if (PlayerController && SessionInterface.IsValid() && SessionInterface->GetResolvedConnectString(InSessionName, ConnectString))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("连接字符串: %s"), *ConnectString);
+            PlayerController->ClientTravel(ConnectString, ETravelType::TRAVEL_Absolute);
+        }
+    }
+}
+
+void UMyGameInstance::OnDestroySessionComplete(FName InSessionName, bool bWasSuccessful)
+{
+    if (SessionInterface.IsValid())
+    {
+        SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteHandle);
+    }
+
+    FString ResultString = bWasSuccessful ? FString(TEXT("成功")) : FString(TEXT("失败"));
+    UE_LOG(LogTemp, Warning, TEXT("会话销毁 %s"), *ResultString);
+}
+
+void UMyGameInstance::DebugFindSessions(bool bForceRefresh)
+{
+    UE_LOG(LogTemp, Warning, TEXT("=== 调试查找会话 (强制刷新: %s) ==="), bForceRefresh ? TEXT("是") : TEXT("否"));
+    FindSessions(false, bForceRefresh);
+
+    // 命中缓存或Null子系统同步完成时可以立即打印
+    if (!bSearchInProgress)
+    {
+        DebugSessionPage(0);
+    }
+}
+
+void UMyGameInstance::DebugSessionPage(int32 PageIndex)
+{
+    TArray<FSessionBrowserEntry> Entries;
+    const int32 NumResults = GetSessionPage(PageIndex, DebugSessionPageSize, Entries);
+
+    UE_LOG(LogTemp, Warning, TEXT("======= 会话列表 第%d页 (共 %d 个) ======="), PageIndex, NumResults);
+    for (const FSessionBrowserEntry& Entry : Entries)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("  [%d] %s 地图: %s 延迟: %dms 空位: %d/%d"),
+            Entry.ResultIndex, *Entry.OwnerName, *Entry.MapName,
+            Entry.PingInMs, Entry.OpenConnections, Entry.MaxConnections);
+    }
+}
+
+void UMyGameInstance::DebugSignificance()
+{
+    const UWorld* World = GetWorld();
+    const UCharacterSignificanceSubsystem* Significance = World ? World->GetSubsystem<UCharacterSignificanceSubsystem>() : nullptr;
+    if (!Significance)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("当前世界没有角色重要度服务（专用服务器不创建）"));
+        return;
+    }
+
+    Significance->DumpStats();
+}
+
+void UMyGameInstance::DebugWeaponAudio()
+{
+    const UWorld* World = GetWorld();
+    const UWeaponAudioSubsystem* WeaponAudio = World ? World->GetSubsystem<UWeaponAudioSubsystem>() : nullptr;
+    if (!WeaponAudio)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("当前世界没有武器音效服务（专用服务器不创建）"));
+        return;
+    }
+
+    WeaponAudio->DumpStats();
+}
+
+void UMyGameInstance::BenchHitReg(int32 NumBots, int32 ShotsPerProfile)
+{
+    UWorld* World = GetWorld();
+    UHitRegistrationBenchSubsystem* Bench = World ? World->GetSubsystem<UHitRegistrationBenchSubsystem>() : nullptr;
+    if (!Bench)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("当前世界没有命中判定基准"));
+        return;
+    }
+
+    Bench->StartBench(NumBots, ShotsPerProfile);
+}
+
+void UMyGameInstance::BenchHitRegBot()
+{
+    UWorld* World = GetWorld();
+    UHitRegistrationBenchSubsystem* Bench = World ? World->GetSubsystem<UHitRegistrationBenchSubsystem>() : nullptr;
+    if (!Bench)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("当前世界没有命中判定基准"));
+        return;
+    }
+
+    Bench->StartBot();
+}
+
+void UMyGameInstance::DebugNetAccounting()
+{
+    const UWorld* World = GetWorld();
+    const UFPSIpNetDriver* NetDriver = World ? Cast<UFPSIpNetDriver>(World->GetNetDriver()) : nullptr;
+    if (!NetDriver)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("当前没有使用FPSIpNetDriver的网络连接"));
+        return;
+    }
+
+    NetDriver->DumpAccounting();
+}
+
+void UMyGameInstance::DebugTimeSync()
+{
+    const UWorld* World = GetWorld();
+    const UTimeSyncComponent* TimeSync = World ? UTimeSyncComponent::Get(World->GetFirstPlayerController()) : nullptr;
+    if (!TimeSync)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("本机玩家还没有时间同步组件"));
+        return;
+    }
+
+    TimeSync->DumpStats();
+}
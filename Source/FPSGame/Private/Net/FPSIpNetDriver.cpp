@@ -0,0 +1,501 @@
+#include "Net/FPSIpNetDriver.h"
+#include "Character/EnemyCharacter.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/CoreNet.h"
+#include "UObject/UnrealType.h"
+
+namespace
+{
+    // 估算值：RPC的Bunch头和函数句柄、对象引用的NetGUID、属性句柄
+    constexpr int64 RpcHeaderBits = 48;
+    constexpr int64 ObjectReferenceBits = 32;
+    constexpr int32 PropertyHeaderBits = 8;
+
+    // 遥测每隔这么多秒写一次文件
+    constexpr int32 TelemetryFlushSeconds = 10;
+
+    // 连接最低往返基准每秒上浮的量（秒）
+    constexpr float RttBaselineDriftPerSecond = 0.002f;
+
+    bool ReadTrackedValue(const FProperty* Property, const AActor* Actor, double& OutValue)
+    {
+        const void* ValuePtr = Property->ContainerPtrToValuePtr<void>(Actor);
+        if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+        {
+            OutValue = BoolProperty->GetPropertyValue(ValuePtr) ? 1.0 : 0.0;
+            return true;
+        }
+        if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+        {
+            OutValue = NumericProperty->IsFloatingPoint()
+                ? NumericProperty->GetFloatingPointPropertyValue(ValuePtr)
+                : static_cast<double>(NumericProperty->GetSignedIntPropertyValue(ValuePtr));
+            return true;
+        }
+        return false;
+    }
+}
+
+void UFPSIpNetDriver::ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject)
+{
+    if (bEnableAccounting && Actor && Function)
+    {
+        const int64 Bits = EstimateRpcBits(Function, Parameters);
+        const FName Category = Function->GetFName();
+
+        if (Function->HasAnyFunctionFlags(FUNC_NetMulticast))
+        {
+            // 旧复制路径只发给已经打开这个Actor通道的连接；Iris的过滤在发送时才决定，按所有连接计
+            const bool bUseChannels = !IsUsingIrisReplication();
+            for (UNetConnection* Connection : ClientConnections)
+            {
+                if (Connection && (!bUseChannels || Connection->FindActorChannelRef(Actor)))
+                {
+                    Record(Connection, Category, Bits);
+                }
+            }
+        }
+        else if (UNetConnection* Connection = Actor->GetNetConnection())
+        {
+            Record(Connection, Category, Bits);
+        }
+    }
+
+    Super::ProcessRemoteFunction(Actor, Function, Parameters, OutParms, Stack, SubObject);
+}
+
+int64 UFPSIpNetDriver::EstimateRpcBits(UFunction* Function, void* Parameters) const
+{
+    // 只序列化不依赖PackageMap的参数，对象引用按NetGUID的大小计，避免统计时分配GUID
+    FNetBitWriter Writer(nullptr, 1024);
+    int64 Bits = RpcHeaderBits;
+
+    for (TFieldIterator<FProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It)
+    {
+        const FProperty* Property = *It;
+        const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+        const bool bCanSerialize = Property->IsA<FNumericProperty>() || Property->IsA<FBoolProperty>() || Property->IsA<FEnumProperty>()
+            || Property->IsA<FStrProperty>() || Property->IsA<FNameProperty>()
+            || (StructProperty && (StructProperty->Struct->StructFlags & STRUCT_NetSerializeNative));
+
+        for (int32 Index = 0; Index < Property->ArrayDim; ++Index)
+        {
+            if (Property->IsA<FObjectPropertyBase>() || Property->IsA<FInterfaceProperty>())
+            {
+                Bits += ObjectReferenceBits;
+            }
+            else if (bCanSerialize)
+            {
+                Property->NetSerializeItem(Writer, nullptr, Property->ContainerPtrToValuePtr<void>(Parameters, Index));
+            }
+            else
+            {
+                Bits += Property->GetElementSize() * 8;
+            }
+        }
+    }
+
+    return Bits + Writer.GetNumBits();
+}
+
+void UFPSIpNetDriver::Record(UNetConnection* Connection, FName Category, int64 Bits)
+{
+    FConnectionAccounting& Accounting = Connections.FindOrAdd(Connection);
+    if (Accounting.Name.IsEmpty())
+    {
+        Accounting.Name = Connection->PlayerController
+            ? FString::Printf(TEXT("%u:%s"), Connection->GetConnectionId(), *Connection->PlayerController->GetName())
+            : FString::Printf(TEXT("%u:%s"), Connection->GetConnectionId(), *Connection->LowLevelGetRemoteAddress(true));
+    }
+
+    FCategoryStats& Stats = Accounting.Current.FindOrAdd(Category);
+    ++Stats.Calls;
+    Stats.Bits += Bits;
+}
+
+void UFPSIpNetDriver::ResolveTrackedProperties()
+{
+    bPropertiesResolved = true;
+    ResolvedProperties.Reset();
+
+    for (const FString& Entry : TrackedProperties)
+    {
+        FString ClassName;
+        FString PropertyName;
+        if (!Entry.Split(TEXT("."), &ClassName, &PropertyName))
+        {
+            continue;
+        }
+
+        UClass* Class = FindObject<UClass>(nullptr, *FString::Printf(TEXT("/Script/FPSGame.%s"), *ClassName));
+        FProperty* Property = Class ? FindFProperty<FProperty>(Class, *PropertyName) : nullptr;
+        if (!Property || !(Property->IsA<FNumericProperty>() || Property->IsA<FBoolProperty>()))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("网络统计: 找不到可跟踪的属性 %s"), *Entry);
+            continue;
+        }
+
+        FTrackedProperty& Tracked = ResolvedProperties.AddDefaulted_GetRef();
+        Tracked.Class = Class;
+        Tracked.Property = Property;
+        Tracked.Category = FName(*Entry);
+        Tracked.EstimatedBits = PropertyHeaderBits + (Property->IsA<FBoolProperty>() ? 1 : Property->GetElementSize() * 8);
+    }
+}
+
+void UFPSIpNetDriver::AccountPropertyChanges()
+{
+    if (!bPropertiesResolved)
+    {
+        ResolveTrackedProperties();
+    }
+
+    UWorld* NetWorld = GetWorld();
+    if (!NetWorld || ResolvedProperties.IsEmpty())
+    {
+        return;
+    }
+
+    const bool bUseChannels = !IsUsingIrisReplication();
+
+    for (int32 PropertyIndex = 0; PropertyIndex < ResolvedProperties.Num(); ++PropertyIndex)
+    {
+        const FTrackedProperty& Tracked = ResolvedProperties[PropertyIndex];
+        UClass* Class = Tracked.Class.Get();
+        if (!Class)
+        {
+            continue;
+        }
+
+        for (TActorIterator<AActor> It(NetWorld, Class); It; ++It)
+        {
+            AActor* Actor = *It;
+            double Value = 0.0;
+            if (!Actor->GetIsReplicated() || !ReadTrackedValue(Tracked.Property, Actor, Value))
+            {
+                continue;
+            }
+
+            TArray<double, TInlineAllocator<4>>& Shadow = PropertyShadows.FindOrAdd(Actor);
+            if (Shadow.Num() != ResolvedProperties.Num())
+            {
+                Shadow.Init(NAN, ResolvedProperties.Num());
+            }
+
+            // 第一次看到时只记录（初始复制不计入）
+            const double Previous = Shadow[PropertyIndex];
+            Shadow[PropertyIndex] = Value;
+            if (FMath::IsNaN(Previous) || Previous == Value)
+            {
+                continue;
+            }
+
+            for (UNetConnection* Connection : ClientConnections)
+            {
+                if (Connection && (!bUseChannels || Connection->FindActorChannelRef(Actor)))
+                {
+                    Record(Connection, Tracked.Category, Tracked.EstimatedBits);
+                }
+            }
+        }
+    }
+}
+
+void UFPSIpNetDriver::TickFlush(float DeltaSeconds)
+{
+    Super::TickFlush(DeltaSeconds);
+
+    if (IsServer())
+    {
+        if (bEnableCongestionControl)
+        {
+            SampleSaturation();
+        }
+
+        // 属性在这一帧的复制之后比较，变化的值会在这一帧或之后发出
+        if (bEnableAccounting)
+        {
+            AccountPropertyChanges();
+        }
+    }
+
+    const double Now = GetElapsedTime();
+    if (SecondStartTime <= 0.0)
+    {
+        SecondStartTime = Now;
+        return;
+    }
+
+    const double Elapsed = Now - SecondStartTime;
+    if (Elapsed < 1.0)
+    {
+        return;
+    }
+    SecondStartTime = Now;
+
+    if (bEnableCongestionControl && IsServer())
+    {
+        UpdateCongestion();
+    }
+
+    if (bEnableAccounting)
+    {
+        FinishSecond(Now, Elapsed);
+    }
+}
+
+void UFPSIpNetDriver::SampleSaturation()
+{
+    for (UNetConnection* Connection : ClientConnections)
+    {
+        if (Connection)
+        {
+            FCongestionState& State = CongestionStates.FindOrAdd(Connection);
+            ++State.Frames;
+            State.SaturatedFrames += Connection->IsNetReady(false) ? 0 : 1;
+        }
+    }
+}
+
+void UFPSIpNetDriver::UpdateCongestion()
+{
+    // 近处威胁按敌人位置统计，每秒收集一次
+    TArray<FVector> EnemyLocations;
+    if (UWorld* NetWorld = GetWorld())
+    {
+        for (TActorIterator<AEnemyCharacter> It(NetWorld); It; ++It)
+        {
+            EnemyLocations.Add(It->GetActorLocation());
+        }
+    }
+
+    for (auto It = CongestionStates.CreateIterator(); It; ++It)
+    {
+        UNetConnection* Connection = It.Key().ResolveObjectPtr();
+        if (!Connection)
+        {
+            It.RemoveCurrent();
+            continue;
+        }
+
+        FCongestionState& State = It.Value();
+        // 第一次看到或客户端自己改了速率时以当前值为基准
+        if (Connection->CurrentNetSpeed != State.NetSpeed)
+        {
+            State.BaseNetSpeed = Connection->CurrentNetSpeed;
+            State.NetSpeed = Connection->CurrentNetSpeed;
+        }
+
+        State.Saturation = State.Frames > 0 ? static_cast<float>(State.SaturatedFrames) / State.Frames : 0.0f;
+        State.Loss = Connection->GetOutLossPercentage().GetAvgLossPercentage();
+        State.Frames = 0;
+        State.SaturatedFrames = 0;
+
+        // 最低往返作为这条链路不排队时的基准，缓慢上浮以适应路由变化
+        State.Rtt = Connection->AvgLag;
+        if (State.Rtt > 0.0f)
+        {
+            State.MinRtt = State.MinRtt > 0.0f ? FMath::Min(State.Rtt, State.MinRtt + RttBaselineDriftPerSecond) : State.Rtt;
+        }
+
+        // 丢包本身可能只是无线或跨网的随机丢包，只有同时饱和或往返上升（链路在排队）时才当作拥塞
+        const bool bSaturated = State.Saturation > SaturationThreshold;
+        const bool bRttRising = State.MinRtt > 0.0f && State.Rtt - State.MinRtt > RttRiseThreshold;
+        const bool bCongestedLoss = State.Loss > LossThreshold && (bSaturated || bRttRising);
+
+        // 拥塞时乘性降低低重要度Actor的优先级，恢复时线性回升
+        if (bSaturated || bCongestedLoss)
+        {
+            State.Throttle = FMath::Max(MinThrottle, State.Throttle * ThrottleDecrease);
+        }
+        else
+        {
+            State.Throttle = FMath::Min(1.0f, State.Throttle + ThrottleRecovery);
+        }
+
+        int32 NumNearThreats = 0;
+        const APlayerController* PlayerController = Connection->PlayerController;
+        if (const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+        {
+            const FVector PawnLocation = Pawn->GetActorLocation();
+            const float NearThreatDistanceSquared = FMath::Square(NearThreatDistance);
+            for (const FVector& EnemyLocation : EnemyLocations)
+            {
+                NumNearThreats += FVector::DistSquared(PawnLocation, EnemyLocation) <= NearThreatDistanceSquared ? 1 : 0;
+            }
+        }
+        State.NetSpeedFloor = FMath::Min(State.BaseNetSpeed, ComputeNetSpeedFloor(Connection, NumNearThreats));
+
+        // 拥塞丢包说明链路承载不了当前速率，降低发送上限让引擎按优先级取舍，但不低于必需流量
+        if (bCongestedLoss)
+        {
+            State.NetSpeed = FMath::Max(State.NetSpeedFloor, FMath::RoundToInt32(State.NetSpeed * ThrottleDecrease));
+        }
+        else if (!bSaturated && !bRttRising)
+        {
+            State.NetSpeed = FMath::Min(State.BaseNetSpeed, State.NetSpeed + NetSpeedRecovery);
+        }
+        State.NetSpeed = FMath::Max(State.NetSpeed, State.NetSpeedFloor);
+        Connection->CurrentNetSpeed = State.NetSpeed;
+    }
+}
+
+int32 UFPSIpNetDriver::ComputeNetSpeedFloor(const UNetConnection* Connection, int32 NumNearThreats) const
+{
+    // 每次网络帧都要发出本机Pawn和近处威胁的更新
+    double BytesPerSecond = static_cast<double>(PawnBytesPerUpdate + NumNearThreats * ThreatBytesPerUpdate) * GetNetServerMaxTickRate();
+
+    // 血量/分数按这一秒实际统计到的流量计
+    if (const FConnectionAccounting* Accounting = Connections.Find(Connection))
+    {
+        for (const FTrackedProperty& Tracked : ResolvedProperties)
+        {
+            if (const FCategoryStats* Stats = Accounting->Current.Find(Tracked.Category))
+            {
+                BytesPerSecond += Stats->Bits / 8.0;
+            }
+        }
+    }
+
+    return FMath::Max(MinNetSpeed, FMath::RoundToInt32(BytesPerSecond * NetSpeedFloorHeadroom));
+}
+
+float UFPSIpNetDriver::GetPriorityScale(const UNetConnection* Connection, float DistanceSquared) const
+{
+    if (!Connection || DistanceSquared <= FMath::Square(NearThreatDistance))
+    {
+        return 1.0f;
+    }
+
+    const FCongestionState* State = CongestionStates.Find(Connection);
+    return State ? State->Throttle : 1.0f;
+}
+
+bool UFPSIpNetDriver::IsCongested(const UNetConnection* Connection) const
+{
+    const FCongestionState* State = Connection ? CongestionStates.Find(Connection) : nullptr;
+    return State && State->Throttle < 1.0f;
+}
+
+void UFPSIpNetDriver::FinishSecond(double Now, double Elapsed)
+{
+    for (auto It = Connections.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().ResolveObjectPtr())
+        {
+            It.RemoveCurrent();
+            continue;
+        }
+
+        FConnectionAccounting& Accounting = It.Value();
+        for (const TPair<FName, FCategoryStats>& Pair : Accounting.Current)
+        {
+            const double BytesPerSecond = Pair.Value.Bits / 8.0 / Elapsed;
+            const double CallsPerSecond = Pair.Value.Calls / Elapsed;
+
+            if (bWriteTelemetry)
+            {
+                PendingTelemetry += FString::Printf(TEXT("%.1f,%s,%s,%.1f,%.0f\n"),
+                    Now, *Accounting.Name, *Pair.Key.ToString(), CallsPerSecond, BytesPerSecond);
+            }
+
+            const FNetAccountingBudget* Budget = Budgets.FindByPredicate([&Pair](const FNetAccountingBudget& Entry) { return Entry.Category == Pair.Key; });
+            const bool bOverBytes = Budget && Budget->MaxBytesPerSecond > 0 && BytesPerSecond > Budget->MaxBytesPerSecond;
+            const bool bOverCalls = Budget && Budget->MaxCallsPerSecond > 0 && CallsPerSecond > Budget->MaxCallsPerSecond;
+            if (!bOverBytes && !bOverCalls)
+            {
+                continue;
+            }
+
+            double& LastWarningTime = Accounting.LastWarningTime.FindOrAdd(Pair.Key, -BudgetWarningInterval);
+            if (Now - LastWarningTime >= BudgetWarningInterval)
+            {
+                LastWarningTime = Now;
+                UE_LOG(LogTemp, Warning, TEXT("网络预算超出: 连接 %s, %s 每秒 %.1f次/%.0f字节（预算 %d次/%d字节）"),
+                    *Accounting.Name, *Pair.Key.ToString(), CallsPerSecond, BytesPerSecond,
+                    Budget->MaxCallsPerSecond, Budget->MaxBytesPerSecond);
+            }
+        }
+
+        Accounting.LastSecond = MoveTemp(Accounting.Current);
+        Accounting.Current.Reset();
+    }
+
+    for (auto It = PropertyShadows.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().ResolveObjectPtr())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    if (++SecondsSinceTelemetryFlush >= TelemetryFlushSeconds)
+    {
+        FlushTelemetry();
+    }
+}
+
+void UFPSIpNetDriver::FlushTelemetry()
+{
+    SecondsSinceTelemetryFlush = 0;
+    if (PendingTelemetry.IsEmpty())
+    {
+        return;
+    }
+
+    if (TelemetryPath.IsEmpty())
+    {
+        TelemetryPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Telemetry"),
+            FString::Printf(TEXT("NetAccounting_%s_%s_%s.csv"), *NetDriverName.ToString(), IsServer() ? TEXT("Server") : TEXT("Client"), *FDateTime::Now().ToString()));
+        PendingTelemetry = TEXT("Time,Connection,Category,CallsPerSec,BytesPerSec\n") + PendingTelemetry;
+    }
+
+    FFileHelper::SaveStringToFile(PendingTelemetry, *TelemetryPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+    PendingTelemetry.Reset();
+}
+
+void UFPSIpNetDriver::Shutdown()
+{
+    FlushTelemetry();
+
+    Super::Shutdown();
+}
+
+void UFPSIpNetDriver::DumpAccounting() const
+{
+    UE_LOG(LogTemp, Warning, TEXT("网络统计(%s): %d个连接%s"), IsServer() ? TEXT("服务器") : TEXT("客户端"), Connections.Num(),
+        bEnableAccounting ? TEXT("") : TEXT("（统计未开启）"));
+
+    for (const TPair<TObjectKey<UNetConnection>, FConnectionAccounting>& Pair : Connections)
+    {
+        TArray<TPair<FName, FCategoryStats>> Sorted = Pair.Value.LastSecond.Array();
+        Sorted.Sort([](const TPair<FName, FCategoryStats>& A, const TPair<FName, FCategoryStats>& B) { return A.Value.Bits > B.Value.Bits; });
+
+        UE_LOG(LogTemp, Warning, TEXT("  连接 %s:"), *Pair.Value.Name);
+        for (const TPair<FName, FCategoryStats>& Entry : Sorted)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("    %-40s %4u次 %6llu字节"), *Entry.Key.ToString(), Entry.Value.Calls, Entry.Value.Bits / 8);
+        }
+    }
+
+    for (const TPair<TObjectKey<UNetConnection>, FCongestionState>& Pair : CongestionStates)
+    {
+        const UNetConnection* Connection = Pair.Key.ResolveObjectPtr();
+        if (!Connection)
+        {
+            continue;
+        }
+
+        const FCongestionState& State = Pair.Value;
+        UE_LOG(LogTemp, Warning, TEXT("  拥塞控制 %u: 饱和 %.0f%%, 丢包 %.1f%%, 往返 %.0f/%.0fms, 低重要度倍率 %.2f, 发送上限 %d/%d字节每秒（下限 %d）"),
+            Connection->GetConnectionId(), State.Saturation * 100.0f, State.Loss * 100.0f, State.Rtt * 1000.0f, State.MinRtt * 1000.0f,
+            State.Throttle, Connection->CurrentNetSpeed, State.BaseNetSpeed, State.NetSpeedFloor);
+    }
+}
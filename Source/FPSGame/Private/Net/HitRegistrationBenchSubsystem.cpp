@@ -0,0 +1,536 @@
+#include "Net/HitRegistrationBenchSubsystem.h"
+#include "Character/EnemyCharacter.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "FPSGame/FPSGameProjectile.h"
+#include "FPSGame/FPSGameWeaponComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+bool UHitRegistrationBenchSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UHitRegistrationBenchSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // 自动化测试按命令行区分角色：服务器录制，机器人客户端开火，完成后都退出进程
+    int32 NumBots = 0;
+    if (InWorld.GetNetMode() != NM_Client && FParse::Value(FCommandLine::Get(), TEXT("HitRegBench="), NumBots) && NumBots > 0)
+    {
+        bExitWhenDone = true;
+        StartBench(NumBots);
+    }
+    else if (InWorld.GetNetMode() == NM_Client && FParse::Param(FCommandLine::Get(), TEXT("HitRegBot")))
+    {
+        bExitWhenDone = true;
+        StartBot();
+    }
+}
+
+void UHitRegistrationBenchSubsystem::Deinitialize()
+{
+    // 服务器退出后客户端回到默认地图，机器人随之退出
+    if (State == EBenchState::Bot)
+    {
+        State = EBenchState::Idle;
+        if (bExitWhenDone)
+        {
+            FPlatformMisc::RequestExit(false);
+        }
+    }
+    else if (IsRunning())
+    {
+        StopBench();
+    }
+
+    Super::Deinitialize();
+}
+
+TStatId UHitRegistrationBenchSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UHitRegistrationBenchSubsystem, STATGROUP_Tickables);
+}
+
+void UHitRegistrationBenchSubsystem::StartBench(int32 NumBots, int32 InShotsPerProfile)
+{
+#if DO_ENABLE_NET_TEST
+    UWorld* World = GetWorld();
+    UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+    if (!NetDriver || !NetDriver->IsServer())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("命中判定基准只能在服务器上运行，机器人客户端使用 BenchHitRegBot"));
+        return;
+    }
+
+    if (Profiles.IsEmpty() || NumBots <= 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("命中判定基准没有配置网络模拟参数或机器人数量"));
+        return;
+    }
+
+    if (IsRunning())
+    {
+        StopBench();
+    }
+
+    SavedSettings = NetDriver->PacketSimulationSettings;
+    ExpectedBots = NumBots;
+    ShotsPerProfile = InShotsPerProfile > 0 ? InShotsPerProfile : DefaultShotsPerProfile;
+    Results.Reset();
+    RecordedShots.Reset();
+
+    State = EBenchState::WaitingForBots;
+    StateStartTime = World->GetRealTimeSeconds();
+
+    UE_LOG(LogTemp, Warning, TEXT("命中判定基准开始: 等待%d个机器人, %d组网络参数, 每个机器人每组%d发"), ExpectedBots, Profiles.Num(), ShotsPerProfile);
+#else
+    UE_LOG(LogTemp, Warning, TEXT("当前构建没有网络模拟（DO_ENABLE_NET_TEST），无法运行命中判定基准"));
+#endif
+}
+
+void UHitRegistrationBenchSubsystem::StopBench()
+{
+    if (!IsRunning() || State == EBenchState::Bot)
+    {
+        return;
+    }
+
+    // 中途结束时当前这组结果只保留已经结算的射击
+    if (Results.IsValidIndex(ProfileIndex) && State != EBenchState::WaitingForBots)
+    {
+        FinishProfile();
+    }
+
+    FinishBench();
+}
+
+void UHitRegistrationBenchSubsystem::StartBot()
+{
+    UWorld* World = GetWorld();
+    const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+    if (!NetDriver || !NetDriver->ServerConnection)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("命中判定机器人只能在连接到服务器的客户端上运行"));
+        return;
+    }
+
+    ShotStream.Initialize(Seed);
+    bAimed = false;
+    NextShotTime = 0.0;
+    State = EBenchState::Bot;
+
+    UE_LOG(LogTemp, Log, TEXT("命中判定机器人开始"));
+}
+
+float UHitRegistrationBenchSubsystem::GetEstimatedDuration() const
+{
+    const int32 Shots = ShotsPerProfile > 0 ? ShotsPerProfile : DefaultShotsPerProfile;
+    float Duration = BotConnectTimeout;
+    for (const FNetEmulationProfile& Profile : Profiles)
+    {
+        Duration += WarmupTime + Shots * ShotInterval + ShotTimeout + 2.0f * (Profile.LagMs + Profile.JitterMs) / 1000.0f;
+    }
+    return Duration;
+}
+
+void UHitRegistrationBenchSubsystem::BeginProfile(int32 Index)
+{
+    ProfileIndex = Index;
+    RecordedShots.Reset();
+
+    const FNetEmulationProfile& Profile = Profiles[Index];
+    ApplyProfile(Profile);
+
+    FProfileResult& Result = Results.AddDefaulted_GetRef();
+    Result.Name = Profile.Name;
+
+    State = EBenchState::Warmup;
+    StateStartTime = GetWorld()->GetRealTimeSeconds();
+
+    UE_LOG(LogTemp, Log, TEXT("命中判定基准: 参数 %s (延迟%dms 抖动%dms 丢包%d%%)"),
+        *Profile.Name, Profile.LagMs, Profile.JitterMs, Profile.LossPercent);
+}
+
+void UHitRegistrationBenchSubsystem::FinishProfile()
+{
+    // 还没结算的射击都算未命中
+    RecordedShots.Reset();
+
+    // 预热期间不统计流量，还没开始录制时时长为0
+    FProfileResult& Result = Results[ProfileIndex];
+    Result.Duration = State == EBenchState::Warmup ? 0.0 : GetWorld()->GetRealTimeSeconds() - RecordStartTime;
+
+    const float HitRate = Result.ClearShots > 0 ? static_cast<float>(Result.ClearHits) / Result.ClearShots : 0.0f;
+    const float MinHitRate = Profiles[ProfileIndex].MinHitRate;
+    Result.bPassed = Result.ClearShots >= MinClearShots && (MinHitRate <= 0.0f || HitRate >= MinHitRate);
+}
+
+void UHitRegistrationBenchSubsystem::FinishBench()
+{
+    State = EBenchState::Idle;
+    RestoreSettings();
+    WriteResults();
+
+    if (bExitWhenDone)
+    {
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+void UHitRegistrationBenchSubsystem::ApplyProfile(const FNetEmulationProfile& Profile)
+{
+#if DO_ENABLE_NET_TEST
+    UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+    if (!NetDriver)
+    {
+        return;
+    }
+
+    // 服务器的网络驱动会把参数同步到所有客户端连接，收发两个方向都模拟
+    FPacketSimulationSettings Settings = SavedSettings;
+    Settings.PktLagMin = FMath::Max(Profile.LagMs - Profile.JitterMs, 0);
+    Settings.PktLagMax = Profile.LagMs + Profile.JitterMs;
+    Settings.PktIncomingLagMin = Settings.PktLagMin;
+    Settings.PktIncomingLagMax = Settings.PktLagMax;
+    Settings.PktLoss = Profile.LossPercent;
+    Settings.PktIncomingLoss = Profile.LossPercent;
+    NetDriver->SetPacketSimulationSettings(Settings);
+#endif
+}
+
+void UHitRegistrationBenchSubsystem::RestoreSettings()
+{
+#if DO_ENABLE_NET_TEST
+    if (UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr)
+    {
+        NetDriver->SetPacketSimulationSettings(SavedSettings);
+    }
+#endif
+}
+
+int32 UHitRegistrationBenchSubsystem::GetNumConnectedBots() const
+{
+    int32 NumBots = 0;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController && !PlayerController->IsLocalController() && PlayerController->GetPawn())
+        {
+            ++NumBots;
+        }
+    }
+    return NumBots;
+}
+
+double UHitRegistrationBenchSubsystem::GetShotTimeout() const
+{
+    const FNetEmulationProfile& Profile = Profiles[ProfileIndex];
+    return ShotTimeout + 2.0 * (Profile.LagMs + Profile.JitterMs) / 1000.0;
+}
+
+void UHitRegistrationBenchSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (State == EBenchState::Bot)
+    {
+        TickBot();
+    }
+    else if (State != EBenchState::Idle)
+    {
+        TickServer(DeltaTime);
+    }
+}
+
+void UHitRegistrationBenchSubsystem::TickServer(float DeltaTime)
+{
+    UWorld* World = GetWorld();
+    const double Now = World->GetRealTimeSeconds();
+
+    if (State == EBenchState::WaitingForBots)
+    {
+        const int32 NumBots = GetNumConnectedBots();
+        if (NumBots >= ExpectedBots)
+        {
+            BeginProfile(0);
+        }
+        else if (Now - StateStartTime >= BotConnectTimeout)
+        {
+            UE_LOG(LogTemp, Error, TEXT("命中判定基准: 等待机器人超时 (%d/%d)"), NumBots, ExpectedBots);
+            FinishBench();
+        }
+        return;
+    }
+
+    FProfileResult& Result = Results[ProfileIndex];
+
+    if (State != EBenchState::Warmup)
+    {
+        // 连接每秒更新一次流量统计，按帧时间积分得到这段时间每个机器人的收发总量
+        if (const UNetDriver* NetDriver = World->GetNetDriver())
+        {
+            int32 NumConnections = 0;
+            for (const UNetConnection* Connection : NetDriver->ClientConnections)
+            {
+                if (Connection)
+                {
+                    Result.InBytes += Connection->InBytesPerSecond * DeltaTime;
+                    Result.OutBytes += Connection->OutBytesPerSecond * DeltaTime;
+                    ++NumConnections;
+                }
+            }
+            Result.NumBots = FMath::Max(Result.NumBots, NumConnections);
+        }
+    }
+
+    // 子弹已经销毁但没有对敌人造成伤害的射击算作未命中
+    RecordedShots.RemoveAll([](const FRecordedShot& Shot) { return !Shot.Projectile.IsValid(); });
+
+    switch (State)
+    {
+    case EBenchState::Warmup:
+        if (Now - StateStartTime >= WarmupTime)
+        {
+            State = EBenchState::Recording;
+            StateStartTime = Now;
+            RecordStartTime = Now;
+        }
+        break;
+
+    case EBenchState::Recording:
+        if (Now - StateStartTime >= ShotsPerProfile * ShotInterval)
+        {
+            State = EBenchState::Draining;
+            StateStartTime = Now;
+        }
+        break;
+
+    case EBenchState::Draining:
+        if (RecordedShots.IsEmpty() || Now - StateStartTime >= GetShotTimeout())
+        {
+            FinishProfile();
+
+            if (ProfileIndex + 1 < Profiles.Num())
+            {
+                BeginProfile(ProfileIndex + 1);
+            }
+            else
+            {
+                FinishBench();
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UHitRegistrationBenchSubsystem::NotifyShotFired(AFPSGameProjectile* Projectile, AController* Instigator, double ClientFireTime)
+{
+    if (State != EBenchState::Recording || !Projectile)
+    {
+        return;
+    }
+
+    // 开火时弹道上第一个挡住的是敌人才算有效射击，被墙挡住或没瞄准的射击不影响命中率
+    const FVector Start = Projectile->GetActorLocation();
+    const FVector Direction = Projectile->GetProjectileMovement()->Velocity.GetSafeNormal(UE_SMALL_NUMBER, Projectile->GetActorForwardVector());
+    FHitResult Hit;
+    FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(HitRegBench), false, Projectile);
+    QueryParams.AddIgnoredActor(Projectile->GetInstigator());
+    const bool bBlocked = GetWorld()->LineTraceSingleByChannel(Hit, Start, Start + Direction * MaxTargetDistance, ECC_Visibility, QueryParams);
+
+    FRecordedShot& Shot = RecordedShots.AddDefaulted_GetRef();
+    Shot.Projectile = Projectile;
+    Shot.Instigator = Instigator;
+    Shot.ClientFireTime = ClientFireTime;
+    Shot.bClearShot = bBlocked && Cast<AEnemyCharacter>(Hit.GetActor()) != nullptr;
+
+    FProfileResult& Result = Results[ProfileIndex];
+    ++Result.Shots;
+    Result.ClearShots += Shot.bClearShot ? 1 : 0;
+}
+
+void UHitRegistrationBenchSubsystem::NotifyProjectileHit(const AFPSGameProjectile* Projectile, const AActor* Victim, float Damage)
+{
+    if ((State != EBenchState::Recording && State != EBenchState::Draining) || Damage <= 0.0f || !Cast<AEnemyCharacter>(Victim))
+    {
+        return;
+    }
+
+    // 只认登记过的子弹，并且发起者还是开火的玩家
+    const int32 ShotIndex = RecordedShots.IndexOfByPredicate([Projectile](const FRecordedShot& Shot) { return Shot.Projectile.Get() == Projectile; });
+    if (ShotIndex == INDEX_NONE || RecordedShots[ShotIndex].Instigator.Get() != Projectile->GetInstigatorController())
+    {
+        return;
+    }
+
+    const FRecordedShot& Shot = RecordedShots[ShotIndex];
+    FProfileResult& Result = Results[ProfileIndex];
+    ++Result.Hits;
+    Result.ClearHits += Shot.bClearShot ? 1 : 0;
+    Result.LatenciesMs.Add(static_cast<float>((GetWorld()->GetTimeSeconds() - Shot.ClientFireTime) * 1000.0));
+    RecordedShots.RemoveAtSwap(ShotIndex);
+}
+
+void UHitRegistrationBenchSubsystem::TickBot()
+{
+    UWorld* World = GetWorld();
+    const UNetDriver* NetDriver = World->GetNetDriver();
+    if (!NetDriver || !NetDriver->ServerConnection)
+    {
+        UE_LOG(LogTemp, Log, TEXT("命中判定机器人: 连接已断开"));
+        State = EBenchState::Idle;
+        if (bExitWhenDone)
+        {
+            FPlatformMisc::RequestExit(false);
+        }
+        return;
+    }
+
+    APlayerController* PlayerController = World->GetFirstPlayerController();
+    AFPSGameCharacter* Character = PlayerController ? Cast<AFPSGameCharacter>(PlayerController->GetPawn()) : nullptr;
+    if (!Character || Character->GetCurrentHealth() <= 0.0f)
+    {
+        return;
+    }
+
+    // 先转向，下一帧摄像机朝向更新后再开火（开火方向取摄像机朝向）
+    const double Now = World->GetRealTimeSeconds();
+    if (bAimed)
+    {
+        bAimed = false;
+        UFPSGameWeaponComponent* Weapon = FindWeapon(Character);
+        if (Weapon && AimTarget.IsValid())
+        {
+            Weapon->Fire();
+        }
+    }
+    else if (Now >= NextShotTime && AimAtTarget(Character))
+    {
+        bAimed = true;
+        NextShotTime = Now + ShotInterval;
+    }
+}
+
+AEnemyCharacter* UHitRegistrationBenchSubsystem::FindTarget(const AFPSGameCharacter* Character) const
+{
+    const FVector Origin = Character->GetActorLocation();
+    AEnemyCharacter* BestTarget = nullptr;
+    float BestDistanceSquared = FMath::Square(MaxTargetDistance);
+
+    for (TActorIterator<AEnemyCharacter> It(GetWorld()); It; ++It)
+    {
+        AEnemyCharacter* Enemy = *It;
+        if (Enemy->IsDead() || Enemy->IsHidden())
+        {
+            continue;
+        }
+
+        const float DistanceSquared = FVector::DistSquared(Origin, Enemy->GetActorLocation());
+        if (DistanceSquared < BestDistanceSquared)
+        {
+            BestDistanceSquared = DistanceSquared;
+            BestTarget = Enemy;
+        }
+    }
+
+    return BestTarget;
+}
+
+UFPSGameWeaponComponent* UHitRegistrationBenchSubsystem::FindWeapon(const AFPSGameCharacter* Character) const
+{
+    // 武器由拾取物附加到第一人称网格上
+    if (const USkeletalMeshComponent* Mesh1P = Character->GetMesh1P())
+    {
+        for (USceneComponent* Child : Mesh1P->GetAttachChildren())
+        {
+            if (UFPSGameWeaponComponent* Weapon = Cast<UFPSGameWeaponComponent>(Child))
+            {
+                return Weapon;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+bool UHitRegistrationBenchSubsystem::AimAtTarget(AFPSGameCharacter* Character)
+{
+    APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
+    const UFPSGameWeaponComponent* Weapon = FindWeapon(Character);
+    AEnemyCharacter* Target = FindTarget(Character);
+    if (!PlayerController || !PlayerController->PlayerCameraManager || !Weapon || !Weapon->ProjectileClass || !Target)
+    {
+        return false;
+    }
+
+    const AFPSGameProjectile* ProjectileCDO = Weapon->ProjectileClass->GetDefaultObject<AFPSGameProjectile>();
+    const float ProjectileSpeed = FMath::Max(ProjectileCDO->GetProjectileMovement()->InitialSpeed, 1.0f);
+
+    // 按子弹飞行时间提前量瞄准，再加上固定种子的偏移
+    const FVector CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+    const float FlightTime = FVector::Dist(CameraLocation, Target->GetActorLocation()) / ProjectileSpeed;
+    const FVector AimPoint = Target->GetActorLocation() + Target->GetVelocity() * FlightTime + ShotStream.GetUnitVector() * ShotStream.FRandRange(0.0f, AimSpread);
+
+    PlayerController->SetControlRotation((AimPoint - CameraLocation).Rotation());
+    AimTarget = Target;
+    return true;
+}
+
+void UHitRegistrationBenchSubsystem::WriteResults()
+{
+    FString Csv = TEXT("Profile,LagMs,JitterMs,LossPercent,Bots,Shots,ClearShots,Hits,ClearHits,ClearHitRate,MinHitRate,AvgTimeToDamageMs,P95TimeToDamageMs,InKBpsPerBot,OutKBpsPerBot,Pass\n");
+    bool bAllPassed = Results.Num() == Profiles.Num();
+    for (int32 Index = 0; Index < Results.Num(); ++Index)
+    {
+        FProfileResult& Result = Results[Index];
+        const FNetEmulationProfile& Profile = Profiles[Index];
+
+        Result.LatenciesMs.Sort();
+        float AvgLatency = 0.0f;
+        for (const float Latency : Result.LatenciesMs)
+        {
+            AvgLatency += Latency;
+        }
+        AvgLatency = Result.LatenciesMs.IsEmpty() ? 0.0f : AvgLatency / Result.LatenciesMs.Num();
+        const float P95Latency = Result.LatenciesMs.IsEmpty() ? 0.0f : Result.LatenciesMs[FMath::Min(FMath::FloorToInt32(Result.LatenciesMs.Num() * 0.95f), Result.LatenciesMs.Num() - 1)];
+
+        const float ClearHitRate = Result.ClearShots > 0 ? static_cast<float>(Result.ClearHits) / Result.ClearShots : 0.0f;
+        const double BotSeconds = FMath::Max(Result.Duration, 1.0) * FMath::Max(Result.NumBots, 1);
+        bAllPassed &= Result.bPassed;
+
+        Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%.1f,%.1f,%.2f,%.2f,%d\n"),
+            *Result.Name, Profile.LagMs, Profile.JitterMs, Profile.LossPercent, Result.NumBots,
+            Result.Shots, Result.ClearShots, Result.Hits, Result.ClearHits, ClearHitRate, Profile.MinHitRate,
+            AvgLatency, P95Latency, Result.InBytes / BotSeconds / 1024.0, Result.OutBytes / BotSeconds / 1024.0, Result.bPassed ? 1 : 0);
+
+        UE_LOG(LogTemp, Warning, TEXT("命中判定基准 %s: %s, 有效射击 %d/%d, 命中 %d (%.1f%%, 要求 %.1f%%), 开火到结算 平均%.0fms P95 %.0fms, 每个机器人 收 %.2fKB/s 发 %.2fKB/s"),
+            *Result.Name, Result.bPassed ? TEXT("通过") : TEXT("未通过"), Result.ClearShots, Result.Shots, Result.ClearHits,
+            ClearHitRate * 100.0f, Profile.MinHitRate * 100.0f, AvgLatency, P95Latency,
+            Result.InBytes / BotSeconds / 1024.0, Result.OutBytes / BotSeconds / 1024.0);
+    }
+
+    FString FilePath;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("HitRegReport="), FilePath))
+    {
+        FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Telemetry"),
+            FString::Printf(TEXT("HitRegBench_%s.csv"), *FDateTime::Now().ToString()));
+    }
+    const bool bSaved = FFileHelper::SaveStringToFile(Csv, *FilePath);
+
+    UE_LOG(LogTemp, Warning, TEXT("命中判定基准结束: %s, CSV%s: %s"), bAllPassed ? TEXT("全部通过") : TEXT("有未通过的参数"),
+        bSaved ? TEXT("已写入") : TEXT("写入失败"), *FilePath);
+}
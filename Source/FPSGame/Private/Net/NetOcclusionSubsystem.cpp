@@ -0,0 +1,372 @@
+#include "Net/NetOcclusionSubsystem.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationSystem.h"
+#include "Net/Iris/ReplicationSystem/ReplicationSystemUtil.h"
+#endif
+
+namespace
+{
+    // 每个角色的包围盒采样点数：中心、头顶、脚下、左右两侧
+    constexpr int32 NumBoundsPoints = 5;
+
+    // 采样点向包围盒内收，避免打到包围盒边缘外的空处
+    constexpr float BoundsPointScale = 0.8f;
+
+    void GetBoundsPoints(const AActor* Actor, const FVector& ViewLocation, FVector (&OutPoints)[NumBoundsPoints])
+    {
+        FVector Origin;
+        FVector Extent;
+        Actor->GetActorBounds(true, Origin, Extent);
+
+        // 左右两点取垂直于视线的水平方向，从观察者看过去是角色的两侧
+        const FVector ToActor = (Origin - ViewLocation).GetSafeNormal2D();
+        const FVector Side = FVector::CrossProduct(ToActor, FVector::UpVector) * FMath::Max(Extent.X, Extent.Y) * BoundsPointScale;
+        const FVector Up(0.0, 0.0, Extent.Z * BoundsPointScale);
+
+        OutPoints[0] = Origin;
+        OutPoints[1] = Origin + Up;
+        OutPoints[2] = Origin - Up;
+        OutPoints[3] = Origin + Side;
+        OutPoints[4] = Origin - Side;
+    }
+}
+
+bool UNetOcclusionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UNetOcclusionSubsystem::Deinitialize()
+{
+    RegisteredActors.Reset();
+    Viewers.Reset();
+    PendingRequests.Reset();
+    InFlightTraces.Reset();
+
+    Super::Deinitialize();
+}
+
+TStatId UNetOcclusionSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNetOcclusionSubsystem, STATGROUP_Tickables);
+}
+
+void UNetOcclusionSubsystem::RegisterActor(AActor* Actor)
+{
+    if (IsValid(Actor))
+    {
+        RegisteredActors.AddUnique(Actor);
+    }
+}
+
+void UNetOcclusionSubsystem::UnregisterActor(AActor* Actor)
+{
+    RegisteredActors.RemoveSwap(Actor);
+
+    if (Actor)
+    {
+        for (TPair<uint32, FViewerVisibility>& Viewer : Viewers)
+        {
+            Viewer.Value.Actors.Remove(Actor->GetUniqueID());
+        }
+    }
+}
+
+const UNetOcclusionSubsystem::FActorVisibility* UNetOcclusionSubsystem::FindVisibility(const AActor* Viewer, const AActor* Actor) const
+{
+    if (!Viewer || !Actor)
+    {
+        return nullptr;
+    }
+
+    const FViewerVisibility* ViewerVisibility = Viewers.Find(Viewer->GetUniqueID());
+    return ViewerVisibility ? ViewerVisibility->Actors.Find(Actor->GetUniqueID()) : nullptr;
+}
+
+UNetOcclusionSubsystem::FActorVisibility* UNetOcclusionSubsystem::FindVisibility(uint32 ViewerId, uint32 ActorId)
+{
+    FViewerVisibility* ViewerVisibility = Viewers.Find(ViewerId);
+    return ViewerVisibility ? ViewerVisibility->Actors.Find(ActorId) : nullptr;
+}
+
+bool UNetOcclusionSubsystem::IsOccludedFor(const AActor* Viewer, const AActor* Actor) const
+{
+    const FActorVisibility* Visibility = FindVisibility(Viewer, Actor);
+    return Visibility && Visibility->State == EOcclusionState::Culled;
+}
+
+float UNetOcclusionSubsystem::GetNetPriorityScale(const AActor* Viewer, const AActor* Actor) const
+{
+    const FActorVisibility* Visibility = FindVisibility(Viewer, Actor);
+    return Visibility && Visibility->State != EOcclusionState::Visible ? OccludedPriorityScale : 1.0f;
+}
+
+void UNetOcclusionSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UWorld* World = GetWorld();
+    if (!World || World->GetNetMode() == NM_Standalone || World->GetNetMode() == NM_Client)
+    {
+        return;
+    }
+
+    const double Now = World->GetTimeSeconds();
+
+    // 每帧先读上一帧的结果，刷新时排队新的检测，再按限额提交
+    CollectTraceResults(World, Now);
+
+    TimeSinceUpdate += DeltaTime;
+    if (TimeSinceUpdate >= UpdateInterval)
+    {
+        TimeSinceUpdate = 0.0f;
+
+        RegisteredActors.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor) { return !Actor.IsValid(); });
+
+        // 只处理远程连接的玩家，监听服务器的本地玩家不需要网络复制
+        TSet<uint32> ActiveViewers;
+        for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+        {
+            APlayerController* PlayerController = It->Get();
+            if (PlayerController && !PlayerController->IsLocalController())
+            {
+                ActiveViewers.Add(PlayerController->GetUniqueID());
+                UpdateViewer(PlayerController);
+            }
+        }
+
+        for (auto It = Viewers.CreateIterator(); It; ++It)
+        {
+            if (!ActiveViewers.Contains(It.Key()))
+            {
+                It.RemoveCurrent();
+            }
+        }
+
+        ApplyIrisConnectionFilters();
+    }
+
+    SubmitPendingRequests(World);
+}
+
+void UNetOcclusionSubsystem::UpdateViewer(APlayerController* PlayerController)
+{
+    const APawn* ViewPawn = PlayerController->GetPawn();
+    FViewerVisibility& ViewerVisibility = Viewers.FindOrAdd(PlayerController->GetUniqueID());
+
+    // 没有Pawn（观战、死亡等待复活）时不剔除，视点由其他逻辑决定
+    if (!ViewPawn)
+    {
+        ViewerVisibility.Actors.Reset();
+        return;
+    }
+
+    for (const TWeakObjectPtr<AActor>& ActorPtr : RegisteredActors)
+    {
+        AActor* Actor = ActorPtr.Get();
+        if (!Actor || Actor == ViewPawn || Actor->IsHidden())
+        {
+            continue;
+        }
+
+        // 上一次的检测还没完成时不重复排队，结果回来前保持上一次的状态
+        FActorVisibility& Visibility = ViewerVisibility.Actors.FindOrAdd(Actor->GetUniqueID());
+        if (!Visibility.bPending)
+        {
+            Visibility.bPending = true;
+            PendingRequests.Add({ PlayerController, Actor, PlayerController->GetUniqueID(), Actor->GetUniqueID() });
+        }
+    }
+}
+
+void UNetOcclusionSubsystem::SubmitPendingRequests(UWorld* World)
+{
+    const int32 TraceBudget = FMath::Max(NumBoundsPoints, MaxTracesPerFrame);
+    int32 NumTraces = 0;
+    int32 NumProcessed = 0;
+
+    for (; NumProcessed < PendingRequests.Num() && NumTraces + NumBoundsPoints <= TraceBudget; ++NumProcessed)
+    {
+        const FOcclusionRequest& Request = PendingRequests[NumProcessed];
+        const APlayerController* PlayerController = Request.Viewer.Get();
+        const AActor* Actor = Request.Actor.Get();
+        const APawn* ViewPawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+        if (!ViewPawn || !Actor)
+        {
+            if (FActorVisibility* Visibility = FindVisibility(Request.ViewerId, Request.ActorId))
+            {
+                Visibility->bPending = false;
+            }
+            continue;
+        }
+
+        // 从玩家的视点（服务器上是Pawn的眼睛加控制器朝向）看向角色包围盒上的采样点
+        FVector ViewLocation;
+        FRotator ViewRotation;
+        PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+        FVector Points[NumBoundsPoints];
+        GetBoundsPoints(Actor, ViewLocation, Points);
+
+        FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NetOcclusion), false, ViewPawn);
+        QueryParams.AddIgnoredActor(Actor);
+
+        FOcclusionInFlight& InFlight = InFlightTraces.AddDefaulted_GetRef();
+        InFlight.Request = Request;
+        for (const FVector& Point : Points)
+        {
+            InFlight.Handles.Add(World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation, Point, OcclusionTraceChannel, QueryParams));
+        }
+        NumTraces += NumBoundsPoints;
+    }
+
+    PendingRequests.RemoveAt(0, NumProcessed, EAllowShrinking::No);
+}
+
+void UNetOcclusionSubsystem::CollectTraceResults(UWorld* World, double Now)
+{
+    for (const FOcclusionInFlight& InFlight : InFlightTraces)
+    {
+        FActorVisibility* Visibility = FindVisibility(InFlight.Request.ViewerId, InFlight.Request.ActorId);
+        if (!Visibility)
+        {
+            continue;
+        }
+        Visibility->bPending = false;
+
+        const APlayerController* PlayerController = InFlight.Request.Viewer.Get();
+        const AActor* Actor = InFlight.Request.Actor.Get();
+        if (!PlayerController || !Actor)
+        {
+            continue;
+        }
+
+        // 任意一条射线没被挡住就算可见；有结果没取到又没有可见的射线时不更新，下次刷新重新排队
+        bool bVisible = false;
+        bool bAllResults = true;
+        for (const FTraceHandle& Handle : InFlight.Handles)
+        {
+            FTraceDatum TraceData;
+            if (!World->QueryTraceData(Handle, TraceData))
+            {
+                bAllResults = false;
+                continue;
+            }
+
+            if (!TraceData.OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; }))
+            {
+                bVisible = true;
+                break;
+            }
+        }
+
+        if (bVisible || bAllResults)
+        {
+            ApplySightResult(*Visibility, PlayerController, Actor, bVisible, Now);
+        }
+    }
+
+    InFlightTraces.Reset();
+}
+
+void UNetOcclusionSubsystem::ApplySightResult(FActorVisibility& Visibility, const APlayerController* PlayerController, const AActor* Actor, bool bVisible, double Now) const
+{
+    if (bVisible)
+    {
+        Visibility.OccludedSince = -1.0;
+        Visibility.State = EOcclusionState::Visible;
+        return;
+    }
+
+    if (Visibility.OccludedSince < 0.0)
+    {
+        Visibility.OccludedSince = Now;
+    }
+
+    const APawn* ViewPawn = PlayerController->GetPawn();
+    const bool bNear = !ViewPawn
+        || FVector::DistSquared(ViewPawn->GetActorLocation(), Actor->GetActorLocation()) <= FMath::Square(AlwaysRelevantDistance);
+    const bool bGraceExpired = Now - Visibility.OccludedSince >= OccludedGraceTime;
+    Visibility.State = (!bNear && bGraceExpired) ? EOcclusionState::Culled : EOcclusionState::LowPriority;
+}
+
+void UNetOcclusionSubsystem::ApplyIrisConnectionFilters()
+{
+#if UE_WITH_IRIS
+    UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+    UReplicationSystem* ReplicationSystem = NetDriver && NetDriver->IsUsingIrisReplication() ? NetDriver->GetReplicationSystem() : nullptr;
+    if (!ReplicationSystem)
+    {
+        return;
+    }
+
+    // 连接ID对应的观察者
+    TArray<TPair<uint32, const FViewerVisibility*>, TInlineAllocator<16>> ConnectionViewers;
+    uint32 MaxConnectionId = 0;
+    for (UNetConnection* Connection : NetDriver->ClientConnections)
+    {
+        if (!Connection)
+        {
+            continue;
+        }
+
+        const uint32 ConnectionId = Connection->GetConnectionId();
+        MaxConnectionId = FMath::Max(MaxConnectionId, ConnectionId);
+
+        if (Connection->PlayerController)
+        {
+            if (const FViewerVisibility* ViewerVisibility = Viewers.Find(Connection->PlayerController->GetUniqueID()))
+            {
+                ConnectionViewers.Emplace(ConnectionId, ViewerVisibility);
+            }
+        }
+    }
+
+    for (const TWeakObjectPtr<AActor>& ActorPtr : RegisteredActors)
+    {
+        const AActor* Actor = ActorPtr.Get();
+        const UE::Net::FNetRefHandle Handle = Actor ? UE::Net::FReplicationSystemUtil::GetNetRefHandle(Actor) : UE::Net::FNetRefHandle();
+        if (!Handle.IsValid())
+        {
+            continue;
+        }
+
+        // 默认允许所有连接，只去掉把该角色剔除的连接
+        TBitArray<> AllowedConnections(true, MaxConnectionId + 1);
+        for (const TPair<uint32, const FViewerVisibility*>& ConnectionViewer : ConnectionViewers)
+        {
+            const FActorVisibility* Visibility = ConnectionViewer.Value->Actors.Find(Actor->GetUniqueID());
+            if (Visibility && Visibility->State == EOcclusionState::Culled)
+            {
+                AllowedConnections[ConnectionViewer.Key] = false;
+            }
+        }
+
+        ReplicationSystem->SetConnectionFilter(Handle, AllowedConnections, UE::Net::ENetFilterStatus::Allow);
+    }
+#endif
+}
+
+void UNetOcclusionSubsystem::DumpStats() const
+{
+    UE_LOG(LogTemp, Warning, TEXT("遮挡相关性: 注册角色 %d, 观察者 %d"), RegisteredActors.Num(), Viewers.Num());
+
+    for (const TPair<uint32, FViewerVisibility>& Viewer : Viewers)
+    {
+        int32 NumCulled = 0;
+        int32 NumLowPriority = 0;
+        for (const TPair<uint32, FActorVisibility>& Actor : Viewer.Value.Actors)
+        {
+            NumCulled += Actor.Value.State == EOcclusionState::Culled ? 1 : 0;
+            NumLowPriority += Actor.Value.State == EOcclusionState::LowPriority ? 1 : 0;
+        }
+
+        UE_LOG(LogTemp, Warning, TEXT("  观察者 %u: 剔除 %d, 降优先级 %d"), Viewer.Key, NumCulled, NumLowPriority);
+    }
+}
@@ -0,0 +1,182 @@
+#include "Net/ReplicationBenchSubsystem.h"
+#include "Character/EnemyCharacter.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+
+bool UReplicationBenchSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UReplicationBenchSubsystem::Deinitialize()
+{
+    if (bRunning)
+    {
+        StopBench();
+    }
+
+    Super::Deinitialize();
+}
+
+FString UReplicationBenchSubsystem::GetModeName() const
+{
+    const UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr;
+    return NetDriver && NetDriver->IsUsingIrisReplication() ? TEXT("Iris") : TEXT("Legacy");
+}
+
+void UReplicationBenchSubsystem::StartBench(float Seconds)
+{
+    UWorld* World = GetWorld();
+    if (!World || !World->GetNetDriver() || !World->GetNetDriver()->IsServer())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("复制基准只能在服务器上运行"));
+        return;
+    }
+
+    if (bRunning)
+    {
+        StopBench();
+    }
+
+    Samples.Reset();
+    AccumulatedFlushSeconds = 0.0;
+    MaxFlushSeconds = 0.0;
+    NumFlushFrames = 0;
+    FrameFlushStart = 0.0;
+
+    StartTime = World->GetRealTimeSeconds();
+    EndTime = StartTime + FMath::Max(Seconds, 1.0f);
+    bRunning = true;
+
+    PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UReplicationBenchSubsystem::OnPostActorTick);
+    EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UReplicationBenchSubsystem::OnEndFrame);
+
+    // 网络驱动每秒更新一次流量统计，按同样的频率采样
+    World->GetTimerManager().SetTimer(SampleTimerHandle, this, &UReplicationBenchSubsystem::TakeSample, 1.0f, true);
+
+    UE_LOG(LogTemp, Warning, TEXT("复制基准开始: 模式 %s, 时长 %.0f秒"), *GetModeName(), Seconds);
+}
+
+void UReplicationBenchSubsystem::StopBench()
+{
+    if (!bRunning)
+    {
+        return;
+    }
+    bRunning = false;
+
+    FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(SampleTimerHandle);
+    }
+
+    WriteResults();
+}
+
+void UReplicationBenchSubsystem::OnPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World == GetWorld())
+    {
+        FrameFlushStart = FPlatformTime::Seconds();
+    }
+}
+
+void UReplicationBenchSubsystem::OnEndFrame()
+{
+    // Actor Tick之后到帧结束主要是网络驱动的TickFlush（收集、序列化和发送复制数据）
+    if (FrameFlushStart <= 0.0)
+    {
+        return;
+    }
+
+    const double Elapsed = FPlatformTime::Seconds() - FrameFlushStart;
+    FrameFlushStart = 0.0;
+
+    AccumulatedFlushSeconds += Elapsed;
+    MaxFlushSeconds = FMath::Max(MaxFlushSeconds, Elapsed);
+    ++NumFlushFrames;
+}
+
+void UReplicationBenchSubsystem::TakeSample()
+{
+    UWorld* World = GetWorld();
+    const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+    if (!NetDriver)
+    {
+        StopBench();
+        return;
+    }
+
+    FBenchSample& Sample = Samples.AddDefaulted_GetRef();
+    Sample.Time = World->GetRealTimeSeconds() - StartTime;
+    Sample.NumConnections = NetDriver->ClientConnections.Num();
+    Sample.OutBytesPerSecond = NetDriver->OutBytesPerSecond;
+    Sample.OutPacketsPerSecond = NetDriver->OutPacketsPerSecond;
+    Sample.InBytesPerSecond = NetDriver->InBytesPerSecond;
+    Sample.AvgFlushMs = NumFlushFrames > 0 ? AccumulatedFlushSeconds * 1000.0 / NumFlushFrames : 0.0;
+    Sample.MaxFlushMs = MaxFlushSeconds * 1000.0;
+
+    for (TActorIterator<AEnemyCharacter> It(World); It; ++It)
+    {
+        if (!It->IsDead())
+        {
+            ++Sample.NumActiveEnemies;
+        }
+    }
+
+    AccumulatedFlushSeconds = 0.0;
+    MaxFlushSeconds = 0.0;
+    NumFlushFrames = 0;
+
+    if (World->GetRealTimeSeconds() >= EndTime)
+    {
+        StopBench();
+    }
+}
+
+void UReplicationBenchSubsystem::WriteResults()
+{
+    if (Samples.IsEmpty())
+    {
+        return;
+    }
+
+    const FString ModeName = GetModeName();
+
+    FString Csv = TEXT("Mode,Time,Connections,ActiveEnemies,OutKBps,OutPacketsPerSec,InKBps,AvgFlushMs,MaxFlushMs\n");
+    double TotalOutBytes = 0.0;
+    double TotalFlushMs = 0.0;
+    double PeakFlushMs = 0.0;
+    for (const FBenchSample& Sample : Samples)
+    {
+        Csv += FString::Printf(TEXT("%s,%.1f,%d,%d,%.2f,%u,%.2f,%.3f,%.3f\n"),
+            *ModeName, Sample.Time, Sample.NumConnections, Sample.NumActiveEnemies,
+            Sample.OutBytesPerSecond / 1024.0, Sample.OutPacketsPerSecond, Sample.InBytesPerSecond / 1024.0,
+            Sample.AvgFlushMs, Sample.MaxFlushMs);
+
+        TotalOutBytes += Sample.OutBytesPerSecond;
+        TotalFlushMs += Sample.AvgFlushMs;
+        PeakFlushMs = FMath::Max(PeakFlushMs, Sample.MaxFlushMs);
+    }
+
+    const FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Telemetry"),
+        FString::Printf(TEXT("ReplicationBench_%s_%s.csv"), *ModeName, *FDateTime::Now().ToString()));
+    const bool bSaved = FFileHelper::SaveStringToFile(Csv, *FilePath);
+
+    const FBenchSample& Last = Samples.Last();
+    UE_LOG(LogTemp, Warning, TEXT("复制基准结束: 模式 %s, %d个连接, %d个活跃敌人, 平均发送 %.2fKB/s, 平均帧末复制 %.3fms, 峰值 %.3fms, CSV%s: %s"),
+        *ModeName, Last.NumConnections, Last.NumActiveEnemies,
+        TotalOutBytes / Samples.Num() / 1024.0, TotalFlushMs / Samples.Num(), PeakFlushMs,
+        bSaved ? TEXT("已写入") : TEXT("写入失败"), *FilePath);
+}
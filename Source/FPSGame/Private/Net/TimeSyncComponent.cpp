@@ -0,0 +1,259 @@
+#include "Net/TimeSyncComponent.h"
+#include "PlayerState/MyPlayerState.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+void FTimeSyncEstimator::AddSample(float SampleRoundTrip, double SampleOffset)
+{
+    const int32 WindowSize = FMath::Max(SampleWindow, 1);
+    if (Samples.Num() < WindowSize)
+    {
+        Samples.Add({ SampleRoundTrip, SampleOffset });
+    }
+    else
+    {
+        Samples[NextSampleIndex] = { SampleRoundTrip, SampleOffset };
+    }
+    NextSampleIndex = (NextSampleIndex + 1) % WindowSize;
+
+    // 往返延迟用全部样本的均值和标准差
+    double RoundTripSum = 0.0;
+    double RoundTripSquaredSum = 0.0;
+    for (const FTimeSample& Sample : Samples)
+    {
+        RoundTripSum += Sample.RoundTripTime;
+        RoundTripSquaredSum += FMath::Square(Sample.RoundTripTime);
+    }
+    const double MeanRoundTrip = RoundTripSum / Samples.Num();
+    RoundTripTime = static_cast<float>(MeanRoundTrip);
+    RoundTripJitter = static_cast<float>(FMath::Sqrt(FMath::Max(RoundTripSquaredSum / Samples.Num() - FMath::Square(MeanRoundTrip), 0.0)));
+
+    // 偏移只用往返最短的样本：排队延迟越少，对称假设的误差越小
+    TArray<FTimeSample, TInlineAllocator<32>> Sorted(Samples);
+    Sorted.Sort([](const FTimeSample& A, const FTimeSample& B) { return A.RoundTripTime < B.RoundTripTime; });
+
+    const int32 NumBest = FMath::Clamp(FMath::CeilToInt32(Sorted.Num() * BestSampleFraction), 1, Sorted.Num());
+    double OffsetSum = 0.0;
+    for (int32 Index = 0; Index < NumBest; ++Index)
+    {
+        OffsetSum += Sorted[Index].Offset;
+    }
+    TargetOffset = OffsetSum / NumBest;
+
+    if (!bSynchronized || FMath::Abs(TargetOffset - ClockOffset) > SnapThreshold)
+    {
+        ClockOffset = TargetOffset;
+        bSynchronized = true;
+    }
+}
+
+void FTimeSyncEstimator::Advance(float DeltaTime)
+{
+    // 小的偏差按限速修正，同步时间保持单调平滑
+    if (bSynchronized)
+    {
+        const double MaxStep = MaxSlewRate * DeltaTime;
+        ClockOffset += FMath::Clamp(TargetOffset - ClockOffset, -MaxStep, MaxStep);
+    }
+}
+
+void FTimeSyncEstimator::ResetSamples()
+{
+    Samples.Reset();
+    NextSampleIndex = 0;
+}
+
+UTimeSyncComponent::UTimeSyncComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = false;
+
+    SetIsReplicatedByDefault(true);
+}
+
+void UTimeSyncComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // 只有客户端需要采样，其他玩家的PlayerState在Tick里直接跳过
+    if (GetNetMode() == NM_Client)
+    {
+        Estimator.SampleWindow = SampleWindow;
+        Estimator.BestSampleFraction = BestSampleFraction;
+        Estimator.MaxSlewRate = MaxSlewRate;
+        Estimator.SnapThreshold = SnapThreshold;
+
+        FastSamplesRemaining = FastSyncSamples;
+        SetComponentTickEnabled(true);
+    }
+}
+
+UTimeSyncComponent* UTimeSyncComponent::Get(const AController* Controller)
+{
+    const AMyPlayerState* PlayerState = Controller ? Controller->GetPlayerState<AMyPlayerState>() : nullptr;
+    return PlayerState ? PlayerState->GetTimeSync() : nullptr;
+}
+
+UTimeSyncComponent* UTimeSyncComponent::Get(const APawn* Pawn)
+{
+    const AMyPlayerState* PlayerState = Pawn ? Pawn->GetPlayerState<AMyPlayerState>() : nullptr;
+    return PlayerState ? PlayerState->GetTimeSync() : nullptr;
+}
+
+bool UTimeSyncComponent::IsLocalClient() const
+{
+    const APlayerState* PlayerState = GetOwner<APlayerState>();
+    const APlayerController* PlayerController = PlayerState ? PlayerState->GetPlayerController() : nullptr;
+    return GetNetMode() == NM_Client && PlayerController && PlayerController->IsLocalController();
+}
+
+double UTimeSyncComponent::GetLocalTime() const
+{
+    const UWorld* World = GetWorld();
+    return World ? World->GetTimeSeconds() : 0.0;
+}
+
+double UTimeSyncComponent::GetServerTime() const
+{
+    if (GetNetMode() != NM_Client)
+    {
+        return GetLocalTime();
+    }
+
+    if (Estimator.IsSynchronized())
+    {
+        return GetLocalTime() + Estimator.GetClockOffset();
+    }
+
+    const UWorld* World = GetWorld();
+    const AGameStateBase* GameState = World ? World->GetGameState() : nullptr;
+    return GameState ? GameState->GetServerWorldTimeSeconds() : GetLocalTime();
+}
+
+float UTimeSyncComponent::GetRoundTripTime() const
+{
+    if (GetNetMode() == NM_Client && Estimator.IsSynchronized())
+    {
+        return Estimator.GetRoundTripTime();
+    }
+
+    // 服务器不信任客户端报告的延迟，用连接上测得的Ping
+    const APlayerState* PlayerState = GetOwner<APlayerState>();
+    return PlayerState ? PlayerState->GetPingInMilliseconds() * 0.001f : 0.0f;
+}
+
+uint16 UTimeSyncComponent::CompressTime(double ServerTime)
+{
+    return static_cast<uint16>(FMath::RoundToInt64(ServerTime * 1000.0) & 0xFFFF);
+}
+
+double UTimeSyncComponent::DecompressTime(uint16 Stamp, double ServerNow)
+{
+    const int64 NowMs = FMath::RoundToInt64(ServerNow * 1000.0);
+
+    // 按16位回绕取差值，正数表示时间戳在当前时间之前
+    const int16 AgeMs = static_cast<int16>(static_cast<uint16>(static_cast<uint16>(NowMs) - Stamp));
+    return static_cast<double>(NowMs - AgeMs) * 0.001;
+}
+
+bool UTimeSyncComponent::ValidateClientTime(double ClientServerTime, double& OutRewindTime) const
+{
+    return ValidateClientTime(ClientServerTime, GetServerTime(), GetRoundTripTime(), TimestampTolerance, MaxRewindTime, OutRewindTime);
+}
+
+bool UTimeSyncComponent::ValidateClientTime(double ClientServerTime, double ServerNow, float RoundTripTime, float Tolerance, float MaxRewind, double& OutRewindTime)
+{
+    const double Age = ServerNow - ClientServerTime;
+
+    // 命令在客户端打上时间戳后单程到达服务器，再加上移动合并和抖动，正常不会超过一个往返
+    const bool bValid = Age >= -Tolerance && Age <= RoundTripTime + Tolerance;
+
+    OutRewindTime = FMath::Clamp(ClientServerTime, ServerNow - MaxRewind, ServerNow);
+    return bValid;
+}
+
+void UTimeSyncComponent::Resync()
+{
+    Estimator.ResetSamples();
+    FastSamplesRemaining = FastSyncSamples;
+    NextRequestTime = 0.0;
+}
+
+void UTimeSyncComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (!IsLocalClient())
+    {
+        return;
+    }
+
+    const double Now = GetLocalTime();
+
+    PendingRequests.RemoveAll([this, Now](const FPendingRequest& Request) { return Now - Request.SendTime > RequestTimeout; });
+
+    if (Now >= NextRequestTime)
+    {
+        SendRequest(Now);
+    }
+
+    Estimator.Advance(DeltaTime);
+}
+
+void UTimeSyncComponent::SendRequest(double Now)
+{
+    // 丢失的请求最终会超时，这里只防止未回复的请求无限增长
+    if (PendingRequests.Num() >= 8)
+    {
+        PendingRequests.RemoveAt(0);
+    }
+
+    PendingRequests.Add({ NextSequence, Now });
+    ServerRequestTime(NextSequence);
+    ++NextSequence;
+
+    NextRequestTime = Now + (FastSamplesRemaining > 0 ? FastSyncInterval : SyncInterval);
+}
+
+void UTimeSyncComponent::ServerRequestTime_Implementation(uint8 Sequence)
+{
+    ClientReceiveTime(Sequence, GetLocalTime());
+}
+
+void UTimeSyncComponent::ClientReceiveTime_Implementation(uint8 Sequence, double ServerTime)
+{
+    const int32 Index = PendingRequests.IndexOfByPredicate([Sequence](const FPendingRequest& Request) { return Request.Sequence == Sequence; });
+    if (Index == INDEX_NONE)
+    {
+        return;
+    }
+
+    const double Now = GetLocalTime();
+    const float SampleRoundTrip = static_cast<float>(Now - PendingRequests[Index].SendTime);
+    PendingRequests.RemoveAt(Index);
+
+    // 假设上下行延迟对称，服务器时间对应往返的中点
+    Estimator.AddSample(SampleRoundTrip, ServerTime + SampleRoundTrip * 0.5 - Now);
+    FastSamplesRemaining = FMath::Max(FastSamplesRemaining - 1, 0);
+}
+
+void UTimeSyncComponent::DumpStats() const
+{
+    const APlayerState* PlayerState = GetOwner<APlayerState>();
+    const FString PlayerName = PlayerState ? PlayerState->GetPlayerName() : GetNameSafe(GetOwner());
+
+    if (GetNetMode() != NM_Client)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("时间同步 %s: 服务器时间 %.3f, Ping %.0fms"),
+            *PlayerName, GetServerTime(), GetRoundTripTime() * 1000.0f);
+        return;
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("时间同步 %s: %s, 服务器时间 %.3f, 偏移 %.1fms (目标 %.1fms), 往返 %.1fms ±%.1fms, 样本 %d"),
+        *PlayerName, Estimator.IsSynchronized() ? TEXT("已同步") : TEXT("未同步"), GetServerTime(),
+        Estimator.GetClockOffset() * 1000.0, Estimator.GetTargetOffset() * 1000.0, Estimator.GetRoundTripTime() * 1000.0f,
+        Estimator.GetRoundTripJitter() * 1000.0f, Estimator.GetNumSamples());
+}
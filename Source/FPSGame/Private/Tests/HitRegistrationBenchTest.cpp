@@ -0,0 +1,161 @@
+#include "Net/HitRegistrationBenchSubsystem.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace HitRegistrationBenchTest
+{
+    // 专用服务器监听的端口，避开默认端口，不和本机正在运行的游戏冲突
+    constexpr int32 ServerPort = 17777;
+
+    // 启动服务器后等它加载地图开始监听，再启动机器人
+    constexpr float ServerStartupDelay = 15.0f;
+
+    constexpr int32 DefaultNumBots = 4;
+
+    struct FBenchProcesses
+    {
+        FProcHandle Server;
+        TArray<FProcHandle> Bots;
+        FString ReportPath;
+        double StartTime = 0.0;
+        double Timeout = 0.0;
+    };
+
+    // 编辑器里用同一个可执行文件加项目路径启动，打包后的游戏直接启动
+    FProcHandle Launch(const FString& Params)
+    {
+        FString FullParams = Params;
+        if (FPaths::IsProjectFilePathSet())
+        {
+            FullParams = FString::Printf(TEXT("\"%s\" %s"), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()), *Params);
+        }
+        return FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *FullParams, false, true, true, nullptr, 0, nullptr, nullptr);
+    }
+
+    void Terminate(FProcHandle& Handle)
+    {
+        if (Handle.IsValid())
+        {
+            if (FPlatformProcess::IsProcRunning(Handle))
+            {
+                FPlatformProcess::TerminateProc(Handle, true);
+            }
+            FPlatformProcess::CloseProc(Handle);
+        }
+    }
+
+    void TerminateAll(FBenchProcesses& Processes)
+    {
+        Terminate(Processes.Server);
+        for (FProcHandle& Bot : Processes.Bots)
+        {
+            Terminate(Bot);
+        }
+        Processes.Bots.Reset();
+    }
+}
+
+// 等服务器跑完所有网络参数后退出，再读它写出的结果
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FWaitForHitRegBenchCommand, FAutomationTestBase*, Test, TSharedRef<HitRegistrationBenchTest::FBenchProcesses>, Processes);
+
+bool FWaitForHitRegBenchCommand::Update()
+{
+    if (FPlatformProcess::IsProcRunning(Processes->Server))
+    {
+        if (FPlatformTime::Seconds() - Processes->StartTime < Processes->Timeout)
+        {
+            return false;
+        }
+
+        Test->AddError(FString::Printf(TEXT("命中判定基准超过%.0f秒没有结束"), Processes->Timeout));
+        HitRegistrationBenchTest::TerminateAll(*Processes);
+        return true;
+    }
+
+    HitRegistrationBenchTest::TerminateAll(*Processes);
+
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *Processes->ReportPath) || Lines.Num() < 2)
+    {
+        Test->AddError(FString::Printf(TEXT("没有读到命中判定基准的结果: %s"), *Processes->ReportPath));
+        return true;
+    }
+
+    // 第一行是表头，每组网络参数一行，最后一列是是否通过
+    for (int32 Index = 1; Index < Lines.Num(); ++Index)
+    {
+        TArray<FString> Columns;
+        Lines[Index].ParseIntoArray(Columns, TEXT(","));
+        if (Columns.IsEmpty())
+        {
+            continue;
+        }
+
+        if (Columns.Last() == TEXT("1"))
+        {
+            Test->AddInfo(FString::Printf(TEXT("通过: %s"), *Lines[Index]));
+        }
+        else
+        {
+            Test->AddError(FString::Printf(TEXT("未通过: %s"), *Lines[Index]));
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHitRegistrationBenchTest, "FPSGame.Net.HitRegistration.Bench",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::StressFilter)
+
+bool FHitRegistrationBenchTest::RunTest(const FString& Parameters)
+{
+    using namespace HitRegistrationBenchTest;
+
+    const UHitRegistrationBenchSubsystem* BenchDefaults = GetDefault<UHitRegistrationBenchSubsystem>();
+    if (BenchDefaults->GetBenchMap().IsEmpty())
+    {
+        AddError(TEXT("没有配置命中判定基准的地图（HitRegistrationBenchSubsystem.BenchMap）"));
+        return false;
+    }
+
+    // 机器人数量可用 -HitRegBots=N 覆盖
+    int32 NumBots = DefaultNumBots;
+    FParse::Value(FCommandLine::Get(), TEXT("HitRegBots="), NumBots);
+    NumBots = FMath::Max(NumBots, 1);
+
+    TSharedRef<FBenchProcesses> Processes = MakeShared<FBenchProcesses>();
+    Processes->ReportPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("HitRegBench.csv")));
+    Processes->StartTime = FPlatformTime::Seconds();
+    Processes->Timeout = ServerStartupDelay + BenchDefaults->GetEstimatedDuration() + 60.0;
+    IFileManager::Get().Delete(*Processes->ReportPath, false, true, true);
+
+    // 无界面专用服务器：等机器人连上后依次套用网络参数，在服务器上结算命中，写完结果后退出
+    Processes->Server = Launch(FString::Printf(TEXT("%s -server -nullrhi -nosound -unattended -log -port=%d -HitRegBench=%d -HitRegReport=\"%s\""),
+        *BenchDefaults->GetBenchMap(), ServerPort, NumBots, *Processes->ReportPath));
+    if (!Processes->Server.IsValid())
+    {
+        AddError(TEXT("无法启动命中判定基准的专用服务器"));
+        return false;
+    }
+
+    // 无界面机器人客户端：连上后持续瞄准最近的敌人开火，服务器退出后跟着退出
+    ADD_LATENT_AUTOMATION_COMMAND(FDelayedFunctionLatentCommand([Processes, NumBots]()
+    {
+        for (int32 Index = 0; Index < NumBots; ++Index)
+        {
+            Processes->Bots.Add(Launch(FString::Printf(TEXT("127.0.0.1:%d -game -nullrhi -nosound -unattended -log -HitRegBot"), ServerPort)));
+        }
+    }, ServerStartupDelay));
+
+    ADD_LATENT_AUTOMATION_COMMAND(FWaitForHitRegBenchCommand(this, Processes));
+    return true;
+}
+
+#endif
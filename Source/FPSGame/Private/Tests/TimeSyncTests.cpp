@@ -0,0 +1,192 @@
+#include "Net/TimeSyncComponent.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TimeSyncTests
+{
+    // 模拟一次往返：上下行各自带随机抖动，返回客户端看到的往返时间和按对称假设算出的偏移
+    void SimulateExchange(FRandomStream& Random, double TrueOffset, double OneWayDelay, double MaxJitter, float& OutRoundTrip, double& OutOffset)
+    {
+        const double Up = OneWayDelay + Random.FRandRange(0.0f, static_cast<float>(MaxJitter));
+        const double Down = OneWayDelay + Random.FRandRange(0.0f, static_cast<float>(MaxJitter));
+
+        // 客户端在本地时间0发出请求，服务器收到时的服务器时间是 Up + TrueOffset
+        const double ServerTime = Up + TrueOffset;
+        const double Now = Up + Down;
+
+        OutRoundTrip = static_cast<float>(Now);
+        OutOffset = ServerTime + OutRoundTrip * 0.5 - Now;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTimeSyncConvergeTest, "FPSGame.Net.TimeSync.OffsetConverges",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTimeSyncConvergeTest::RunTest(const FString& Parameters)
+{
+    FRandomStream Random(1234);
+    FTimeSyncEstimator Estimator;
+
+    const double TrueOffset = 12.345;
+    const double OneWayDelay = 0.06;
+    const double MaxJitter = 0.04;
+
+    for (int32 Index = 0; Index < 64; ++Index)
+    {
+        float RoundTrip = 0.0f;
+        double Offset = 0.0;
+        TimeSyncTests::SimulateExchange(Random, TrueOffset, OneWayDelay, MaxJitter, RoundTrip, Offset);
+        Estimator.AddSample(RoundTrip, Offset);
+    }
+
+    TestTrue(TEXT("已同步"), Estimator.IsSynchronized());
+    TestEqual(TEXT("窗口样本数"), Estimator.GetNumSamples(), Estimator.SampleWindow);
+
+    // 单个样本的偏移误差最多是抖动的一半（20ms），取往返最短的样本后应明显更小
+    TestTrue(FString::Printf(TEXT("偏移收敛 (误差 %.2fms)"), FMath::Abs(Estimator.GetClockOffset() - TrueOffset) * 1000.0),
+        FMath::IsNearlyEqual(Estimator.GetClockOffset(), TrueOffset, 0.015));
+
+    // 往返均值是 2 * (单程 + 抖动均值) = 160ms
+    TestTrue(FString::Printf(TEXT("往返估计 (%.1fms)"), Estimator.GetRoundTripTime() * 1000.0f),
+        FMath::IsNearlyEqual(Estimator.GetRoundTripTime(), 0.16f, 0.02f));
+    TestTrue(TEXT("往返抖动大于0"), Estimator.GetRoundTripJitter() > 0.0f);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTimeSyncSlewTest, "FPSGame.Net.TimeSync.SlewIsMonotonic",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTimeSyncSlewTest::RunTest(const FString& Parameters)
+{
+    FRandomStream Random(5678);
+    FTimeSyncEstimator Estimator;
+    Estimator.SampleWindow = 8;
+
+    const double OneWayDelay = 0.05;
+    const double MaxJitter = 0.02;
+    const float DeltaTime = 1.0f / 60.0f;
+
+    double LocalTime = 0.0;
+    double LastServerTime = -DBL_MAX;
+    bool bMonotonic = true;
+    bool bStepWithinRate = true;
+
+    // 每帧推进时钟，每秒加一个样本；前半段偏移1.0秒，后半段客户端时钟漂了100ms（小于SnapThreshold，只能平滑修正）
+    auto RunFrames = [&](double TrueOffset, int32 NumFrames)
+    {
+        for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+        {
+            if (Frame % 60 == 0)
+            {
+                float RoundTrip = 0.0f;
+                double Offset = 0.0;
+                TimeSyncTests::SimulateExchange(Random, TrueOffset, OneWayDelay, MaxJitter, RoundTrip, Offset);
+                Estimator.AddSample(RoundTrip, Offset);
+            }
+
+            const double OffsetBefore = Estimator.GetClockOffset();
+            Estimator.Advance(DeltaTime);
+            LocalTime += DeltaTime;
+
+            bStepWithinRate &= FMath::Abs(Estimator.GetClockOffset() - OffsetBefore) <= Estimator.MaxSlewRate * DeltaTime + UE_KINDA_SMALL_NUMBER;
+
+            const double ServerTime = LocalTime + Estimator.GetClockOffset();
+            bMonotonic &= ServerTime >= LastServerTime;
+            LastServerTime = ServerTime;
+        }
+    };
+
+    RunFrames(1.0, 60 * 10);
+    TestTrue(TEXT("初始偏移直接跳到目标"), FMath::IsNearlyEqual(Estimator.GetClockOffset(), 1.0, 0.01));
+
+    RunFrames(1.1, 60 * 30);
+    TestTrue(TEXT("同步时间单调不减"), bMonotonic);
+    TestTrue(TEXT("每帧修正不超过MaxSlewRate"), bStepWithinRate);
+    TestTrue(FString::Printf(TEXT("平滑修正后到达新偏移 (%.1fms)"), Estimator.GetClockOffset() * 1000.0),
+        FMath::IsNearlyEqual(Estimator.GetClockOffset(), 1.1, 0.01));
+
+    // 超过SnapThreshold的偏差直接跳，不超过的只改目标
+    FTimeSyncEstimator SnapEstimator;
+    SnapEstimator.SampleWindow = 1;
+    SnapEstimator.AddSample(0.1f, 1.0);
+    SnapEstimator.AddSample(0.1f, 3.0);
+    TestEqual(TEXT("大偏差直接跳"), SnapEstimator.GetClockOffset(), 3.0);
+
+    SnapEstimator.AddSample(0.1f, 3.1);
+    TestEqual(TEXT("小偏差不跳"), SnapEstimator.GetClockOffset(), 3.0);
+    TestEqual(TEXT("小偏差只改目标"), SnapEstimator.GetTargetOffset(), 3.1);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTimeSyncDecompressTest, "FPSGame.Net.TimeSync.DecompressWraparound",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTimeSyncDecompressTest::RunTest(const FString& Parameters)
+{
+    // 16位毫秒时间戳每65.536秒回绕一次，在回绕点前后和较晚的对局时间都要能还原
+    const double NowTimes[] = { 0.5, 65.5, 65.6, 131.07, 3600.0 + 65.535 };
+    const double Ages[] = { 0.0, 0.016, 0.25, 1.0, -0.05, 30.0, -30.0 };
+
+    for (const double Now : NowTimes)
+    {
+        for (const double Age : Ages)
+        {
+            const double StampTime = Now - Age;
+            if (StampTime < 0.0)
+            {
+                continue;
+            }
+
+            const uint16 Stamp = UTimeSyncComponent::CompressTime(StampTime);
+            const double Decompressed = UTimeSyncComponent::DecompressTime(Stamp, Now);
+            TestTrue(FString::Printf(TEXT("当前 %.3f 解压 %.3f 得到 %.3f"), Now, StampTime, Decompressed),
+                FMath::Abs(Decompressed - StampTime) <= 0.001);
+        }
+    }
+
+    // 相差超过半圈的时间戳会被当成另一圈
+    const double Now = 100.0;
+    const double Decompressed = UTimeSyncComponent::DecompressTime(UTimeSyncComponent::CompressTime(Now - 40.0), Now);
+    TestTrue(TEXT("超过半圈按最近的一圈解压"), FMath::IsNearlyEqual(Decompressed, Now - 40.0 + 65.536, 0.001));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTimeSyncValidateTest, "FPSGame.Net.TimeSync.ValidateClientTime",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTimeSyncValidateTest::RunTest(const FString& Parameters)
+{
+    const double Now = 200.0;
+    const float RoundTrip = 0.1f;
+    const float Tolerance = 0.05f;
+    const float MaxRewind = 0.3f;
+    double RewindTime = 0.0;
+
+    TestTrue(TEXT("单程延迟内有效"), UTimeSyncComponent::ValidateClientTime(Now - 0.05, Now, RoundTrip, Tolerance, MaxRewind, RewindTime));
+    TestEqual(TEXT("有效时按时间戳回溯"), RewindTime, Now - 0.05);
+
+    TestTrue(TEXT("容差内的未来时间有效"), UTimeSyncComponent::ValidateClientTime(Now + 0.04, Now, RoundTrip, Tolerance, MaxRewind, RewindTime));
+    TestEqual(TEXT("未来时间回溯到现在"), RewindTime, Now);
+
+    TestFalse(TEXT("超出容差的未来时间无效"), UTimeSyncComponent::ValidateClientTime(Now + 0.06, Now, RoundTrip, Tolerance, MaxRewind, RewindTime));
+    TestEqual(TEXT("无效的未来时间也不超过现在"), RewindTime, Now);
+
+    TestTrue(TEXT("往返加容差的边界有效"), UTimeSyncComponent::ValidateClientTime(Now - 0.149, Now, RoundTrip, Tolerance, MaxRewind, RewindTime));
+    TestFalse(TEXT("早于往返加容差无效"), UTimeSyncComponent::ValidateClientTime(Now - 0.151, Now, RoundTrip, Tolerance, MaxRewind, RewindTime));
+
+    // 往返很大时时间戳可以有效，但回溯仍然不超过MaxRewindTime
+    TestTrue(TEXT("高延迟下有效"), UTimeSyncComponent::ValidateClientTime(Now - 0.5, Now, 0.6f, Tolerance, MaxRewind, RewindTime));
+    TestEqual(TEXT("回溯限制在MaxRewindTime内"), RewindTime, Now - MaxRewind);
+
+    TestFalse(TEXT("很久以前的时间戳无效"), UTimeSyncComponent::ValidateClientTime(Now - 10.0, Now, RoundTrip, Tolerance, MaxRewind, RewindTime));
+    TestEqual(TEXT("无效的旧时间也只回溯MaxRewindTime"), RewindTime, Now - MaxRewind);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "EnemyAIController.generated.h"
+
+class AFPSGameCharacter;
+
+// 敌人AI状态
+UENUM(BlueprintType)
+enum class EEnemyBrainState : uint8
+{
+    // 在出生点附近巡逻
+    Patrol,
+    // 追击看到的玩家
+    Chase,
+    // 在攻击范围内攻击
+    Attack,
+    // 丢失目标后返回出生点
+    Return
+};
+
+// 敌人AI控制器：巡逻/追击/攻击/返回状态机
+// 目标选择由UEnemyTargetSubsystem按固定间隔批量并行计算后回调ApplyThinkResult（不逐帧），移动结束由寻路回调驱动
+// 远距离追击时沿共享流场移动（只在这段时间Tick），接近目标后再用导航网格寻路
+UCLASS(config = Game)
+class FPSGAME_API AEnemyAIController : public AAIController
+{
+    GENERATED_BODY()
+
+public:
+    AEnemyAIController();
+
+    virtual void Tick(float DeltaTime) override;
+    virtual void OnPossess(APawn* InPawn) override;
+    virtual void OnUnPossess() override;
+    virtual void OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result) override;
+
+    // 当前状态
+    UFUNCTION(BlueprintPure, Category = "AI")
+    EEnemyBrainState GetBrainState() const { return BrainState; }
+
+    // 从对象池激活后回到巡逻状态
+    void ResetBrain();
+
+    // 批量目标选择的结果：最近的可见目标、距离以及是否可以出手（游戏线程调用）
+    void ApplyThinkResult(AFPSGameCharacter* Target, float Distance, bool bCanAttack);
+
+protected:
+    // 离出生点超过此距离时放弃追击
+    UPROPERTY(EditAnywhere, Config, Category = "AI")
+    float LeashDistance = 3000.0f;
+
+    // 到达巡逻点/出生点的判定半径
+    UPROPERTY(EditAnywhere, Config, Category = "AI")
+    float AcceptanceRadius = 50.0f;
+
+    // 远距离追击时沿流场移动，不为每个敌人单独寻路
+    UPROPERTY(EditAnywhere, Config, Category = "AI")
+    bool bUseFlowField = true;
+
+    // 离目标小于此距离时改用导航网格直接寻路到目标
+    UPROPERTY(EditAnywhere, Config, Category = "AI")
+    float DirectApproachDistance = 600.0f;
+
+    // 当前状态
+    EEnemyBrainState BrainState;
+
+    // 是否正在沿流场移动
+    bool bFollowingFlowField = false;
+
+    void SetFollowingFlowField(bool bFollow);
+
+    void SetBrainState(EEnemyBrainState NewState);
+
+    // 前往下一个巡逻点
+    void MoveToNextPatrolPoint();
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyFlowFieldSubsystem.generated.h"
+
+// 敌人群体寻路的流场（仅服务器）
+// 把导航网格覆盖的区域划分为二维网格，以所有玩家所在格子为起点做多源广度优先搜索得到距离场，
+// 敌人只需采样所在格子的下降方向即可朝最近的玩家移动。玩家换格子时才重建，重建分摊到多帧，
+// 开销只与玩家数和地图大小有关，与敌人数量无关
+UCLASS(config = Game)
+class FPSGAME_API UEnemyFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 采样Location处朝最近玩家的移动方向（水平单位向量）；流场不可用、不可行走或已在玩家格子时返回false
+    bool GetFlowDirection(const FVector& Location, FVector& OutDirection) const;
+
+    // Location所在格子投影到导航网格上的地面高度；网格未生成或格子不可行走时返回false
+    bool GetGroundHeight(const FVector& Location, float& OutHeight) const;
+
+    // 流场是否已经生成过距离场
+    bool IsFieldReady() const { return bFieldReady; }
+
+    // 打印流场网格大小和重建统计
+    void DumpStats() const;
+
+protected:
+    // 格子边长（厘米）
+    UPROPERTY(Config)
+    float CellSize = 100.0f;
+
+    // 网格格子数上限，地图太大时自动放大格子
+    UPROPERTY(Config)
+    int32 MaxCells = 65536;
+
+    // 相邻格子允许的最大高度差（厘米）
+    UPROPERTY(Config)
+    float MaxStepHeight = 60.0f;
+
+    // 检查玩家是否换格子的间隔（秒）
+    UPROPERTY(Config)
+    float UpdateInterval = 0.2f;
+
+    // 每帧最多处理的格子数（网格生成和距离场重建共用）
+    UPROPERTY(Config)
+    int32 MaxCellsPerTick = 8192;
+
+    static constexpr uint16 UnreachedDistance = MAX_uint16;
+
+    // 网格原点（最小角）和尺寸
+    FVector GridOrigin = FVector::ZeroVector;
+    int32 SizeX = 0;
+    int32 SizeY = 0;
+    float ProjectionHalfHeight = 0.0f;
+
+    // 每个格子投影到导航网格后的高度，不可行走的格子为MAX_flt
+    TArray<float> CellHeights;
+
+    // 网格生成进度（格子游标），-1表示还没开始
+    int32 WalkabilityCursor = INDEX_NONE;
+    bool bGridReady = false;
+
+    // 当前使用的距离场和正在重建的距离场
+    TArray<uint16> Distances;
+    TArray<uint16> BuildDistances;
+
+    // 重建用的广度优先队列
+    TArray<int32> BuildQueue;
+    int32 BuildQueueHead = 0;
+    bool bBuildInProgress = false;
+    bool bFieldReady = false;
+
+    // 当前距离场和正在重建的距离场对应的玩家格子（已排序）
+    TArray<int32> SourceCells;
+    TArray<int32> BuildSourceCells;
+
+    float TimeSinceUpdate = 0.0f;
+    double BuildStartTime = 0.0;
+    double LastBuildSeconds = 0.0;
+    int32 NumBuilds = 0;
+
+    int32 GetCellIndex(int32 X, int32 Y) const { return X + Y * SizeX; }
+    bool WorldToCell(const FVector& Location, int32& OutX, int32& OutY) const;
+    FVector GetCellCenter(int32 CellIndex) const;
+    bool IsWalkable(int32 CellIndex) const { return CellHeights[CellIndex] != MAX_flt; }
+
+    // 两个相邻格子之间能否通行
+    bool CanStep(int32 FromCell, int32 ToCell) const;
+
+    // 从(X, Y)沿Dir方向走到相邻格子是否合法：在网格内、能通行，斜向时两侧格子都可走；合法时输出相邻格子
+    bool CanMove(int32 X, int32 Y, int32 Dir, int32& OutNeighborIndex) const;
+
+    // 根据导航网格范围确定网格大小
+    void InitGrid();
+
+    // 分帧把格子投影到导航网格上
+    void ContinueWalkabilityBuild();
+
+    // 玩家换格子时开始重建距离场
+    void UpdateSources();
+
+    // 分帧推进距离场重建
+    void ContinueFieldBuild();
+};
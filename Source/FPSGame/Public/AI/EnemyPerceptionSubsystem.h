@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+// 视线查询结果
+UENUM(BlueprintType)
+enum class ELineOfSightResult : uint8
+{
+    // 还没有结果（请求已排队）
+    Unknown,
+    Visible,
+    Blocked
+};
+
+// 敌人视觉感知服务（仅服务器）
+// 每帧收集敌人对玩家的视线请求，批量提交异步射线检测，下一帧读取结果并按敌人-玩家对缓存一段时间
+// 敌人查询时直接读缓存，不在游戏线程上做同步射线检测
+UCLASS(config = Game)
+class FPSGAME_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 查询Viewer能否看到Target；缓存过期或没有缓存时排队一次异步检测，并返回上一次的结果
+    ELineOfSightResult QueryLineOfSight(const AActor* Viewer, const AActor* Target);
+
+    // 视线结果的缓存时间（秒）
+    float GetSightCacheLifetime() const { return SightCacheLifetime; }
+
+protected:
+    // 视线结果的缓存时间（秒）
+    UPROPERTY(Config)
+    float SightCacheLifetime = 0.25f;
+
+    // 每帧最多提交的射线数，超出的请求留到下一帧
+    UPROPERTY(Config)
+    int32 MaxTracesPerFrame = 64;
+
+    // 视线检测使用的碰撞通道
+    UPROPERTY(Config)
+    TEnumAsByte<ECollisionChannel> SightTraceChannel = ECC_Visibility;
+
+    struct FSightRequest
+    {
+        TWeakObjectPtr<const AActor> Viewer;
+        TWeakObjectPtr<const AActor> Target;
+        uint64 PairKey = 0;
+    };
+
+    struct FSightInFlight
+    {
+        FTraceHandle Handle;
+        uint64 PairKey = 0;
+    };
+
+    struct FSightCacheEntry
+    {
+        bool bVisible = false;
+        double Time = 0.0;
+        bool bPending = false;
+    };
+
+    // 本帧收集的请求
+    TArray<FSightRequest> PendingRequests;
+
+    // 上一帧提交、本帧读取结果的射线
+    TArray<FSightInFlight> InFlightTraces;
+
+    // 敌人-玩家对的视线缓存
+    TMap<uint64, FSightCacheEntry> SightCache;
+
+    // 上次清理缓存的时间
+    double LastPruneTime = 0.0;
+
+    static uint64 MakePairKey(const AActor* Viewer, const AActor* Target);
+
+    // 读取上一帧提交的射线结果
+    void CollectTraceResults(UWorld* World, double Now);
+
+    // 提交本帧的视线请求
+    void SubmitPendingRequests(UWorld* World);
+
+    // 清理长时间没有被查询的缓存
+    void PruneCache(double Now);
+};
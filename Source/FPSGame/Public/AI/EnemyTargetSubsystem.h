@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Math/ProximityKernels.h"
+#include "EnemyTargetSubsystem.generated.h"
+
+class AFPSGameCharacter;
+class AEnemyAIController;
+
+// 敌人共享的目标数据和批量目标选择
+// 玩家角色在生成/销毁时注册为候选目标，敌人控制器在占有/离开时注册为决策者
+// 每隔ThinkInterval把敌人和玩家的位置、生命值、攻击冷却拍成连续数组，用ParallelFor在工作线程上
+// 计算每个敌人的候选目标和能否出手，再回到游戏线程筛选视线并把结果交给各个控制器
+UCLASS(config = Game)
+class FPSGAME_API UEnemyTargetSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 注册玩家角色（仅服务器）
+    void RegisterTarget(AFPSGameCharacter* Target);
+
+    // 注销玩家角色
+    void UnregisterTarget(AFPSGameCharacter* Target);
+
+    // 当前注册的玩家角色
+    const TArray<AFPSGameCharacter*>& GetTargets() const { return Targets; }
+
+    // 注册参与批量决策的敌人控制器
+    void RegisterEnemy(AEnemyAIController* EnemyController);
+
+    // 注销敌人控制器
+    void UnregisterEnemy(AEnemyAIController* EnemyController);
+
+    // 范围内最近的、存活且视线可见的玩家（视线结果来自敌人感知服务的缓存）
+    AFPSGameCharacter* FindNearestVisibleTarget(const AActor* Seeker, float MaxRange) const;
+
+    // 打印上一次批量更新的耗时
+    void DumpStats() const;
+
+protected:
+    // 批量目标选择的间隔（秒）
+    UPROPERTY(Config)
+    float ThinkInterval = 0.25f;
+
+    // 敌人数少于此值时在游戏线程上直接计算，避免任务调度开销
+    UPROPERTY(Config)
+    int32 MinEnemiesForParallel = 32;
+
+    // 每个工作线程任务至少处理的敌人数
+    UPROPERTY(Config)
+    int32 ParallelBatchSize = 16;
+
+    UPROPERTY()
+    TArray<AFPSGameCharacter*> Targets;
+
+    UPROPERTY()
+    TArray<AEnemyAIController*> EnemyControllers;
+
+    // 每个敌人保留的候选目标数（按距离排序，视线筛选时依次尝试）
+    static constexpr int32 MaxCandidates = 4;
+
+    struct FTargetCandidates
+    {
+        int32 Num = 0;
+        int32 TargetIndex[MaxCandidates];
+        float DistSquared[MaxCandidates];
+        bool bCanAttack[MaxCandidates];
+    };
+
+    // 批量计算用的连续数组（SoA），复用内存避免每次分配
+    struct FTargetSelectionSnapshot
+    {
+        TArray<AEnemyAIController*> Controllers;
+        TArray<FVector> EnemyLocations;
+        TArray<float> ChaseRangeSquared;
+        TArray<float> AttackRangeSquared;
+        TArray<float> AttackCooldowns;
+
+        TArray<AFPSGameCharacter*> Players;
+        FProximityPositions PlayerPositions;
+
+        TArray<FTargetCandidates> Results;
+
+        void Reset();
+    };
+
+    FTargetSelectionSnapshot Snapshot;
+
+    float TimeSinceThink = 0.0f;
+
+    // 上一次批量更新的统计
+    int32 LastBatchEnemies = 0;
+    double LastSnapshotSeconds = 0.0;
+    double LastSelectSeconds = 0.0;
+    double LastApplySeconds = 0.0;
+
+    // 拍快照 -> 并行选择 -> 回写结果
+    void RunTargetSelection();
+
+    // 在游戏线程上采集快照
+    void BuildSnapshot(float Now);
+
+    // 计算单个敌人的候选目标（工作线程调用，只读快照）
+    void SelectCandidates(int32 EnemyIndex);
+
+    // 在游戏线程上筛选视线并把结果交给控制器
+    void ApplyResults();
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WeaponAudioSubsystem.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+
+// 武器音效服务（专用服务器上不创建）
+// 用一组复用的音频组件播放射击声，不再每次射击都创建临时组件
+// 分配声音前先按听者距离剔除；同一个音效同时播放的数量有上限，超出时抢占离听者最远（同距离取最早）的那个
+UCLASS(config = Game)
+class FPSGAME_API UWeaponAudioSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Deinitialize() override;
+
+    // 在指定位置播放音效；被剔除或抢占失败时返回false
+    bool PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, float VolumeMultiplier = 1.0f);
+
+    // 有本服务时走音频池，否则退回UGameplayStatics
+    static void PlayWeaponSound(const UObject* WorldContextObject, USoundBase* Sound, const FVector& Location);
+
+    // 输出池大小和播放/剔除/抢占计数
+    void DumpStats() const;
+
+protected:
+    // 音频组件池的上限
+    UPROPERTY(Config)
+    int32 MaxPooledComponents = 32;
+
+    // 同一个音效同时播放的上限
+    UPROPERTY(Config)
+    int32 MaxVoicesPerSound = 6;
+
+    // 超过该距离（或音效衰减的最大距离，取较小值）的声音不分配
+    UPROPERTY(Config)
+    float MaxAudibleDistance = 6000.0f;
+
+    struct FPooledVoice
+    {
+        TObjectPtr<UAudioComponent> Component = nullptr;
+        TWeakObjectPtr<USoundBase> Sound;
+        double StartTime = 0.0;
+        float ListenerDistanceSquared = 0.0f;
+    };
+
+    // Voices不是UPROPERTY，组件的强引用放在这里防止被回收
+    UPROPERTY(Transient)
+    TArray<TObjectPtr<UAudioComponent>> PooledComponents;
+
+    TArray<FPooledVoice> Voices;
+
+    int32 NumPlayed = 0;
+    int32 NumCulled = 0;
+    int32 NumStolen = 0;
+    int32 NumDropped = 0;
+
+    // 所有本地听者中离Location最近的距离平方；没有听者时返回0（不剔除）
+    float GetListenerDistanceSquared(const FVector& Location) const;
+
+    // 找到可用的语音槽：空闲组件、新建组件或抢占，失败返回INDEX_NONE
+    int32 AcquireVoice(USoundBase* Sound, float DistanceSquared);
+
+    UAudioComponent* CreatePooledComponent();
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotify.h"
+#include "AnimNotify_EnemyMeleeHit.generated.h"
+
+// 敌人攻击动画的命中帧通知：放在攻击蒙太奇的出手帧上，服务器在此帧结算近战伤害
+UCLASS(meta = (DisplayName = "Enemy Melee Hit"))
+class FPSGAME_API UAnimNotify_EnemyMeleeHit : public UAnimNotify
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
+    virtual FString GetNotifyName_Implementation() const override;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "CharacterSignificanceSubsystem.generated.h"
+
+class ACharacter;
+
+// 角色对本地玩家的重要程度，越高更新越频繁
+UENUM(BlueprintType)
+enum class ECharacterSignificance : uint8
+{
+    // 远处且不在视野内：几乎不更新
+    Culled,
+    Low,
+    Medium,
+    // 近处且在视野内：完整更新
+    High
+};
+
+// 客户端角色重要度服务（专用服务器上不创建）
+// 按到本地摄像机的距离和是否在视野内给远程玩家和敌人打分，
+// 按等级调整Actor和网格的Tick间隔、动画更新方式、移动平滑方式，并供表现效果（音效等）查询是否需要播放
+// 只处理模拟代理，本机控制和有权威的角色（如监听服务器上的敌人）保持原样，避免影响AI和动画通知
+// 敌人网格由动画预算分配器管理，这里只把等级换算成分配器的重要度，由分配器在每帧预算内决定更新频率和插值
+UCLASS(config = Game)
+class FPSGAME_API UCharacterSignificanceSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 注册/注销需要按重要度节流的角色
+    void RegisterCharacter(ACharacter* Character);
+    void UnregisterCharacter(ACharacter* Character);
+
+    // 查询角色当前的重要度；没有注册的角色视为High
+    ECharacterSignificance GetSignificance(const AActor* Actor) const;
+
+    // 表现效果是否值得为该Actor播放；没有本服务（如专用服务器）时总是返回true
+    static bool ShouldPlayCosmetics(const AActor* Actor, ECharacterSignificance MinSignificance = ECharacterSignificance::Low);
+
+    // 输出各等级的角色数量
+    void DumpStats() const;
+
+protected:
+    // 重新打分的间隔（秒）
+    UPROPERTY(Config)
+    float UpdateInterval = 0.2f;
+
+    // 在视野内时各等级的距离上限，超过LowDistance为Culled
+    UPROPERTY(Config)
+    float HighDistance = 1500.0f;
+
+    UPROPERTY(Config)
+    float MediumDistance = 4000.0f;
+
+    UPROPERTY(Config)
+    float LowDistance = 8000.0f;
+
+    // 摄像机朝向与目标方向夹角的余弦大于该值时算在视野内
+    UPROPERTY(Config)
+    float ViewConeCos = 0.5f;
+
+    // 不在视野内时距离乘以该系数再分级
+    UPROPERTY(Config)
+    float OutOfViewDistanceScale = 2.5f;
+
+    // 升级时距离需要再低于阈值的比例，避免在边界来回切换
+    UPROPERTY(Config)
+    float Hysteresis = 0.1f;
+
+    // Medium/Low/Culled等级的Actor和网格Tick间隔（秒），High为0即每帧
+    UPROPERTY(Config)
+    float MediumTickInterval = 0.033f;
+
+    UPROPERTY(Config)
+    float LowTickInterval = 0.1f;
+
+    UPROPERTY(Config)
+    float CulledTickInterval = 0.5f;
+
+    // 动画预算分配器每帧用于角色动画的时间（毫秒）
+    UPROPERTY(Config)
+    float AnimationBudgetMs = 1.0f;
+
+    // 动画预算紧张时最低的更新频率（每N帧更新一次）
+    UPROPERTY(Config)
+    int32 MaxAnimationTickRate = 10;
+
+    struct FSignificanceEntry
+    {
+        TWeakObjectPtr<ACharacter> Character;
+        ECharacterSignificance Significance = ECharacterSignificance::High;
+
+        // 注册时的原始设置，回到High时恢复
+        float ActorTickInterval = 0.0f;
+        float MeshTickInterval = 0.0f;
+        float MovementTickInterval = 0.0f;
+        EVisibilityBasedAnimTickOption AnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPose;
+        ENetworkSmoothingMode SmoothingMode = ENetworkSmoothingMode::Exponential;
+    };
+
+    TArray<FSignificanceEntry> Entries;
+
+    // 上次打分的时间
+    double LastUpdateTime = 0.0;
+
+    // 本地玩家的视点
+    TArray<FTransform, TInlineAllocator<4>> Viewpoints;
+
+    void GatherViewpoints(UWorld* World);
+
+    ECharacterSignificance ComputeSignificance(const ACharacter* Character, ECharacterSignificance Current) const;
+
+    float GetTickInterval(ECharacterSignificance Significance) const;
+
+    // 等级换算成动画预算分配器的重要度
+    static float GetAnimationSignificance(ECharacterSignificance Significance);
+
+    // 把重要度交给预算网格；有权威的角色不跳帧，保证动画通知按时触发
+    static void ApplyBudgetedSignificance(ACharacter* Character, ECharacterSignificance Significance);
+
+    void ApplySignificance(FSignificanceEntry& Entry, ECharacterSignificance NewSignificance) const;
+
+    const FSignificanceEntry* FindEntry(const AActor* Actor) const;
+};
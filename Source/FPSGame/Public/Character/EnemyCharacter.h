@@ -1,145 +1,229 @@
-#pragma once
-#include "CoreMinimal.h"
-#include "GenericTeamAgentInterface.h"
-#include "GameFramework/Character.h"
-#include "Perception/AIPerceptionTypes.h"
-#include "Perception/AIPerceptionComponent.h"
-#include "Perception/AISenseConfig_Sight.h"
-#include "Components/SphereComponent.h"
-#include "FPSGame/FPSGameCharacter.h"
-#include "EnemyCharacter.generated.h"
-
-UCLASS()
-class FPSGAME_API AEnemyCharacter : public ACharacter, public IGenericTeamAgentInterface
-{
-    GENERATED_BODY()
-
-public:
-    AEnemyCharacter();
-
-    // 重写UE的TakeDamage函数，接收子弹的ApplyDamage调用
-    virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
-
-    // 服务器端处理伤害（RPC）
-    UFUNCTION(Server, Reliable, WithValidation)
-    void Server_TakeDamage(float DamageAmount, AController* InstigatorController);
-    virtual void Server_TakeDamage_Implementation(float DamageAmount, AController* KillerController);
-    virtual bool Server_TakeDamage_Validate(float DamageAmount, AController* KillerController);
-
-    // 多播通知死亡（RPC）
-    UFUNCTION(NetMulticast, Reliable, WithValidation)
-    void Multicast_Die(AController* KillerController);
-    virtual void Multicast_Die_Implementation(AController* KillerController);
-    virtual bool Multicast_Die_Validate(AController* KillerController);
-
-    // 获取当前生命值
-    UFUNCTION(BlueprintPure, Category = "Health")
-    float GetCurrentHealth() const { return CurrentHealth; }
-
-    // 获取最大生命值
-    UFUNCTION(BlueprintCallable, Category = "Combat")
-    float GetMaxHealth() const { return MaxHealth; }
-
-    // 设置击杀者
-    UFUNCTION(BlueprintCallable, Category = "Combat")
-    void SetEnemyKiller(AController* NewKiller);
-
-    // 获取击杀者
-    UFUNCTION(BlueprintCallable, Category = "Combat")
-    AController* GetEnemyKiller() const { return KillerControllerRef; }
-
-protected:
-    virtual void BeginPlay() override;
-    virtual void Tick(float DeltaTime) override;
-
-    // 定时器句柄
-    FTimerHandle AttackCollisionTimerHandle;
-
-
-    // 攻击碰撞重叠回调
-    UFUNCTION()
-    void OnAttackCollisionOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-
-    //寻找有效攻击玩家
-    UFUNCTION(BlueprintCallable, Category = "AI|Targeting")
-    void FindValidPlayerTarget();
-
-    //是否可攻击
-    UFUNCTION(BlueprintCallable, Category = "AI|Combat")
-    bool CanAttack();
-
-    // 攻击目标（核心战斗函数，蓝图可直接调用）
-    UFUNCTION(BlueprintCallable, Category = "AI|Combat")
-    void AttackTarget();
-
-private:
-    // 攻击碰撞体
-    UPROPERTY(VisibleAnywhere, Category = "Combat")
-    class USphereComponent* AttackCollision;
-
-
-    // 当前生命值
-    UPROPERTY(Replicated, VisibleAnywhere, Category = "Health")
-    float CurrentHealth;
-
-    // 最大生命值
-    UPROPERTY(EditAnywhere, Category = "Health")
-    float MaxHealth;
-
-    // 追击范围（蓝图可编辑）
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
-    float ChaseRange;
-
-    // 攻击范围
-    UPROPERTY(EditAnywhere, Category = "Combat")
-    float AttackRange;
-
-    // 攻击伤害
-    UPROPERTY(EditAnywhere, Category = "Combat")
-    float AttackDamage;
-
-    // 攻击间隔
-    UPROPERTY(EditAnywhere, Category = "Combat")
-    float AttackInterval;
-
-    UPROPERTY()
-    AController* KillerControllerRef = nullptr;
-
-    // 上次攻击时间
-    float LastAttackTime;
-
-    // 当前锁定的玩家目标
-    UPROPERTY()
-    AFPSGameCharacter* CurrentTargetPlayer;
-
-    // 巡逻点
-    UPROPERTY(EditAnywhere, Category = "AI")
-    TArray<FVector> PatrolPoints;
-
-    // 巡逻点最大数量（防止内存泄漏）
-    UPROPERTY(EditAnywhere, Category = "AI")
-    int32 MaxPatrolPoints = 5;
-
-    // 当前巡逻点索引
-    int32 CurrentPatrolPointIndex;
-
-    // 巡逻半径
-    UPROPERTY(EditAnywhere, Category = "AI")
-    float PatrolRadius;
-
-    // 是否在巡逻
-    bool bIsPatrolling;
-
-    // 死亡状态
-    UPROPERTY(Replicated, VisibleAnywhere, Category = "Health")
-    bool bIsDead;
-
-    // 记录击杀者控制器（用于分数结算）
-    AController* KillerInstigator;
-
-    public:
-        // 网络复制函数
-        virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
-
+#pragma once
+#include "CoreMinimal.h"
+#include "GenericTeamAgentInterface.h"
+#include "GameFramework/Character.h"
+#include "FPSGame/FPSGameCharacter.h"
+#include "Character/EnemyMovementSnapshot.h"
+#include "EnemyCharacter.generated.h"
+
+UCLASS()
+class FPSGAME_API AEnemyCharacter : public ACharacter, public IGenericTeamAgentInterface
+{
+    GENERATED_BODY()
+
+public:
+    AEnemyCharacter(const FObjectInitializer& ObjectInitializer);
+
+    // 重写UE的TakeDamage函数，接收子弹的ApplyDamage调用
+    virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
+
+    // 服务器端处理伤害（RPC）
+    UFUNCTION(Server, Reliable, WithValidation)
+    void Server_TakeDamage(float DamageAmount, AController* InstigatorController);
+    virtual void Server_TakeDamage_Implementation(float DamageAmount, AController* KillerController);
+    virtual bool Server_TakeDamage_Validate(float DamageAmount, AController* KillerController);
+
+    // 多播通知死亡（RPC）
+    UFUNCTION(NetMulticast, Reliable, WithValidation)
+    void Multicast_Die(AController* KillerController);
+    virtual void Multicast_Die_Implementation(AController* KillerController);
+    virtual bool Multicast_Die_Validate(AController* KillerController);
+
+    // 获取当前生命值
+    UFUNCTION(BlueprintPure, Category = "Health")
+    float GetCurrentHealth() const { return CurrentHealth; }
+
+    // 获取最大生命值
+    UFUNCTION(BlueprintCallable, Category = "Combat")
+    float GetMaxHealth() const { return MaxHealth; }
+
+    // 设置击杀者
+    UFUNCTION(BlueprintCallable, Category = "Combat")
+    void SetEnemyKiller(AController* NewKiller);
+
+    // 获取击杀者
+    UFUNCTION(BlueprintCallable, Category = "Combat")
+    AController* GetEnemyKiller() const { return KillerControllerRef; }
+
+    // 是否已死亡（或在对象池中）
+    UFUNCTION(BlueprintPure, Category = "Health")
+    bool IsDead() const { return bIsDead; }
+
+    // 从对象池中激活：重置生命值和状态并放到指定位置（仅服务器）
+    void ActivateFromPool(const FVector& Location, const FRotator& Rotation);
+
+    // 回收到对象池：隐藏、关闭碰撞和逻辑，并进入网络休眠（仅服务器）
+    void DeactivateToPool();
+
+    // 攻击命中帧：在攻击点做一次球形重叠查询并结算伤害（仅服务器，由动画通知或攻击时序触发）
+    void ResolveMeleeHit();
+
+    // 出生/激活时的位置（巡逻中心和返回点）
+    const FVector& GetHomeLocation() const { return HomeLocation; }
+
+    // 追击范围
+    float GetChaseRange() const { return ChaseRange; }
+
+    // 攻击范围
+    float GetAttackRange() const { return AttackRange; }
+
+    // 攻击伤害
+    float GetAttackDamage() const { return AttackDamage; }
+
+    // 攻击间隔
+    float GetAttackInterval() const { return AttackInterval; }
+
+    // 设置当前生命值（后台敌人提升为Actor时带上原来的生命值，仅服务器）
+    void SetCurrentHealth(float NewHealth) { CurrentHealth = FMath::Clamp(NewHealth, 1.0f, MaxHealth); }
+
+    // 距离下次可以出手的剩余时间（秒）
+    float GetAttackCooldownRemaining(float Now) const { return FMath::Max(0.0f, LastAttackTime + AttackInterval - Now); }
+
+    // 设置当前锁定的玩家目标（由AI控制器选择）
+    void SetCurrentTarget(AFPSGameCharacter* NewTarget) { CurrentTargetPlayer = NewTarget; }
+
+    // 设置是否在巡逻
+    void SetPatrolling(bool bNewPatrolling) { bIsPatrolling = bNewPatrolling; }
+
+    // 获取下一个巡逻点，第一次调用时在出生点附近的导航网格上生成巡逻点
+    bool GetNextPatrolPoint(FVector& OutPoint);
+
+    //是否可攻击
+    UFUNCTION(BlueprintCallable, Category = "AI|Combat")
+    bool CanAttack();
+
+    // 攻击目标（核心战斗函数，蓝图可直接调用）
+    UFUNCTION(BlueprintCallable, Category = "AI|Combat")
+    void AttackTarget();
+
+    // 按离最近玩家的距离调整移动快照的发送频率（仅服务器）
+    void UpdateNetUpdateRate(float NearestPlayerDistance);
+
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+    virtual void Tick(float DeltaSeconds) override;
+
+    // 远处被墙挡住的敌人对该连接不相关，近处被挡住的降低优先级
+    virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+    virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // 攻击命中帧定时器句柄
+    FTimerHandle AttackHitTimerHandle;
+
+
+    //寻找有效攻击玩家
+    UFUNCTION(BlueprintCallable, Category = "AI|Targeting")
+    void FindValidPlayerTarget();
+
+private:
+    // 攻击动画（带EnemyMeleeHit通知时由通知结算伤害）
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    class UAnimMontage* AttackMontage;
+
+    // 没有攻击动画时，攻击开始到命中帧的时间（秒）
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    float AttackHitDelay;
+
+    // 命中判定球半径
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    float AttackHitRadius;
+
+    // 命中判定的骨骼插槽（没有该插槽时用角色前方）
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    FName AttackSocketName;
+
+
+    // 当前生命值
+    UPROPERTY(Replicated, VisibleAnywhere, Category = "Health")
+    float CurrentHealth;
+
+    // 最大生命值
+    UPROPERTY(EditAnywhere, Category = "Health")
+    float MaxHealth;
+
+    // 追击范围（蓝图可编辑）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
+    float ChaseRange;
+
+    // 攻击范围
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    float AttackRange;
+
+    // 攻击伤害
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    float AttackDamage;
+
+    // 攻击间隔
+    UPROPERTY(EditAnywhere, Category = "Combat")
+    float AttackInterval;
+
+    UPROPERTY()
+    AController* KillerControllerRef = nullptr;
+
+    // 上次攻击时间
+    float LastAttackTime;
+
+    // 当前锁定的玩家目标
+    UPROPERTY()
+    AFPSGameCharacter* CurrentTargetPlayer;
+
+    // 巡逻点
+    UPROPERTY(EditAnywhere, Category = "AI")
+    TArray<FVector> PatrolPoints;
+
+    // 巡逻点最大数量（防止内存泄漏）
+    UPROPERTY(EditAnywhere, Category = "AI")
+    int32 MaxPatrolPoints = 5;
+
+    // 当前巡逻点索引
+    int32 CurrentPatrolPointIndex;
+
+    // 巡逻半径
+    UPROPERTY(EditAnywhere, Category = "AI")
+    float PatrolRadius;
+
+    // 是否在巡逻
+    bool bIsPatrolling;
+
+    // 巡逻中心和返回点
+    FVector HomeLocation;
+
+    // 死亡状态
+    UPROPERTY(Replicated, VisibleAnywhere, Category = "Health")
+    bool bIsDead;
+
+    // 记录击杀者控制器（用于分数结算）
+    AController* KillerInstigator;
+
+    // 移动快照：代替ACharacter默认的移动复制，客户端放进抖动缓冲后插值显示
+    UPROPERTY(ReplicatedUsing = OnRep_MovementSnapshot)
+    FEnemyMovementSnapshot MovementSnapshot;
+
+    UFUNCTION()
+    void OnRep_MovementSnapshot();
+
+    // 客户端的快照缓冲
+    FEnemySnapshotBuffer SnapshotBuffer;
+
+    // 快照发送频率范围（Hz），离玩家越近越高
+    UPROPERTY(EditAnywhere, Category = "Network")
+    float MinSnapshotRate = 10.0f;
+
+    UPROPERTY(EditAnywhere, Category = "Network")
+    float MaxSnapshotRate = 20.0f;
+
+    // 距离不超过Near时用最高频率，超过Far时用最低频率
+    UPROPERTY(EditAnywhere, Category = "Network")
+    float SnapshotRateNearDistance = 1500.0f;
+
+    UPROPERTY(EditAnywhere, Category = "Network")
+    float SnapshotRateFarDistance = 6000.0f;
+
+    public:
+        // 网络复制函数
+        virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 };
\ No newline at end of file
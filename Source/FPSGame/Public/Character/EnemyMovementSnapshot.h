@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Iris/Serialization/NetSerializer.h"
+#include "EnemyMovementSnapshot.generated.h"
+
+// 敌人移动快照（服务器->客户端）
+// 位置按厘米量化，Yaw量化到8位，时间戳为服务器时间的16位毫秒（约65秒回绕一次，客户端展开）
+// 传送计数变化时客户端清空缓冲直接跳到新位置（例如对象池重新激活）
+USTRUCT()
+struct FPSGAME_API FEnemyMovementSnapshot
+{
+    GENERATED_BODY()
+
+    FVector Location = FVector::ZeroVector;
+
+    float Yaw = 0.0f;
+
+    uint16 ServerTimeMs = 0;
+
+    uint8 TeleportCounter = 0;
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+    // 成员不是UPROPERTY，旧复制路径靠这个判断快照是否变化
+    bool operator==(const FEnemyMovementSnapshot& Other) const
+    {
+        return Location == Other.Location && Yaw == Other.Yaw && ServerTimeMs == Other.ServerTimeMs && TeleportCounter == Other.TeleportCounter;
+    }
+};
+
+template<>
+struct TStructOpsTypeTraits<FEnemyMovementSnapshot> : public TStructOpsTypeTraitsBase2<FEnemyMovementSnapshot>
+{
+    enum
+    {
+        WithNetSerializer = true,
+        WithIdenticalViaEquality = true
+    };
+};
+
+// Iris下快照的序列化器配置（没有可调参数）
+USTRUCT()
+struct FEnemyMovementSnapshotNetSerializerConfig : public FNetSerializerConfig
+{
+    GENERATED_BODY()
+};
+
+#if UE_WITH_IRIS
+namespace UE::Net
+{
+    // Iris使用的快照序列化器：字段和量化精度与NetSerialize一致，但线上格式不同
+    // （这里按ZigZag加5位长度前缀写位置，旧复制路径用SerializePackedVector<1, 20>），两条路径的包不能互相解析
+    UE_NET_DECLARE_SERIALIZER(FEnemyMovementSnapshotNetSerializer, FPSGAME_API);
+}
+#endif
+
+// 客户端抖动缓冲：按服务器时间排序保存最近的快照，渲染时间落后最新快照一段延迟，在前后两个快照之间插值
+// 16位时间戳按本地估计的服务器时间展开，敌人静止很久（超过半圈）后再动也能正确排序
+struct FPSGAME_API FEnemySnapshotBuffer
+{
+    // 收到新快照，本地时间为LocalTime；返回false表示是传送，调用方应直接跳到快照位置
+    bool AddSnapshot(const FEnemyMovementSnapshot& Snapshot, double LocalTime);
+
+    // 计算LocalTime时刻应显示的位置、朝向和速度；缓冲为空时返回false
+    bool Sample(double LocalTime, FVector& OutLocation, float& OutYaw, FVector& OutVelocity) const;
+
+    void Reset();
+
+    bool IsEmpty() const { return Entries.IsEmpty(); }
+
+    // 插值延迟的范围（秒），实际延迟为快照平均间隔的两倍
+    float MinInterpolationDelay = 0.1f;
+    float MaxInterpolationDelay = 0.3f;
+
+    // 缓冲用完后最多外推的时间（秒）
+    float MaxExtrapolation = 0.1f;
+
+private:
+    struct FEntry
+    {
+        double ServerTime = 0.0;
+        FVector Location = FVector::ZeroVector;
+        float Yaw = 0.0f;
+    };
+
+    static constexpr int32 MaxEntries = 8;
+
+    TArray<FEntry, TInlineAllocator<MaxEntries>> Entries;
+
+    // 服务器时间 - 本地时间 的平滑估计
+    double ClockOffset = 0.0;
+
+    // 快照平均间隔
+    double AverageInterval = 0.1;
+
+    uint8 LastTeleportCounter = 0;
+
+    bool bHasClock = false;
+};
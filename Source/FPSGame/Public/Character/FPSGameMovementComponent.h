@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/CharacterMovementReplication.h"
+#include "FPSGameMovementComponent.generated.h"
+
+// 压缩后的上行移动数据
+// 加速度按MaxAcceleration量化到每轴8位（地面移动不发Z），视角只发16位Yaw+16位Pitch（旧移动各8位），
+// 客户端位置、移动基础和移动模式只在服务器做误差校验的新移动里发送，移动模式是行走时只占1位
+// 新移动另带16位的同步服务器时间戳（见UTimeSyncComponent）
+struct FPSGAME_API FFPSGameNetworkMoveData : public FCharacterNetworkMoveData
+{
+    uint16 ServerTime = 0;
+
+    virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+    virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FPSGAME_API FFPSGameNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+    FFPSGameNetworkMoveDataContainer();
+
+    FFPSGameNetworkMoveData MoveData[3];
+};
+
+// FPSGame角色移动组件：压缩上行移动格式，并预留冲刺等自定义标志位
+UCLASS(config = Game)
+class FPSGAME_API UFPSGameMovementComponent : public UCharacterMovementComponent
+{
+    GENERATED_BODY()
+
+public:
+    UFPSGameMovementComponent();
+
+    // 自定义移动标志：冲刺占用FLAG_Custom_0，FLAG_Custom_1~3留给以后的状态
+    static constexpr uint8 FLAG_WantsToSprint = FSavedMove_Character::FLAG_Custom_0;
+
+    virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+    virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+    virtual float GetMaxSpeed() const override;
+
+    // 客户端预测时使用和上传后一样的量化加速度，避免服务器校验出偏差
+    virtual FVector RoundAcceleration(FVector InAccel) const override;
+
+    // 加速度每轴量化到[-127, 127]
+    static int8 QuantizeAccelerationAxis(double Value, float MaxAccel);
+    static double DequantizeAccelerationAxis(int8 Value, float MaxAccel);
+
+    // 设置冲刺意图（本地客户端调用，随移动标志同步到服务器）
+    void SetWantsToSprint(bool bNewWantsToSprint) { bWantsToSprint = bNewWantsToSprint; }
+    bool WantsToSprint() const { return bWantsToSprint; }
+
+    // 上行带宽基准：对比引擎默认格式和压缩格式在给定客户端数下的上行流量
+    static void RunBandwidthBenchmark(int32 NumClients);
+
+    // 服务器：最近处理的新移动在客户端发生时的服务器时间（已校验并限制回溯范围，供延迟补偿回溯）
+    double GetLastMoveServerTime() const { return LastMoveServerTime; }
+
+protected:
+    virtual void ServerMove_PerformMovement(const FCharacterNetworkMoveData& MoveData) override;
+
+    // 冲刺时的速度倍率
+    UPROPERTY(Config, EditAnywhere, Category = "Character Movement: Walking")
+    float SprintSpeedMultiplier = 1.5f;
+
+    uint8 bWantsToSprint : 1;
+
+    double LastMoveServerTime = 0.0;
+
+    FFPSGameNetworkMoveDataContainer MoveDataContainer;
+};
+
+class FPSGAME_API FSavedMove_FPSGame : public FSavedMove_Character
+{
+public:
+    typedef FSavedMove_Character Super;
+
+    FSavedMove_FPSGame();
+
+    virtual void Clear() override;
+    virtual uint8 GetCompressedFlags() const override;
+    virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+    virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+    virtual void PrepMoveFor(ACharacter* C) override;
+
+    uint8 bSavedWantsToSprint : 1;
+
+    // 移动开始时同步后的服务器时间（16位压缩）
+    uint16 SavedServerTime = 0;
+};
+
+class FPSGAME_API FNetworkPredictionData_Client_FPSGame : public FNetworkPredictionData_Client_Character
+{
+public:
+    typedef FNetworkPredictionData_Client_Character Super;
+
+    FNetworkPredictionData_Client_FPSGame(const UCharacterMovementComponent& ClientMovement);
+
+    virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -1,127 +1,277 @@
-#pragma once
-#include "CoreMinimal.h"
-#include "GameFramework/GameModeBase.h"
-#include "MyGameMode.generated.h"
-class AEnemyCharacter;
-class AMyPlayerState;
-UCLASS()
-class FPSGAME_API AMyGameMode : public AGameModeBase
-{
-    GENERATED_BODY()
-
-public:
-    AMyGameMode();
-
-    // 必须重写的函数
-    virtual void BeginPlay() override;
-    virtual void PostLogin(APlayerController* NewPlayer) override;
-    virtual void Logout(AController* Exiting) override;
-    virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
-
-    // 选择玩家出生点（这个不是虚函数，不需要override）
-    AActor* ChoosePlayerStartForController(AController* Player);
-
-    // 检查是否有胜利者
-    void CheckForWinner();
-    
-    //得分统计
-    void PrintScoreboard();
-
-    // 生成敌人
-    void SpawnEnemy();
-
-    // 敌人死亡时的回调
-    void OnEnemyDeath(AEnemyCharacter* DeadEnemy);
-
-    // 玩家死亡时的处理
-    void OnPlayerDeath(class AFPSGameCharacter* DeadPlayer);
-
-    // 测试：给指定玩家加分
-    UFUNCTION(Exec, Category = "Debug")
-    void AddScoreToPlayer(int32 PlayerIndex, int32 Score);
-
-    // 显示得分榜
-    UFUNCTION(Exec, Category = "Debug")
-    void DebugScore();
-
-    // 调试函数
-    UFUNCTION(Exec, Category = "Debug")
-    void DebugPlayers();
-
-    // 测试加分功能
-    UFUNCTION(Exec, Category = "Debug")
-    void TestScore();
-
-    // 给所有玩家加测试分
-    UFUNCTION(Exec, Category = "Debug")
-    void AddTestScoreToAll();
-
-    // 模拟击杀敌人测试
-    UFUNCTION(Exec, Category = "Debug")
-    void TestKill();
-
-protected:
-    // 敌人类型
-    UPROPERTY(EditAnywhere, Category = "Enemy")
-    TSubclassOf<class AEnemyCharacter> EnemyClass;
-
-    // 玩家类型
-    UPROPERTY(EditAnywhere, Category = "Game")
-    TSubclassOf<class AFPSGameCharacter> PlayerClass;
-
-    // 生成点数组
-    UPROPERTY(EditAnywhere, Category = "Enemy")
-    TArray<class AActor*> SpawnPoints;
-
-    // 最大敌人数量
-    UPROPERTY(EditAnywhere, Category = "Enemy")
-    int32 MaxEnemies;
-
-    // 当前敌人数量
-    int32 CurrentEnemyCount;
-
-    // 当前存活的玩家数量
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game")
-    int32 CurrentAlivePlayers;
-
-    // 生成敌人的时间间隔
-    UPROPERTY(EditAnywhere, Category = "Enemy")
-    float SpawnInterval;
-
-    // 游戏持续时间（秒）
-    UPROPERTY(EditAnywhere, Category = "Game")
-    float GameDuration;
-
-    // 剩余时间
-    float RemainingTime;
-
-    // 游戏是否已结束
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game")
-    bool bGameEnded = false;
-
-    // 玩家重生点数组
-    UPROPERTY()
-    TArray<class APlayerStart*> PlayerStarts;
-
-    // 定时器句柄
-    FTimerHandle SpawnEnemyTimerHandle;
-    FTimerHandle CheckWinnerTimerHandle;
-    FTimerHandle GameTimerHandle;
-
-    // 更新游戏时间
-    void UpdateGameTime();
-
-    // 游戏结束
-    void EndGame(const FString& EndReason);
-
-    
-
-    // 获取存活的玩家
-    TArray<class AFPSGameCharacter*> GetAlivePlayers();
-
-    // 玩家重生
-    void SpawnPlayerCharacter(APlayerController* PlayerController);
-
-    // 查找所有玩家重生点
-    void FindPlayerStarts();
+#pragma once
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "MyGameMode.generated.h"
+class AEnemyCharacter;
+class AMyPlayerState;
+
+// 单局结果记录
+USTRUCT(BlueprintType)
+struct FRoundRecord
+{
+    GENERATED_BODY()
+
+    // 第几局
+    UPROPERTY(BlueprintReadOnly, Category = "Game")
+    int32 RoundNumber = 0;
+
+    // 本局持续时间（秒）
+    UPROPERTY(BlueprintReadOnly, Category = "Game")
+    float Duration = 0.0f;
+
+    // 结束原因
+    UPROPERTY(BlueprintReadOnly, Category = "Game")
+    FString EndReason;
+
+    // 胜利者名称（没有胜利者时为空）
+    UPROPERTY(BlueprintReadOnly, Category = "Game")
+    FString WinnerName;
+
+    // 胜利者得分
+    UPROPERTY(BlueprintReadOnly, Category = "Game")
+    float WinnerScore = 0.0f;
+
+    // 本局击杀敌人数
+    UPROPERTY(BlueprintReadOnly, Category = "Game")
+    int32 EnemiesKilled = 0;
+};
+
+UCLASS()
+class FPSGAME_API AMyGameMode : public AGameModeBase
+{
+    GENERATED_BODY()
+
+public:
+    AMyGameMode();
+
+    // 必须重写的函数
+    virtual void BeginPlay() override;
+    virtual void PostLogin(APlayerController* NewPlayer) override;
+    virtual void Logout(AController* Exiting) override;
+    virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+    virtual void HandleSeamlessTravelPlayer(AController*& C) override;
+
+    // 选择玩家出生点（这个不是虚函数，不需要override）
+    // bOutCollisionFree为true时出生点上没有其他角色，可以直接生成不做碰撞调整
+    AActor* ChoosePlayerStartForController(AController* Player, bool* bOutCollisionFree = nullptr);
+
+    // 检查是否有胜利者
+    void CheckForWinner();
+    
+    //得分统计
+    void PrintScoreboard();
+
+    // 生成敌人
+    void SpawnEnemy();
+
+    // 敌人死亡时的回调
+    void OnEnemyDeath(AEnemyCharacter* DeadEnemy);
+
+    // 玩家死亡时的处理
+    void OnPlayerDeath(class AFPSGameCharacter* DeadPlayer);
+
+    // 敌人死亡后回收到对象池
+    void ReleaseEnemy(AEnemyCharacter* Enemy);
+
+    // 后台敌人靠近玩家时提升为Actor敌人，位置投影到导航网格并避开碰撞；场上敌人已满或放不下时返回nullptr
+    AEnemyCharacter* PromoteBackgroundEnemy(const FVector& Location, const FRotator& Rotation, float Health);
+
+    // 获取历史对局记录
+    const TArray<FRoundRecord>& GetRoundHistory() const { return RoundHistory; }
+
+    // 原地开始新的一局（不重新加载关卡）
+    UFUNCTION(Exec, Category = "Debug")
+    void RestartRound();
+
+    // 打印历史对局记录
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugRoundHistory();
+
+    // 打印敌人流场统计
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugFlowField();
+
+    // 打印敌人批量目标选择的耗时
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugEnemyBrain();
+
+    // 距离计算微基准：对比标量和向量化实现
+    UFUNCTION(Exec, Category = "Debug")
+    void BenchProximity(int32 Iterations = 200);
+
+    // 上行移动带宽基准：对比默认和压缩的移动格式（32/64个客户端）
+    UFUNCTION(Exec, Category = "Debug")
+    void BenchMoveBandwidth();
+
+    // 服务器复制基准：采样流量和复制耗时并写出CSV（分别用Iris和旧复制路径各跑一次对比）
+    UFUNCTION(Exec, Category = "Debug")
+    void BenchReplication(float Seconds = 30.0f);
+
+    // 输出每个连接因遮挡被剔除和降优先级的角色数
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugNetOcclusion();
+
+    // 输出服务器每个连接上一秒各RPC和跟踪属性的流量
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugNetAccounting();
+
+    // 输出每个玩家的时间同步状态（服务器时间和Ping）
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugTimeSync();
+
+    // 测试：给指定玩家加分
+    UFUNCTION(Exec, Category = "Debug")
+    void AddScoreToPlayer(int32 PlayerIndex, int32 Score);
+
+    // 显示得分榜
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugScore();
+
+    // 调试函数
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugPlayers();
+
+    // 测试加分功能
+    UFUNCTION(Exec, Category = "Debug")
+    void TestScore();
+
+    // 给所有玩家加测试分
+    UFUNCTION(Exec, Category = "Debug")
+    void AddTestScoreToAll();
+
+    // 模拟击杀敌人测试
+    UFUNCTION(Exec, Category = "Debug")
+    void TestKill();
+
+protected:
+    // 敌人类型
+    UPROPERTY(EditAnywhere, Category = "Enemy")
+    TSubclassOf<class AEnemyCharacter> EnemyClass;
+
+    // 玩家类型
+    UPROPERTY(EditAnywhere, Category = "Game")
+    TSubclassOf<class AFPSGameCharacter> PlayerClass;
+
+    // 生成点数组
+    UPROPERTY(EditAnywhere, Category = "Enemy")
+    TArray<class AActor*> SpawnPoints;
+
+    // 最大敌人数量
+    UPROPERTY(EditAnywhere, Category = "Enemy")
+    int32 MaxEnemies;
+
+    // 当前敌人数量
+    int32 CurrentEnemyCount;
+
+    // 场上Actor敌人满了之后，额外以Mass实体形式存在的后台敌人上限（0表示不使用后台敌人）
+    UPROPERTY(EditAnywhere, Category = "Enemy")
+    int32 MaxBackgroundEnemies;
+
+    // 当前存活的玩家数量
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game")
+    int32 CurrentAlivePlayers;
+
+    // 生成敌人的时间间隔
+    UPROPERTY(EditAnywhere, Category = "Enemy")
+    float SpawnInterval;
+
+    // 出生点评分的刷新间隔（秒）
+    UPROPERTY(EditAnywhere, Category = "Game")
+    float SpawnScoreRefreshInterval;
+
+    // 游戏持续时间（秒），剩余时间由AMyGameState按同步后的服务器时间计算
+    UPROPERTY(EditAnywhere, Category = "Game")
+    float GameDuration;
+
+    // 游戏是否已结束
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game")
+    bool bGameEnded = false;
+
+    // 下一局的地图（结算阶段预加载，然后无缝旅行过去）
+    UPROPERTY(EditAnywhere, Category = "Game")
+    FString NextMapName;
+
+    // 结算阶段时长（秒），结束后切换到下一局
+    UPROPERTY(EditAnywhere, Category = "Game")
+    float ScoreboardDuration;
+
+    // 每张地图连续进行的局数，达到后切换到NextMapName（0表示一直在当前地图原地重开）
+    UPROPERTY(EditAnywhere, Category = "Game")
+    int32 RoundsPerMap;
+
+    // 保留的历史对局记录上限
+    UPROPERTY(EditAnywhere, Category = "Game")
+    int32 MaxRoundHistory;
+
+    // 当前局数（从1开始）
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game")
+    int32 CurrentRound;
+
+    // 本局开始时间
+    float RoundStartTime;
+
+    // 本局击杀敌人数
+    int32 EnemiesKilledThisRound;
+
+    // 历史对局记录
+    TArray<FRoundRecord> RoundHistory;
+
+    // 场上激活的敌人
+    UPROPERTY()
+    TArray<AEnemyCharacter*> ActiveEnemies;
+
+    // 对象池中待复用的敌人
+    UPROPERTY()
+    TArray<AEnemyCharacter*> PooledEnemies;
+
+    // 玩家重生点数组
+    UPROPERTY()
+    TArray<class APlayerStart*> PlayerStarts;
+
+    // 定时器句柄
+    FTimerHandle SpawnEnemyTimerHandle;
+    FTimerHandle CheckWinnerTimerHandle;
+    FTimerHandle MatchEndTimerHandle;
+    FTimerHandle MatchTransitionTimerHandle;
+    FTimerHandle RoundRestartTimerHandle;
+    FTimerHandle SpawnScoreTimerHandle;
+    FTimerHandle DemoteEnemiesTimerHandle;
+
+    // 启动本局的定时器（生成敌人、结束时间、胜负检查）
+    void StartRoundTimers();
+
+    // 从对象池取出敌人，池中没有时新生成
+    AEnemyCharacter* AcquireEnemy(const FVector& Location, const FRotator& Rotation, bool bCollisionFree);
+
+    // 用当前玩家和敌人的位置刷新出生点评分和占用
+    void RefreshSpawnScores();
+
+    // 把空闲且远离所有玩家的Actor敌人降级为后台敌人，腾出Actor名额
+    void DemoteDistantEnemies();
+
+    // 记录本局结果
+    void RecordRound(const FString& EndReason, AMyPlayerState* Winner);
+
+    // 本局时间到
+    void OnMatchTimeUp();
+
+    // 游戏结束
+    void EndGame(const FString& EndReason);
+
+    // 结算结束，切换到下一局地图
+    void TravelToNextMap();
+
+    
+
+    // 获取存活的玩家
+    TArray<class AFPSGameCharacter*> GetAlivePlayers();
+
+    // 玩家重生
+    void SpawnPlayerCharacter(APlayerController* PlayerController);
+
+    // 查找所有玩家重生点
+    void FindPlayerStarts();
+
+    // 查找玩家重生点和敌人生成点，注册到出生点服务
+    void RegisterSpawnPoints();
 };
\ No newline at end of file
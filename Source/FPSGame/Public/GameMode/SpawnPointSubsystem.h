@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Math/ProximityKernels.h"
+#include "SpawnPointSubsystem.generated.h"
+
+// 出生点类型
+UENUM()
+enum class ESpawnPointType : uint8
+{
+    Player,
+    Enemy
+};
+
+// 出生点选择服务：按World缓存出生点，增量维护占用状态，按与玩家/敌人的距离评分
+// 空闲出生点放在按评分排序的堆中，取点为O(log n)，取到的点保证没有被占用
+UCLASS(config = Game)
+class FPSGAME_API USpawnPointSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // 注册某一类出生点（会替换之前注册的同类出生点）
+    void RegisterSpawnPoints(ESpawnPointType Type, const TArray<AActor*>& Points);
+
+    // 用当前玩家和敌人的位置重新评分，并释放已离开的占用者
+    void RefreshScores(const TArray<FVector>& PlayerLocations, const TArray<FVector>& EnemyLocations);
+
+    // 取评分最高的空闲出生点；没有空闲点时退回轮询，bOutCollisionFree为false
+    AActor* AcquireSpawnPoint(ESpawnPointType Type, bool& bOutCollisionFree);
+
+    // 记录出生点上生成的角色，角色离开前该点不会再被选中
+    void OccupySpawnPoint(ESpawnPointType Type, AActor* SpawnPoint, AActor* Occupant);
+
+    // 取到出生点后没有生成Actor（放弃生成或生成的不是Actor）时归还预留，已有的占用者不受影响
+    void ReleaseSpawnPoint(ESpawnPointType Type, AActor* SpawnPoint);
+
+    // 该类出生点数量
+    int32 GetNumSpawnPoints(ESpawnPointType Type) const;
+
+    // 该类当前空闲的出生点数量
+    int32 GetNumFreeSpawnPoints(ESpawnPointType Type) const;
+
+protected:
+    // 占用判定半径：占用者或其他角色在此范围内时出生点不可用
+    UPROPERTY(Config)
+    float OccupancyRadius = 150.0f;
+
+    // 评分距离上限（超过此距离的出生点视为同样安全）
+    UPROPERTY(Config)
+    float MaxScoreDistance = 5000.0f;
+
+    struct FSpawnPointEntry
+    {
+        TWeakObjectPtr<AActor> Actor;
+        FVector Location = FVector::ZeroVector;
+        TWeakObjectPtr<AActor> Occupant;
+        bool bReserved = false;
+    };
+
+    struct FSpawnHeapNode
+    {
+        float Score = 0.0f;
+        int32 PointIndex = INDEX_NONE;
+    };
+
+    struct FSpawnPointPool
+    {
+        TArray<FSpawnPointEntry> Points;
+        TArray<FSpawnHeapNode> FreeHeap;
+        TMap<TWeakObjectPtr<AActor>, int32> IndexByActor;
+        int32 FallbackIndex = 0;
+    };
+
+    FSpawnPointPool Pools[2];
+
+    FSpawnPointPool& GetPool(ESpawnPointType Type) { return Pools[static_cast<uint8>(Type)]; }
+    const FSpawnPointPool& GetPool(ESpawnPointType Type) const { return Pools[static_cast<uint8>(Type)]; }
+
+    // 出生点当前是否仍被占用
+    bool IsStillOccupied(const FSpawnPointEntry& Entry) const;
+
+    // 重新评分一类出生点并重建空闲堆
+    void RefreshPool(FSpawnPointPool& Pool, const FProximityPositions& ThreatPositions, const FProximityPositions* ExtraThreatPositions);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "MyGameState.generated.h"
+
+// 对局时钟：只在开局和结束时复制一次开始/结束的服务器时间，
+// 客户端用同步后的服务器时间（UTimeSyncComponent）在本地算剩余时间，不需要每秒同步
+UCLASS()
+class FPSGAME_API AMyGameState : public AGameStateBase
+{
+    GENERATED_BODY()
+
+public:
+    // 服务器：开始计时
+    void StartMatchClock(double StartTime, float Duration);
+
+    // 服务器：提前结束时把结束时间改到现在，客户端的计时随之停止
+    void StopMatchClock();
+
+    // 当前的服务器时间（服务器是世界时间，客户端用本机玩家同步后的时间）
+    double GetSynchronizedServerTime() const;
+
+    // 本局剩余时间（秒）
+    UFUNCTION(BlueprintPure, Category = "Game")
+    float GetRemainingTime() const;
+
+    // 本局已进行的时间（秒）
+    UFUNCTION(BlueprintPure, Category = "Game")
+    float GetElapsedTime() const;
+
+    double GetMatchStartTime() const { return MatchStartTime; }
+    double GetMatchEndTime() const { return MatchEndTime; }
+
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+    // 本局开始和结束的服务器时间，开局前都为0
+    UPROPERTY(Replicated)
+    double MatchStartTime = 0.0;
+
+    UPROPERTY(Replicated)
+    double MatchEndTime = 0.0;
+};
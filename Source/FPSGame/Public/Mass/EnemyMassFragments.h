@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "EnemyMassFragments.generated.h"
+
+// 远处的后台敌人（Mass实体）标记
+USTRUCT()
+struct FPSGAME_API FEnemyMassTag : public FMassTag
+{
+    GENERATED_BODY()
+};
+
+// 后台敌人的生命值（提升为Actor/降级为实体时原样带过去）
+USTRUCT()
+struct FPSGAME_API FEnemyMassHealthFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    float Health = 100.0f;
+};
+
+// 后台敌人的战斗参数（从敌人类的默认对象复制）
+USTRUCT()
+struct FPSGAME_API FEnemyMassCombatFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    float ChaseRange = 1500.0f;
+    float AttackRange = 150.0f;
+    float MoveSpeed = 600.0f;
+};
+
+// 后台敌人当前的目标（索引指向UEnemyMassSubsystem本帧的玩家快照）
+USTRUCT()
+struct FPSGAME_API FEnemyMassTargetFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    int32 TargetIndex = INDEX_NONE;
+    float DistSquared = MAX_flt;
+};
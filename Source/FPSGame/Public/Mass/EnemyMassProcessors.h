@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "EnemyMassProcessors.generated.h"
+
+class UEnemyMassSubsystem;
+
+// 后台敌人的目标选择：在玩家快照中找追击范围内最近的玩家（可在工作线程执行）
+UCLASS()
+class FPSGAME_API UEnemyMassTargetingProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UEnemyMassTargetingProcessor();
+
+protected:
+    virtual void Initialize(UObject& Owner) override;
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+    FMassEntityQuery EntityQuery;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UEnemyMassSubsystem> MassSubsystem;
+};
+
+// 后台敌人的移动：沿敌人流场的可行走格子朝目标移动，停在攻击范围外等待提升（可在工作线程执行）
+UCLASS()
+class FPSGAME_API UEnemyMassMovementProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UEnemyMassMovementProcessor();
+
+protected:
+    virtual void Initialize(UObject& Owner) override;
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+    FMassEntityQuery EntityQuery;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UEnemyMassSubsystem> MassSubsystem;
+};
+
+// 后台敌人靠近玩家时提升为完整的AEnemyCharacter（游戏线程）
+UCLASS()
+class FPSGAME_API UEnemyMassPromotionProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UEnemyMassPromotionProcessor();
+
+protected:
+    virtual void Initialize(UObject& Owner) override;
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+    FMassEntityQuery EntityQuery;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UEnemyMassSubsystem> MassSubsystem;
+};
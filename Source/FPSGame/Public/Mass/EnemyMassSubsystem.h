@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MassArchetypeTypes.h"
+#include "Math/ProximityKernels.h"
+#include "EnemyMassSubsystem.generated.h"
+
+class AEnemyCharacter;
+
+// 后台敌人（Mass实体）管理（仅服务器）
+// 远离玩家的敌人只以片段数据存在于Mass的archetype chunk中，由处理器批量完成目标选择和移动，
+// 靠近玩家时提升为完整的AEnemyCharacter（之后的攻击、受伤、击杀和OnEnemyDeath计分流程不变），
+// 空闲且远离所有玩家的Actor敌人再降级回实体。后台敌人不复制，客户端只看到提升后的Actor，
+// 所以后台敌人从不攻击玩家：Actor敌人已满、提升不了时停在HoldDistance外等待
+UCLASS(config = Game)
+class FPSGAME_API UEnemyMassSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 生成一个后台敌人，战斗参数取自敌人类的默认对象
+    bool SpawnBackgroundEnemy(const FVector& Location, const FRotator& Rotation, TSubclassOf<AEnemyCharacter> EnemyClass, float Health = -1.0f);
+
+    // 把Actor敌人降级为后台敌人（保留生命值），由调用方回收Actor
+    bool DemoteEnemy(AEnemyCharacter* Enemy);
+
+    // 销毁所有后台敌人（新一局开始时）
+    void DestroyAllBackgroundEnemies();
+
+    // 当前后台敌人数量
+    int32 GetNumBackgroundEnemies() const { return BackgroundEntities.Num(); }
+
+    // SpawnSeparation范围内是否已有后台敌人（生成前检查，避免叠在同一个出生点上）
+    bool IsLocationOccupied(const FVector& Location) const;
+
+    // 实体已提升为Actor（由提升处理器调用）
+    void OnEntityPromoted(const FMassEntityHandle& Entity) { BackgroundEntities.Remove(Entity); }
+
+    // 本帧的玩家位置快照（处理器只读）
+    const FProximityPositions& GetPlayerPositions() const { return PlayerPositions; }
+
+    // 后台敌人离目标玩家的最近距离（至少是攻击范围的两倍）
+    float GetHoldDistance() const { return HoldDistance; }
+
+    // 后台敌人离玩家小于此距离时提升为Actor
+    float GetPromotionDistance() const { return PromotionDistance; }
+
+    // Actor敌人离所有玩家大于此距离且空闲时降级为实体
+    float GetDemotionDistance() const { return DemotionDistance; }
+
+protected:
+    UPROPERTY(Config)
+    float PromotionDistance = 2500.0f;
+
+    UPROPERTY(Config)
+    float DemotionDistance = 4000.0f;
+
+    // 新生成的后台敌人和已有后台敌人的最小间距
+    UPROPERTY(Config)
+    float SpawnSeparation = 150.0f;
+
+    // 没有提升的后台敌人停在离玩家这个距离外
+    UPROPERTY(Config)
+    float HoldDistance = 600.0f;
+
+    // 后台敌人的archetype（第一次生成时创建）
+    FMassArchetypeHandle EnemyArchetype;
+
+    // 当前存在的后台敌人
+    TSet<FMassEntityHandle> BackgroundEntities;
+
+    // 每帧刷新的玩家位置快照
+    FProximityPositions PlayerPositions;
+
+    // 刷新玩家快照
+    void RefreshPlayerSnapshot();
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "MatchFlowSubsystem.generated.h"
+
+// 对局流程：在大厅/结算阶段异步预加载下一张地图的资源，并统计切图到首个可玩帧的耗时
+UCLASS(config = Game)
+class FPSGAME_API UMatchFlowSubsystem : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // 异步预加载地图依赖的资源包和配置的主资源；资源注册表里查不到依赖时（打包版本默认不带依赖信息）改为异步加载地图包本身
+    UFUNCTION(BlueprintCallable, Category = "Match")
+    void PreloadMap(const FString& MapPackageName);
+
+    // 指定地图的资源是否已预加载完成
+    UFUNCTION(BlueprintPure, Category = "Match")
+    bool IsMapPreloaded(const FString& MapPackageName) const;
+
+    // 服务器切换到指定地图（GameMode开启无缝旅行时走无缝旅行）
+    // 监听服务器切图后继续监听；独立模式下bListen为true时开始监听（创建会话后承载对局）；专用服务器本来就在监听，不加?listen
+    UFUNCTION(BlueprintCallable, Category = "Match")
+    void TravelToMap(const FString& MapPackageName, bool bListen = false);
+
+    // 释放预加载的资源引用
+    void ReleasePreloadedAssets();
+
+    // 收集地图硬依赖的资源路径（不包含地图本身和C++模块包）
+    static void GatherMapAssets(const FString& MapPackageName, TArray<FSoftObjectPath>& OutAssets);
+
+    // 上一次切图到首个可玩帧的耗时（秒），没有记录时为负数
+    UFUNCTION(BlueprintPure, Category = "Match")
+    float GetLastTimeToFirstPlayableFrame() const { return LastTimeToFirstPlayableFrame; }
+
+protected:
+    // 额外需要预加载的主资源（DefaultGame.ini中配置）
+    UPROPERTY(Config)
+    TArray<FPrimaryAssetId> PreloadPrimaryAssets;
+
+    // 预加载的地图名
+    FString PreloadedMapName;
+
+    // 资源包预加载句柄（持有期间资源不会被GC）
+    TSharedPtr<FStreamableHandle> PackagePreloadHandle;
+
+    // 主资源预加载句柄
+    TSharedPtr<FStreamableHandle> PrimaryAssetPreloadHandle;
+
+    // 没有依赖信息时异步加载的地图包（持有到新地图的第一帧）
+    UPROPERTY(Transient)
+    TObjectPtr<UPackage> PreloadedMapPackage;
+
+    // 地图包正在异步加载
+    bool bMapPackageLoading = false;
+
+    // 预加载开始时间
+    double PreloadStartTime = 0.0;
+
+    // 切图开始时间，0表示没有进行中的切图
+    double TravelStartTime = 0.0;
+
+    // 上一次切图到首个可玩帧的耗时
+    float LastTimeToFirstPlayableFrame = -1.0f;
+
+    FDelegateHandle PreLoadMapHandle;
+    FDelegateHandle SeamlessTravelStartHandle;
+    FDelegateHandle PostLoadMapHandle;
+
+    // 资源预加载完成
+    void OnPreloadComplete();
+
+    // 地图包异步加载完成
+    void OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+    // 硬切图开始
+    void OnPreLoadMap(const FString& MapName);
+
+    // 无缝旅行开始
+    void OnSeamlessTravelStart(UWorld* World, const FString& MapName);
+
+    // 新地图加载完成（硬切图和无缝旅行都会触发）
+    void OnPostLoadMap(UWorld* LoadedWorld);
+
+    // 新地图的第一帧
+    void OnFirstPlayableFrame();
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "Containers/Ticker.h"
+#include "Misc/CoreDelegates.h"
+#include "MatchHostSubsystem.generated.h"
+
+// 每个对局一个派生子进程的托管（仅Linux专用服务器）
+// 使用 -WaitAndFork 启动时，父进程只同步加载对局地图依赖的资源并保持引用，不加载地图、不承载对局；
+// 每个派生出的子进程是独立的服务器进程，自己创建会话、切换到对局地图并监听自己的端口，
+// 拥有独立的World、AMyGameMode、出生点和玩家。子进程继承已加载的依赖资源，切图时不用再从磁盘加载，
+// 但地图本身在每个子进程里各自加载，继承的内存页在GC和切图写入后也不再共享，不能按共享内存估算子进程的占用
+UCLASS(config = Game)
+class FPSGAME_API UMatchHostSubsystem : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // 当前进程是否为派生出的对局子进程
+    UFUNCTION(BlueprintPure, Category = "Match")
+    bool IsHostedMatchProcess() const;
+
+protected:
+    // 每个对局的玩家数
+    UPROPERTY(Config)
+    int32 PlayersPerMatch = 4;
+
+    // 父进程加载的地图依赖资源（子进程继承，保持引用避免被GC后重新加载）
+    TSharedPtr<FStreamableHandle> SharedAssetsHandle;
+
+    FDelegateHandle PostForkHandle;
+    FTSTicker::FDelegateHandle StartMatchTickerHandle;
+
+    // 父进程同步加载对局地图依赖的资源
+    void PreloadSharedAssets();
+
+    // 派生完成
+    void OnPostFork(EForkProcessRole ProcessRole);
+
+    // 子进程创建自己的会话并进入对局地图
+    bool StartHostedMatch(float DeltaTime);
+};
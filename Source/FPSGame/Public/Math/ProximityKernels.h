@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 按分量分开存放的位置数组（SoA），供向量化的距离计算使用
+struct FPSGAME_API FProximityPositions
+{
+    TArray<float> X;
+    TArray<float> Y;
+    TArray<float> Z;
+
+    void Reset(int32 ExpectedNum = 0);
+    void Add(const FVector& Position);
+    void Append(TConstArrayView<FVector> Positions);
+    int32 Num() const { return X.Num(); }
+    FVector Get(int32 Index) const { return FVector(X[Index], Y[Index], Z[Index]); }
+};
+
+// 基于VectorRegister的距离/范围计算
+// 一次比较4个候选（主循环展开成每轮8个），全部用平方距离，不开方；尾部不足4个的用标量处理
+struct FPSGAME_API FProximityKernels
+{
+    // 计算Origin到每个位置的平方距离，OutDistSquared至少要有Positions.Num()个元素
+    static void DistSquaredBatch(const FVector& Origin, const FProximityPositions& Positions, float* OutDistSquared);
+
+    // 平方距离不超过MaxDistSquared的最近位置索引，距离相同时返回索引最小的，没有时返回INDEX_NONE
+    static int32 FindNearest(const FVector& Origin, const FProximityPositions& Positions, float MaxDistSquared, float& OutDistSquared);
+
+    // 把平方距离不超过RangeSquared的位置索引追加到OutIndices，返回追加的个数
+    static int32 FilterInRange(const FVector& Origin, const FProximityPositions& Positions, float RangeSquared, TArray<int32>& OutIndices);
+
+    // 与上面对应的标量实现（用于对比测试和少量数据）
+    static int32 FindNearestScalar(const FVector& Origin, const FProximityPositions& Positions, float MaxDistSquared, float& OutDistSquared);
+    static int32 FilterInRangeScalar(const FVector& Origin, const FProximityPositions& Positions, float RangeSquared, TArray<int32>& OutIndices);
+
+    // 微基准：100/1000/10000个位置下对比标量和向量化实现，结果输出到日志
+    static void RunBenchmark(int32 Iterations = 200);
+};
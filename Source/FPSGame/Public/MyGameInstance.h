@@ -1,57 +1,195 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Engine/GameInstance.h"
-#include "OnlineSubsystem.h"
-#include "OnlineSessionSettings.h"
-#include "Interfaces/OnlineSessionInterface.h"
-#include "MyGameInstance.generated.h"
-
-UCLASS()
-class FPSGAME_API UMyGameInstance : public UGameInstance
-{
-	GENERATED_BODY()
-	
-public:
-    UMyGameInstance();
-
-    // 创建会话
-    UFUNCTION(BlueprintCallable, Category = "Network")
-    void CreateSession(int32 NumPublicConnections = 4, bool bUseLAN = false);
-
-    // 加入会话
-    UFUNCTION(BlueprintCallable, Category = "Network")
-    void JoinSessionByIndex(int32 SessionIndex);
-
-    // 查找会话
-    UFUNCTION(BlueprintCallable, Category = "Network")
-    void FindSessions(bool bUseLAN = false);
-
-    // 销毁会话
-    UFUNCTION(BlueprintCallable, Category = "Network")
-    void DestroySession();
-
-protected:
-    // 会话接口
-    IOnlineSessionPtr SessionInterface;
-
-    // 会话搜索结果
-    TSharedPtr<FOnlineSessionSearch> SessionSearch;
-
-    // 会话名称
-    FName SessionName;
-
-    // 会话创建完成回调
-    void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful);
-
-    // 会话查找完成回调
-    void OnFindSessionsComplete(bool bWasSuccessful);
-
-    // 会话加入完成回调
-    void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
-
-    // 会话销毁完成回调
-    void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/GameInstance.h"
+#include "OnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "MyGameInstance.generated.h"
+
+// 服务器列表条目（只保留界面需要的字段，按页生成）
+USTRUCT(BlueprintType)
+struct FSessionBrowserEntry
+{
+    GENERATED_BODY()
+
+    // 在搜索结果中的索引（用于JoinSessionByIndex）
+    UPROPERTY(BlueprintReadOnly, Category = "Network")
+    int32 ResultIndex = INDEX_NONE;
+
+    // 房主名称
+    UPROPERTY(BlueprintReadOnly, Category = "Network")
+    FString OwnerName;
+
+    // 地图名称
+    UPROPERTY(BlueprintReadOnly, Category = "Network")
+    FString MapName;
+
+    // 延迟（毫秒）
+    UPROPERTY(BlueprintReadOnly, Category = "Network")
+    int32 PingInMs = 0;
+
+    // 剩余空位
+    UPROPERTY(BlueprintReadOnly, Category = "Network")
+    int32 OpenConnections = 0;
+
+    // 最大人数
+    UPROPERTY(BlueprintReadOnly, Category = "Network")
+    int32 MaxConnections = 0;
+};
+
+// 会话搜索结果更新（新搜索完成或命中缓存时广播）
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSessionSearchUpdated, bool, bWasSuccessful, int32, NumResults);
+
+UCLASS()
+class FPSGAME_API UMyGameInstance : public UGameInstance
+{
+	GENERATED_BODY()
+
+public:
+    UMyGameInstance();
+
+    virtual void Shutdown() override;
+
+    // 创建会话
+    UFUNCTION(BlueprintCallable, Category = "Network")
+    void CreateSession(int32 NumPublicConnections = 4, bool bUseLAN = false);
+
+    // 加入会话
+    UFUNCTION(BlueprintCallable, Category = "Network")
+    void JoinSessionByIndex(int32 SessionIndex);
+
+    // 查找会话（缓存未过期时直接返回缓存结果，bForceRefresh强制重新搜索）
+    UFUNCTION(BlueprintCallable, Category = "Network")
+    void FindSessions(bool bUseLAN = false, bool bForceRefresh = false);
+
+    // 取消正在进行的会话搜索
+    UFUNCTION(BlueprintCallable, Category = "Network")
+    void CancelFindSessions();
+
+    // 销毁会话
+    UFUNCTION(BlueprintCallable, Category = "Network")
+    void DestroySession();
+
+    // 对局地图
+    const FString& GetMatchMapName() const { return MatchMapName; }
+
+    // 是否正在搜索会话
+    UFUNCTION(BlueprintPure, Category = "Network")
+    bool IsSearchingSessions() const { return bSearchInProgress; }
+
+    // 当前搜索结果数量
+    UFUNCTION(BlueprintPure, Category = "Network")
+    int32 GetNumSessionResults() const;
+
+    // 分页获取搜索结果，返回结果总数
+    UFUNCTION(BlueprintCallable, Category = "Network")
+    int32 GetSessionPage(int32 PageIndex, int32 PageSize, TArray<FSessionBrowserEntry>& OutEntries) const;
+
+    // 搜索结果更新事件（供服务器列表界面绑定）
+    UPROPERTY(BlueprintAssignable, Category = "Network")
+    FOnSessionSearchUpdated OnSessionSearchUpdated;
+
+    // 调试：查找会话并打印第一页（Null子系统下可直接测试）
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugFindSessions(bool bForceRefresh);
+
+    // 调试：打印指定页的会话
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugSessionPage(int32 PageIndex);
+
+    // 调试：打印本机角色重要度分布（客户端可用）
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugSignificance();
+
+    // 调试：打印武器音效池的使用情况
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugWeaponAudio();
+
+    // 命中判定基准（服务器）：等NumBots个机器人连上后依次套用配置的网络模拟参数，在服务器上统计命中率、开火到结算的延迟和带宽
+    UFUNCTION(Exec, Category = "Debug")
+    void BenchHitReg(int32 NumBots, int32 ShotsPerProfile = 0);
+
+    // 命中判定机器人（客户端）：持续瞄准最近的敌人开火，配合服务器上的BenchHitReg
+    UFUNCTION(Exec, Category = "Debug")
+    void BenchHitRegBot();
+
+    // 调试：打印本机网络驱动上一秒各RPC和跟踪属性的流量（客户端看上行RPC）
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugNetAccounting();
+
+    // 调试：打印本机与服务器的时间同步状态（偏移、往返延迟和抖动）
+    UFUNCTION(Exec, Category = "Debug")
+    void DebugTimeSync();
+
+protected:
+    // 会话接口
+    IOnlineSessionPtr SessionInterface;
+
+    // 会话搜索结果（同时作为短期缓存）
+    TSharedPtr<FOnlineSessionSearch> SessionSearch;
+
+    // 会话名称
+    FName SessionName;
+
+    // 对局地图（创建会话时开始预加载）
+    UPROPERTY(EditDefaultsOnly, Category = "Network")
+    FString MatchMapName;
+
+    // 单次搜索的最大结果数
+    UPROPERTY(EditDefaultsOnly, Category = "Network")
+    int32 MaxSessionSearchResults;
+
+    // 搜索结果缓存有效期（秒）
+    UPROPERTY(EditDefaultsOnly, Category = "Network")
+    float SessionCacheLifetime;
+
+    // 调试命令每页显示数量
+    UPROPERTY(EditDefaultsOnly, Category = "Network")
+    int32 DebugSessionPageSize;
+
+    // 缓存结果对应的搜索类型
+    bool bCachedSearchIsLAN = false;
+
+    // 缓存结果的完成时间（FPlatformTime::Seconds），0表示无缓存
+    double CachedSearchTime = 0.0;
+
+    // 是否正在搜索
+    bool bSearchInProgress = false;
+
+    // 回调句柄（每次请求只绑定一次，完成后立即移除）
+    FDelegateHandle CreateSessionCompleteHandle;
+    FDelegateHandle FindSessionsCompleteHandle;
+    FDelegateHandle CancelFindSessionsCompleteHandle;
+    FDelegateHandle JoinSessionCompleteHandle;
+    FDelegateHandle DestroySessionCompleteHandle;
+
+    // 获取会话接口（子系统不存在时返回空）
+    IOnlineSessionPtr GetSessionInterface();
+
+    // 当前子系统是否为Null（本地测试只支持LAN）
+    bool IsNullSubsystem() const;
+
+    // 缓存是否仍然有效
+    bool IsSearchCacheValid(bool bUseLAN) const;
+
+    // 移除所有会话回调
+    void ClearSessionDelegates();
+
+    // 会话创建完成回调
+    void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful);
+
+    // 会话查找完成回调
+    void OnFindSessionsComplete(bool bWasSuccessful);
+
+    // 会话查找取消回调
+    void OnCancelFindSessionsComplete(bool bWasSuccessful);
+
+    // 会话加入完成回调
+    void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
+
+    // 会话销毁完成回调
+    void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
+};
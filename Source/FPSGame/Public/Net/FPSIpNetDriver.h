@@ -0,0 +1,191 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IpNetDriver.h"
+#include "UObject/ObjectKey.h"
+#include "FPSIpNetDriver.generated.h"
+
+// 一个统计类别（RPC名或"类名.属性名"）每个连接每秒的预算，0表示不限制
+USTRUCT()
+struct FNetAccountingBudget
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    FName Category;
+
+    UPROPERTY()
+    int32 MaxBytesPerSecond = 0;
+
+    UPROPERTY()
+    int32 MaxCallsPerSecond = 0;
+};
+
+// 游戏网络驱动：在IpNetDriver上加一层流量统计和按连接的拥塞控制
+// 按连接、按秒统计每个RPC和每个跟踪的复制属性的次数和字节数（按参数/属性的序列化大小估算，
+// 与复制路径无关，Iris和旧系统都能用），超出配置的预算时输出警告，并把每秒的结果追加到Saved/Telemetry下的CSV
+// 拥塞控制按每个连接的饱和降低远处敌人、表现用子弹的优先级；只有丢包同时伴随饱和或往返上升时才算拥塞并降低发送上限，
+// 单纯的随机丢包不降速。发送上限不低于本机Pawn、近处的威胁和血量/分数每秒需要的流量
+// （旧复制路径通过GetNetPriority生效，Iris只用发送上限）
+UCLASS(transient, config = Engine)
+class FPSGAME_API UFPSIpNetDriver : public UIpNetDriver
+{
+    GENERATED_BODY()
+
+public:
+    virtual void ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject = nullptr) override;
+    virtual void TickFlush(float DeltaSeconds) override;
+    virtual void Shutdown() override;
+
+    // 输出每个连接上一秒的统计（按字节数排序）和拥塞控制状态
+    void DumpAccounting() const;
+
+    // 低重要度Actor（远处的敌人、表现用的子弹）在该连接上的优先级倍率：连接拥塞时降低，近处的威胁不受影响
+    float GetPriorityScale(const UNetConnection* Connection, float DistanceSquared) const;
+
+    // 连接是否处于拥塞状态（饱和，或丢包伴随往返上升）
+    bool IsCongested(const UNetConnection* Connection) const;
+
+protected:
+    UPROPERTY(Config)
+    bool bEnableAccounting = true;
+
+    // 是否把每秒的统计写到CSV
+    UPROPERTY(Config)
+    bool bWriteTelemetry = true;
+
+    // 各类别的预算
+    UPROPERTY(Config)
+    TArray<FNetAccountingBudget> Budgets;
+
+    // 需要统计的复制属性，格式为"类名.属性名"（只支持数值和布尔属性）
+    UPROPERTY(Config)
+    TArray<FString> TrackedProperties;
+
+    // 同一连接同一类别两次超预算警告的最小间隔（秒）
+    UPROPERTY(Config)
+    float BudgetWarningInterval = 10.0f;
+
+    // 按连接的拥塞控制：每帧采样连接是否饱和，每秒结合丢包率和往返时间调整低重要度Actor的优先级和发送上限
+    UPROPERTY(Config)
+    bool bEnableCongestionControl = true;
+
+    // 一秒内饱和帧的比例超过该值视为拥塞
+    UPROPERTY(Config)
+    float SaturationThreshold = 0.2f;
+
+    // 丢包率超过该值，且同时饱和或往返上升时视为拥塞（0~1）
+    UPROPERTY(Config)
+    float LossThreshold = 0.05f;
+
+    // 往返时间比该连接的最低往返高出这么多（秒）视为链路在排队
+    UPROPERTY(Config)
+    float RttRiseThreshold = 0.04f;
+
+    // 拥塞时每秒乘上的衰减系数（优先级倍率和发送上限共用）
+    UPROPERTY(Config)
+    float ThrottleDecrease = 0.7f;
+
+    // 不拥塞时优先级倍率每秒回升的量
+    UPROPERTY(Config)
+    float ThrottleRecovery = 0.1f;
+
+    // 优先级倍率下限
+    UPROPERTY(Config)
+    float MinThrottle = 0.25f;
+
+    // 这个距离内的Actor视为近处威胁，不降低优先级
+    UPROPERTY(Config)
+    float NearThreatDistance = 2500.0f;
+
+    // 发送上限的绝对下限和每秒回升量（字节每秒）
+    UPROPERTY(Config)
+    int32 MinNetSpeed = 16000;
+
+    UPROPERTY(Config)
+    int32 NetSpeedRecovery = 4000;
+
+    // 按必需流量推算的下限：本机Pawn和每个近处威胁每次复制的估算字节数乘以服务器网络帧率，
+    // 加上这一秒统计到的跟踪属性（血量/分数）流量，再乘以余量
+    UPROPERTY(Config)
+    int32 PawnBytesPerUpdate = 64;
+
+    UPROPERTY(Config)
+    int32 ThreatBytesPerUpdate = 32;
+
+    UPROPERTY(Config)
+    float NetSpeedFloorHeadroom = 1.5f;
+
+private:
+    struct FCategoryStats
+    {
+        uint32 Calls = 0;
+        uint64 Bits = 0;
+    };
+
+    struct FConnectionAccounting
+    {
+        FString Name;
+        TMap<FName, FCategoryStats> Current;
+        TMap<FName, FCategoryStats> LastSecond;
+        TMap<FName, double> LastWarningTime;
+    };
+
+    struct FTrackedProperty
+    {
+        TWeakObjectPtr<UClass> Class;
+        FProperty* Property = nullptr;
+        FName Category;
+        int32 EstimatedBits = 0;
+    };
+
+    struct FCongestionState
+    {
+        int32 Frames = 0;
+        int32 SaturatedFrames = 0;
+        float Saturation = 0.0f;
+        float Loss = 0.0f;
+        // 平均往返和观察到的最低往返（秒）
+        float Rtt = 0.0f;
+        float MinRtt = 0.0f;
+        float Throttle = 1.0f;
+        // 连接建立时的发送上限，恢复时不超过它
+        int32 BaseNetSpeed = 0;
+        int32 NetSpeed = 0;
+        // 按必需流量推算的发送上限下限
+        int32 NetSpeedFloor = 0;
+    };
+
+    TMap<TObjectKey<UNetConnection>, FConnectionAccounting> Connections;
+
+    TMap<TObjectKey<UNetConnection>, FCongestionState> CongestionStates;
+
+    TArray<FTrackedProperty> ResolvedProperties;
+    bool bPropertiesResolved = false;
+
+    // 跟踪属性上一次看到的值，下标与ResolvedProperties一致
+    TMap<TObjectKey<AActor>, TArray<double, TInlineAllocator<4>>> PropertyShadows;
+
+    double SecondStartTime = 0.0;
+
+    FString TelemetryPath;
+    FString PendingTelemetry;
+    int32 SecondsSinceTelemetryFlush = 0;
+
+    void Record(UNetConnection* Connection, FName Category, int64 Bits);
+
+    int64 EstimateRpcBits(UFunction* Function, void* Parameters) const;
+
+    void ResolveTrackedProperties();
+    void AccountPropertyChanges();
+
+    void SampleSaturation();
+    void UpdateCongestion();
+
+    // 连接每秒必需的流量：本机Pawn、近处威胁和跟踪属性
+    int32 ComputeNetSpeedFloor(const UNetConnection* Connection, int32 NumNearThreats) const;
+
+    // 每秒结算：检查预算、写遥测、滚动统计
+    void FinishSecond(double Now, double Elapsed);
+    void FlushTelemetry();
+};
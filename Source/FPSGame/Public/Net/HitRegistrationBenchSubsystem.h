@@ -0,0 +1,211 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/NetDriver.h"
+#include "HitRegistrationBenchSubsystem.generated.h"
+
+class AController;
+class AEnemyCharacter;
+class AFPSGameCharacter;
+class AFPSGameProjectile;
+class UFPSGameWeaponComponent;
+
+// 一组网络模拟参数（收发两个方向都生效）
+USTRUCT()
+struct FNetEmulationProfile
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    FString Name;
+
+    // 单向延迟（毫秒）
+    UPROPERTY()
+    int32 LagMs = 0;
+
+    // 延迟抖动（毫秒，延迟在LagMs±JitterMs之间）
+    UPROPERTY()
+    int32 JitterMs = 0;
+
+    // 丢包率（百分比）
+    UPROPERTY()
+    int32 LossPercent = 0;
+
+    // 通过条件：有效射击的最低命中率（0表示不检查）
+    UPROPERTY()
+    float MinHitRate = 0.0f;
+};
+
+// 命中判定基准
+// 服务器（-HitRegBench=<机器人数>）等机器人客户端（-HitRegBot）连上后依次套用每组网络模拟参数（引擎的PktLag/PktLoss），
+// 机器人按固定种子的射击模式瞄准最近的敌人持续开火。命中在服务器上结算：武器生成子弹时登记射击，
+// 子弹对敌人造成伤害时按子弹和发起者登记命中，其他来源的伤害不计入。
+// 每组统计有效射击（开火时弹道第一个挡住的是敌人）的命中率、从客户端开火到服务器结算的延迟和每个机器人的收发带宽，
+// 和配置的通过条件比较后写CSV（-HitRegReport=<路径>，默认Saved/Telemetry下），自动化测试FPSGame.Net.HitRegistration.Bench读取结果
+UCLASS(config = Game)
+class FPSGAME_API UHitRegistrationBenchSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 服务器：等NumBots个玩家连上后开始基准，ShotsPerProfile<=0时使用配置值
+    void StartBench(int32 NumBots, int32 ShotsPerProfile = 0);
+
+    // 服务器：提前结束，恢复网络模拟参数并写出已完成的结果
+    void StopBench();
+
+    // 客户端：作为机器人持续瞄准最近的敌人开火，直到断开连接
+    void StartBot();
+
+    bool IsRunning() const { return State != EBenchState::Idle; }
+
+    // 服务器：武器生成了一颗会造成伤害的子弹，ClientFireTime是客户端开火时同步后的服务器时间
+    void NotifyShotFired(AFPSGameProjectile* Projectile, AController* Instigator, double ClientFireTime);
+
+    // 服务器：子弹对敌人结算了伤害
+    void NotifyProjectileHit(const AFPSGameProjectile* Projectile, const AActor* Victim, float Damage);
+
+    // 自动化测试启动服务器时使用的地图
+    const FString& GetBenchMap() const { return BenchMap; }
+
+    // 基准完成或超时的上限（秒，自动化测试用）
+    float GetEstimatedDuration() const;
+
+protected:
+    // 依次测试的网络模拟参数
+    UPROPERTY(Config)
+    TArray<FNetEmulationProfile> Profiles;
+
+    // 每个机器人在每组参数下的射击次数
+    UPROPERTY(Config)
+    int32 DefaultShotsPerProfile = 40;
+
+    // 机器人的射击间隔（秒）
+    UPROPERTY(Config)
+    float ShotInterval = 0.3f;
+
+    // 套用参数后等待连接和时间同步稳定的时间（秒）
+    UPROPERTY(Config)
+    float WarmupTime = 2.0f;
+
+    // 录制结束后等待还在飞的子弹的时间（秒，另加上当前参数的往返延迟）
+    UPROPERTY(Config)
+    float ShotTimeout = 2.0f;
+
+    // 等机器人连上的最长时间（秒）
+    UPROPERTY(Config)
+    float BotConnectTimeout = 60.0f;
+
+    // 每组参数至少要有这么多有效射击，结果才算数
+    UPROPERTY(Config)
+    int32 MinClearShots = 10;
+
+    // 瞄准点在目标中心附近的随机偏移半径（固定种子）
+    UPROPERTY(Config)
+    float AimSpread = 25.0f;
+
+    // 只选择这个距离内的敌人
+    UPROPERTY(Config)
+    float MaxTargetDistance = 4000.0f;
+
+    // 射击模式的随机种子
+    UPROPERTY(Config)
+    int32 Seed = 1337;
+
+    // 自动化测试启动服务器时加载的地图（需要有敌人出生点）
+    UPROPERTY(Config)
+    FString BenchMap;
+
+private:
+    enum class EBenchState : uint8
+    {
+        Idle,
+        // 服务器：等机器人连上
+        WaitingForBots,
+        Warmup,
+        // 服务器：录制射击和命中
+        Recording,
+        // 服务器：录制结束，等待还在飞的子弹
+        Draining,
+        // 客户端：机器人开火
+        Bot
+    };
+
+    struct FRecordedShot
+    {
+        TWeakObjectPtr<AFPSGameProjectile> Projectile;
+        TWeakObjectPtr<AController> Instigator;
+        double ClientFireTime = 0.0;
+        // 开火时弹道上第一个挡住的是敌人
+        bool bClearShot = false;
+    };
+
+    struct FProfileResult
+    {
+        FString Name;
+        int32 Shots = 0;
+        int32 ClearShots = 0;
+        int32 Hits = 0;
+        int32 ClearHits = 0;
+        TArray<float> LatenciesMs;
+        double InBytes = 0.0;
+        double OutBytes = 0.0;
+        double Duration = 0.0;
+        int32 NumBots = 0;
+        bool bPassed = false;
+    };
+
+    EBenchState State = EBenchState::Idle;
+    int32 ProfileIndex = 0;
+    int32 ShotsPerProfile = 0;
+    int32 ExpectedBots = 0;
+    double StateStartTime = 0.0;
+    double RecordStartTime = 0.0;
+
+    // 正在飞的已登记子弹
+    TArray<FRecordedShot> RecordedShots;
+
+    TArray<FProfileResult> Results;
+
+    // 机器人状态
+    double NextShotTime = 0.0;
+    bool bAimed = false;
+    TWeakObjectPtr<AEnemyCharacter> AimTarget;
+    FRandomStream ShotStream;
+
+    // 完成后退出进程（由命令行启动时）
+    bool bExitWhenDone = false;
+
+#if DO_ENABLE_NET_TEST
+    // 开始前的网络模拟参数，结束后恢复
+    FPacketSimulationSettings SavedSettings;
+#endif
+
+    void BeginProfile(int32 Index);
+    void FinishProfile();
+    void FinishBench();
+
+    void ApplyProfile(const FNetEmulationProfile& Profile);
+    void RestoreSettings();
+
+    int32 GetNumConnectedBots() const;
+    double GetShotTimeout() const;
+
+    void TickServer(float DeltaTime);
+    void TickBot();
+
+    AEnemyCharacter* FindTarget(const AFPSGameCharacter* Character) const;
+    UFPSGameWeaponComponent* FindWeapon(const AFPSGameCharacter* Character) const;
+
+    // 机器人：瞄准目标（下一帧摄像机朝向生效后再开火）
+    bool AimAtTarget(AFPSGameCharacter* Character);
+
+    void WriteResults();
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "NetOcclusionSubsystem.generated.h"
+
+class APlayerController;
+
+// 基于视线遮挡的网络相关性（仅服务器）
+// 定期用自己的异步射线判断每个连接的视角能否看到已注册的角色（和敌人感知分开排队和限额，不占用敌人的视线检测）：
+// 从视点向角色包围盒上的几个点（中心、头顶、脚下、左右两侧）各打一条射线，任意一条没被挡住就算可见；
+// 近处的角色总是相关；远处被持续遮挡超过宽限时间的角色对该连接不再相关（也就看不到墙后的敌人），
+// 近处被遮挡的角色降低网络优先级。
+// 旧复制路径通过角色的IsNetRelevantFor/GetNetPriority查询；Iris下为每个角色设置允许复制的连接集合
+UCLASS(config = Game)
+class FPSGAME_API UNetOcclusionSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // 注册/注销参与遮挡剔除的角色（仅服务器）
+    void RegisterActor(AActor* Actor);
+    void UnregisterActor(AActor* Actor);
+
+    // 角色对该观察者是否因遮挡而不相关
+    bool IsOccludedFor(const AActor* Viewer, const AActor* Actor) const;
+
+    // 角色对该观察者的网络优先级倍率（被遮挡时降低）
+    float GetNetPriorityScale(const AActor* Viewer, const AActor* Actor) const;
+
+    // 输出每个连接被剔除和降优先级的角色数
+    void DumpStats() const;
+
+protected:
+    // 刷新间隔（秒）
+    UPROPERTY(Config)
+    float UpdateInterval = 0.5f;
+
+    // 在这个距离内总是相关（避免近处角色频繁出现/消失）
+    UPROPERTY(Config)
+    float AlwaysRelevantDistance = 2500.0f;
+
+    // 持续被遮挡超过该时间才剔除（秒）
+    UPROPERTY(Config)
+    float OccludedGraceTime = 1.0f;
+
+    // 被遮挡但仍相关的角色的网络优先级倍率
+    UPROPERTY(Config)
+    float OccludedPriorityScale = 0.25f;
+
+    // 每帧最多提交的遮挡射线数（每个观察者-角色对占包围盒采样点数条），超出的留到下一帧
+    UPROPERTY(Config)
+    int32 MaxTracesPerFrame = 64;
+
+    // 遮挡检测使用的碰撞通道
+    UPROPERTY(Config)
+    TEnumAsByte<ECollisionChannel> OcclusionTraceChannel = ECC_Visibility;
+
+    enum class EOcclusionState : uint8
+    {
+        Visible,
+        // 被遮挡但仍相关（距离近或还在宽限期内）
+        LowPriority,
+        Culled
+    };
+
+    struct FActorVisibility
+    {
+        double OccludedSince = -1.0;
+        EOcclusionState State = EOcclusionState::Visible;
+        // 已排队或射线还没返回，避免重复排队
+        bool bPending = false;
+    };
+
+    struct FViewerVisibility
+    {
+        TMap<uint32, FActorVisibility> Actors;
+    };
+
+    TArray<TWeakObjectPtr<AActor>> RegisteredActors;
+
+    // 按PlayerController的UniqueID索引
+    TMap<uint32, FViewerVisibility> Viewers;
+
+    struct FOcclusionRequest
+    {
+        TWeakObjectPtr<APlayerController> Viewer;
+        TWeakObjectPtr<AActor> Actor;
+        uint32 ViewerId = 0;
+        uint32 ActorId = 0;
+    };
+
+    struct FOcclusionInFlight
+    {
+        FOcclusionRequest Request;
+        // 每个包围盒采样点一条射线
+        TArray<FTraceHandle, TInlineAllocator<5>> Handles;
+    };
+
+    // 等待提交的观察者-角色对
+    TArray<FOcclusionRequest> PendingRequests;
+
+    // 上一帧提交、本帧读取结果的射线
+    TArray<FOcclusionInFlight> InFlightTraces;
+
+    float TimeSinceUpdate = 0.0f;
+
+    // 为该观察者的每个角色排队一次遮挡检测
+    void UpdateViewer(APlayerController* PlayerController);
+
+    // 读取上一帧的射线结果并更新遮挡状态
+    void CollectTraceResults(UWorld* World, double Now);
+
+    // 按每帧限额提交排队的检测
+    void SubmitPendingRequests(UWorld* World);
+
+    // 根据这一次的检测结果更新角色对该观察者的状态
+    void ApplySightResult(FActorVisibility& Visibility, const APlayerController* PlayerController, const AActor* Actor, bool bVisible, double Now) const;
+
+    const FActorVisibility* FindVisibility(const AActor* Viewer, const AActor* Actor) const;
+    FActorVisibility* FindVisibility(uint32 ViewerId, uint32 ActorId);
+
+    // Iris不调用IsNetRelevantFor，把剔除结果写成每个角色的连接过滤
+    void ApplyIrisConnectionFilters();
+};
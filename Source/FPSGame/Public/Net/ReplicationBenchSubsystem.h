@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "ReplicationBenchSubsystem.generated.h"
+
+// 服务器复制基准（仅服务器）
+// 每秒采样一次网络驱动的收发流量和帧末复制耗时（Actor Tick结束到帧结束），写到Saved/Telemetry下的CSV，
+// 文件名和每行都带上当前复制路径（Iris或旧系统），两种模式分别跑一次即可并排对比
+UCLASS()
+class FPSGAME_API UReplicationBenchSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Deinitialize() override;
+
+    // 开始采样，持续Seconds秒后写出CSV
+    void StartBench(float Seconds);
+
+    // 提前结束并写出已采样的数据
+    void StopBench();
+
+    bool IsRunning() const { return bRunning; }
+
+private:
+    struct FBenchSample
+    {
+        double Time = 0.0;
+        int32 NumConnections = 0;
+        int32 NumActiveEnemies = 0;
+        uint32 OutBytesPerSecond = 0;
+        uint32 OutPacketsPerSecond = 0;
+        uint32 InBytesPerSecond = 0;
+        double AvgFlushMs = 0.0;
+        double MaxFlushMs = 0.0;
+    };
+
+    TArray<FBenchSample> Samples;
+
+    FTimerHandle SampleTimerHandle;
+    double StartTime = 0.0;
+    double EndTime = 0.0;
+    bool bRunning = false;
+
+    // 当前这一秒的帧末耗时累计
+    double FrameFlushStart = 0.0;
+    double AccumulatedFlushSeconds = 0.0;
+    double MaxFlushSeconds = 0.0;
+    int32 NumFlushFrames = 0;
+
+    FDelegateHandle PostActorTickHandle;
+    FDelegateHandle EndFrameHandle;
+
+    void OnPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+    void OnEndFrame();
+
+    void TakeSample();
+    void WriteResults();
+
+    FString GetModeName() const;
+};
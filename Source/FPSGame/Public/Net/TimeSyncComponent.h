@@ -0,0 +1,166 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TimeSyncComponent.generated.h"
+
+class AController;
+class APawn;
+
+// 时钟偏移和往返延迟的估计（纯计算，组件和自动化测试共用）
+// 偏移只取窗口内往返最短的一部分样本，小的偏差按MaxSlewRate平滑修正，超过SnapThreshold时直接跳
+struct FPSGAME_API FTimeSyncEstimator
+{
+    int32 SampleWindow = 16;
+    float BestSampleFraction = 0.5f;
+    float MaxSlewRate = 0.02f;
+    float SnapThreshold = 0.25f;
+
+    // 加入一个往返样本：SampleOffset是按对称延迟算出的服务器时间减本地时间
+    void AddSample(float SampleRoundTrip, double SampleOffset);
+
+    // 按经过的时间把偏移向目标平滑修正
+    void Advance(float DeltaTime);
+
+    // 清空样本，已有的偏移保留
+    void ResetSamples();
+
+    bool IsSynchronized() const { return bSynchronized; }
+    double GetClockOffset() const { return ClockOffset; }
+    double GetTargetOffset() const { return TargetOffset; }
+    float GetRoundTripTime() const { return RoundTripTime; }
+    float GetRoundTripJitter() const { return RoundTripJitter; }
+    int32 GetNumSamples() const { return Samples.Num(); }
+
+private:
+    struct FTimeSample
+    {
+        float RoundTripTime = 0.0f;
+        double Offset = 0.0;
+    };
+
+    TArray<FTimeSample> Samples;
+    int32 NextSampleIndex = 0;
+
+    bool bSynchronized = false;
+    double ClockOffset = 0.0;
+    double TargetOffset = 0.0;
+    float RoundTripTime = 0.0f;
+    float RoundTripJitter = 0.0f;
+};
+
+// 客户端和服务器之间的时间同步（挂在玩家的PlayerState上）
+// 客户端定期发请求，服务器回复收到时的世界时间，客户端按往返样本估计时钟偏移和往返延迟：
+// 排队和抖动只会让往返变长，所以偏移只取窗口内往返最短的一部分样本；偏移按限速平滑修正，同步后的时间不会来回跳。
+// 射击和移动用压缩后的同步时间打时间戳，服务器用ValidateClientTime校验并得到回溯时间
+UCLASS(config = Game)
+class FPSGAME_API UTimeSyncComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UTimeSyncComponent();
+
+    virtual void BeginPlay() override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    // 取控制器/Pawn对应玩家的时间同步组件
+    static UTimeSyncComponent* Get(const AController* Controller);
+    static UTimeSyncComponent* Get(const APawn* Pawn);
+
+    // 同步后的服务器时间（服务器上就是世界时间，客户端还没同步时退回GameState复制的粗略服务器时间）
+    double GetServerTime() const;
+
+    bool IsSynchronized() const { return Estimator.IsSynchronized(); }
+
+    // 服务器时间减本地时间
+    double GetClockOffset() const { return Estimator.GetClockOffset(); }
+
+    // 往返延迟（秒）：客户端是过滤后的估计，服务器用引擎测得的Ping
+    float GetRoundTripTime() const;
+
+    // 往返延迟的标准差（秒，仅客户端）
+    float GetRoundTripJitter() const { return Estimator.GetRoundTripJitter(); }
+
+    // 16位毫秒时间戳，约65秒一圈，解压时取离当前服务器时间最近的一圈
+    static uint16 CompressTime(double ServerTime);
+    static double DecompressTime(uint16 Stamp, double ServerNow);
+    double DecompressTime(uint16 Stamp) const { return DecompressTime(Stamp, GetServerTime()); }
+    uint16 GetCompressedServerTime() const { return CompressTime(GetServerTime()); }
+
+    // 服务器：校验客户端打的时间戳，返回是否在合理范围内（不在未来，也不早于往返延迟加容差），
+    // OutRewindTime是可以回溯到的服务器时间（最多回溯MaxRewindTime）
+    bool ValidateClientTime(double ClientServerTime, double& OutRewindTime) const;
+    static bool ValidateClientTime(double ClientServerTime, double ServerNow, float RoundTripTime, float Tolerance, float MaxRewind, double& OutRewindTime);
+
+    // 客户端：清空样本重新快速采样（网络条件变化后使用），已有的偏移保留，收敛前继续平滑
+    void Resync();
+
+    void DumpStats() const;
+
+protected:
+    // 同步完成后的采样间隔（秒）
+    UPROPERTY(Config)
+    float SyncInterval = 1.0f;
+
+    // 开始和Resync后的快速采样
+    UPROPERTY(Config)
+    float FastSyncInterval = 0.1f;
+
+    UPROPERTY(Config)
+    int32 FastSyncSamples = 8;
+
+    // 样本窗口大小
+    UPROPERTY(Config)
+    int32 SampleWindow = 16;
+
+    // 估计偏移时使用往返最短的这部分样本
+    UPROPERTY(Config)
+    float BestSampleFraction = 0.5f;
+
+    // 偏移每秒最多修正的时间（秒），超过SnapThreshold时直接跳到新偏移
+    UPROPERTY(Config)
+    float MaxSlewRate = 0.02f;
+
+    UPROPERTY(Config)
+    float SnapThreshold = 0.25f;
+
+    // 请求超过这个时间没有回复视为丢失（秒）
+    UPROPERTY(Config)
+    float RequestTimeout = 2.0f;
+
+    // 服务器最多回溯的时间（秒）
+    UPROPERTY(Config)
+    float MaxRewindTime = 0.3f;
+
+    // 时间戳校验的容差（秒），覆盖抖动和帧时间
+    UPROPERTY(Config)
+    float TimestampTolerance = 0.05f;
+
+private:
+    // 请求只带序号，发送时间留在客户端
+    UFUNCTION(Server, Unreliable)
+    void ServerRequestTime(uint8 Sequence);
+
+    UFUNCTION(Client, Unreliable)
+    void ClientReceiveTime(uint8 Sequence, double ServerTime);
+
+    struct FPendingRequest
+    {
+        uint8 Sequence = 0;
+        double SendTime = 0.0;
+    };
+
+    FTimeSyncEstimator Estimator;
+
+    TArray<FPendingRequest, TInlineAllocator<8>> PendingRequests;
+    uint8 NextSequence = 0;
+
+    double NextRequestTime = 0.0;
+    int32 FastSamplesRemaining = 0;
+
+    bool IsLocalClient() const;
+    double GetLocalTime() const;
+
+    void SendRequest(double Now);
+};